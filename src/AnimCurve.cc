@@ -0,0 +1,154 @@
+//------------------------------------------------------------------------------
+//  AnimCurve.cc
+//------------------------------------------------------------------------------
+#include "AnimCurve.h"
+#include <algorithm>
+#include <cassert>
+
+namespace FBXC {
+
+constexpr double AnimCurve::TicksPerSecond;
+
+//------------------------------------------------------------------------------
+void
+AnimCurve::Setup(FbxAnimCurve* fbxCurve) {
+    this->keys.clear();
+    const int numKeys = fbxCurve->KeyGetCount();
+    this->keys.resize(numKeys);
+    for (int i = 0; i < numKeys; i++) {
+        Key& key = this->keys[i];
+        key.Time = fbxCurve->KeyGetTime(i).GetSecondDouble();
+        key.Value = fbxCurve->KeyGetValue(i);
+        switch (fbxCurve->KeyGetInterpolation(i)) {
+            case FbxAnimCurveDef::eInterpolationConstant:
+                key.Interp = (FbxAnimCurveDef::eConstantNext == fbxCurve->KeyGetConstantMode(i)) ? ConstantNext : Constant;
+                break;
+            case FbxAnimCurveDef::eInterpolationLinear:
+                key.Interp = Linear;
+                break;
+            default:
+                key.Interp = Cubic;
+                key.RightSlope = fbxCurve->KeyGetRightDerivative(i);
+                key.NextLeftSlope = (i + 1 < numKeys) ? fbxCurve->KeyGetLeftDerivative(i + 1) : 0.0f;
+                break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AnimCurve::Setup(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node& curveNode) {
+    this->keys.clear();
+    std::vector<double> times, values, attrData;
+    std::vector<std::int32_t> attrFlags, attrRefCounts;
+    for (const BinaryFbx::Node* child = fbx.Child(curveNode); child; child = fbx.Next(*child)) {
+        if (child->NumProperties < 1) {
+            continue;
+        }
+        const BinaryFbx::Property prop = fbx.GetProperty(*child, 0);
+        if (!prop.IsArray()) {
+            continue;
+        }
+        if (child->Is("KeyTime")) {
+            arrayCache.Read(prop, times);
+        }
+        else if (child->Is("KeyValueFloat")) {
+            arrayCache.Read(prop, values);
+        }
+        else if (child->Is("KeyAttrFlags")) {
+            arrayCache.Read(prop, attrFlags);
+        }
+        else if (child->Is("KeyAttrDataFloat")) {
+            arrayCache.Read(prop, attrData);
+        }
+        else if (child->Is("KeyAttrRefCount")) {
+            arrayCache.Read(prop, attrRefCounts);
+        }
+    }
+    const std::size_t numKeys = std::min(times.size(), values.size());
+    this->keys.resize(numKeys);
+    for (std::size_t i = 0; i < numKeys; i++) {
+        this->keys[i].Time = times[i] / TicksPerSecond;
+        this->keys[i].Value = (float) values[i];
+    }
+
+    // key attributes are run-length encoded, each attribute is shared
+    // by RefCount consecutive keys, its data is 4 floats: right slope,
+    // next left slope, tangent weights and velocity
+    const std::size_t numAttrs = std::min(attrFlags.size(), attrRefCounts.size());
+    std::size_t keyIndex = 0;
+    for (std::size_t attr = 0; (attr < numAttrs) && (keyIndex < numKeys); attr++) {
+        const std::int32_t flags = attrFlags[attr];
+        const bool hasData = attr * 4 + 1 < attrData.size();
+        for (std::int32_t i = 0; (i < attrRefCounts[attr]) && (keyIndex < numKeys); i++, keyIndex++) {
+            Key& key = this->keys[keyIndex];
+            if (flags & 0x02) {
+                key.Interp = (flags & 0x100) ? ConstantNext : Constant;
+            }
+            else if (flags & 0x04) {
+                key.Interp = Linear;
+            }
+            else if (flags & 0x08) {
+                key.Interp = Cubic;
+                if (hasData) {
+                    key.RightSlope = (float) attrData[attr * 4 + 0];
+                    key.NextLeftSlope = (float) attrData[attr * 4 + 1];
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+double
+AnimCurve::Evaluate(double time, int& cursor) const {
+    assert(!this->keys.empty());
+    const int numKeys = (int) this->keys.size();
+    if (time <= this->keys[0].Time) {
+        return this->keys[0].Value;
+    }
+    if (time >= this->keys[numKeys - 1].Time) {
+        return this->keys[numKeys - 1].Value;
+    }
+
+    // find the key segment [cursor, cursor + 1] containing time, samples
+    // are mostly evaluated in increasing time order, so first check the
+    // cursor's segment and the next one before searching
+    if ((cursor < 0) || (cursor >= numKeys - 1) || (this->keys[cursor].Time > time)) {
+        cursor = 0;
+    }
+    if (this->keys[cursor + 1].Time <= time) {
+        if ((cursor + 2 < numKeys) && (this->keys[cursor + 2].Time > time)) {
+            cursor++;
+        }
+        else {
+            auto it = std::upper_bound(this->keys.begin() + cursor, this->keys.end(), time,
+                [](double t, const Key& key) { return t < key.Time; });
+            cursor = (int) (it - this->keys.begin()) - 1;
+        }
+    }
+
+    const Key& k0 = this->keys[cursor];
+    const Key& k1 = this->keys[cursor + 1];
+    const double dt = k1.Time - k0.Time;
+    const double u = (dt > 0.0) ? (time - k0.Time) / dt : 0.0;
+    switch (k0.Interp) {
+        case Constant:
+            return k0.Value;
+        case ConstantNext:
+            return k1.Value;
+        case Linear:
+            return k0.Value + (k1.Value - k0.Value) * u;
+        default:
+            {
+                const double u2 = u * u;
+                const double u3 = u2 * u;
+                return (2.0 * u3 - 3.0 * u2 + 1.0) * k0.Value +
+                       (u3 - 2.0 * u2 + u) * dt * k0.RightSlope +
+                       (-2.0 * u3 + 3.0 * u2) * k1.Value +
+                       (u3 - u2) * dt * k0.NextLeftSlope;
+            }
+    }
+}
+
+} // namespace FBXC
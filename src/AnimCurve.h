@@ -0,0 +1,81 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::AnimCurve
+    @brief keys of an FBX animation curve and their evaluation
+
+    A curve is set up either from an FbxAnimCurve (on the main thread,
+    the FBX SDK isn't thread-safe) or from an AnimationCurve record of a
+    binary FBX file. After setup a curve is immutable, Evaluate() keeps
+    the key search position in a cursor owned by the caller, so any
+    number of threads can evaluate the same curve, each with its own
+    cursors.
+
+    Cubic keys are evaluated as Hermite splines with the stored key
+    slopes (tangent weights are ignored), values before the first and
+    after the last key are constant.
+*/
+#include "BinaryFbx.h"
+#include "ArrayCache.h"
+#include <fbxsdk.h>
+#include <cstdint>
+#include <vector>
+
+namespace FBXC {
+
+class AnimCurve {
+public:
+    /// FBX time units per second
+    static constexpr double TicksPerSecond = 46186158000.0;
+
+    /// setup from an FBX SDK curve (not thread-safe)
+    void Setup(FbxAnimCurve* fbxCurve);
+    /// setup from an AnimationCurve record (thread-safe)
+    void Setup(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node& curveNode);
+    /// return true if the curve has no keys
+    bool Empty() const;
+    /// time of the first key in seconds
+    double StartTime() const;
+    /// time of the last key in seconds
+    double StopTime() const;
+    /// evaluate at a time in seconds, cursor is the caller's key search position (initially 0)
+    double Evaluate(double time, int& cursor) const;
+
+private:
+    /// key interpolation to the next key
+    enum Interpolation : std::uint8_t {
+        Constant,       // value of this key
+        ConstantNext,   // value of the next key
+        Linear,
+        Cubic,
+    };
+    struct Key {
+        double Time = 0.0;
+        float Value = 0.0f;
+        Interpolation Interp = Linear;
+        /// slopes (value change per second) leaving this key and arriving at the next key
+        float RightSlope = 0.0f;
+        float NextLeftSlope = 0.0f;
+    };
+    std::vector<Key> keys;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+AnimCurve::Empty() const {
+    return this->keys.empty();
+}
+
+//------------------------------------------------------------------------------
+inline double
+AnimCurve::StartTime() const {
+    return this->keys.empty() ? 0.0 : this->keys.front().Time;
+}
+
+//------------------------------------------------------------------------------
+inline double
+AnimCurve::StopTime() const {
+    return this->keys.empty() ? 0.0 : this->keys.back().Time;
+}
+
+} // namespace FBXC
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+//  AnimPipeline.cc
+//------------------------------------------------------------------------------
+#include "AnimPipeline.h"
+#include "KeyReducer.h"
+#include "TrackQuantizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+int
+AnimPipeline::Setup(const ExportOptions& options, const std::vector<ProxyNode>& nodes, ProxyAnimation& anim) {
+    // without a time span in the stack, the keys of the curves define it
+    double start = anim.Properties["start"].Get<double>();
+    double stop = anim.Properties["stop"].Get<double>();
+    if (stop <= start) {
+        bool first = true;
+        for (const ProxyAnimation::Curve& curve : anim.Curves) {
+            if (!curve.Data.Empty()) {
+                start = first ? curve.Data.StartTime() : std::min(start, curve.Data.StartTime());
+                stop = first ? curve.Data.StopTime() : std::max(stop, curve.Data.StopTime());
+                first = false;
+            }
+        }
+        if (first) {
+            stop = start;
+        }
+        anim.Properties.Set("start", start);
+        anim.Properties.Set("stop", stop);
+    }
+    const int numSamples = (int) std::floor((stop - start) * options.AnimSampleRate + 0.5) + 1;
+    anim.Properties.Add("samplerate", options.AnimSampleRate);
+    anim.Properties.Add("numsamples", (std::int32_t) numSamples);
+    anim.Properties.Add("keys", (ExportOptions::HermiteKeys == options.AnimKeys) ? "hermite" : "linear");
+
+    anim.Tracks.clear();
+    anim.Tracks.resize(anim.Targets.size() * AnimTrack::NumChannels);
+    for (std::size_t i = 0; i < anim.Tracks.size(); i++) {
+        ProxyTrack& track = anim.Tracks[i];
+        const AnimTrack::Channel chn = (AnimTrack::Channel) (i % AnimTrack::NumChannels);
+        track.Data.Chn = chn;
+        track.Data.NumSamples = numSamples;
+        track.Data.Samples.resize(numSamples * AnimTrack::ChannelSize(chn));
+        track.Properties.Add("node", nodes[anim.Targets[i / AnimTrack::NumChannels].Node].Properties["id"]);
+        track.Properties.Add("channel", AnimTrack::ChannelName(chn));
+    }
+    return numSamples;
+}
+
+//------------------------------------------------------------------------------
+void
+AnimPipeline::Sample(const ExportOptions& options, ProxyAnimation& anim, int targetIndex, int firstSample, int numSamples) {
+    const ProxyAnimation::Target& target = anim.Targets[targetIndex];
+    const double start = anim.Properties["start"].Get<double>();
+    const double stop = anim.Properties["stop"].Get<double>();
+    AnimTrack& translations = anim.Tracks[targetIndex * AnimTrack::NumChannels + AnimTrack::Translation].Data;
+    AnimTrack& rotations = anim.Tracks[targetIndex * AnimTrack::NumChannels + AnimTrack::Rotation].Data;
+    AnimTrack& scalings = anim.Tracks[targetIndex * AnimTrack::NumChannels + AnimTrack::Scaling].Data;
+
+    // this job's curve evaluation state
+    int cursors[AnimTrack::NumChannels][3] = { };
+    for (int i = firstSample; i < firstSample + numSamples; i++) {
+        const double time = std::min(start + i / options.AnimSampleRate, stop);
+        FbxDouble3 values[AnimTrack::NumChannels] = {
+            target.Transform.Translation, target.Transform.Rotation, target.Transform.Scaling
+        };
+        for (int chn = 0; chn < AnimTrack::NumChannels; chn++) {
+            for (int axis = 0; axis < 3; axis++) {
+                const int curveIndex = target.Curves[chn][axis];
+                if ((curveIndex >= 0) && !anim.Curves[curveIndex].Data.Empty()) {
+                    values[chn][axis] = anim.Curves[curveIndex].Data.Evaluate(time, cursors[chn][axis]);
+                }
+            }
+        }
+        double t[3], r[4], s[3];
+        target.Transform.Evaluate(values[0], values[1], values[2]).Decompose(t, r, s);
+        for (int c = 0; c < 3; c++) {
+            translations.Samples[i * 3 + c] = (float) t[c];
+            scalings.Samples[i * 3 + c] = (float) s[c];
+        }
+        for (int c = 0; c < 4; c++) {
+            rotations.Samples[i * 4 + c] = (float) r[c];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AnimPipeline::Reduce(const ExportOptions& options, ProxyTrack& track) {
+    AnimTrack& data = track.Data;
+    if (AnimTrack::Rotation == data.Chn) {
+        // q and -q are the same rotation, flip samples into the hemisphere of their predecessor
+        for (int i = 1; i < data.NumSamples; i++) {
+            const float* prev = &data.Samples[(i - 1) * 4];
+            float* q = &data.Samples[i * 4];
+            if ((prev[0] * q[0] + prev[1] * q[1] + prev[2] * q[2] + prev[3] * q[3]) < 0.0f) {
+                for (int c = 0; c < 4; c++) {
+                    q[c] = -q[c];
+                }
+            }
+        }
+    }
+    KeyReducer::Reduce(data, options.AnimKeys, options.AnimSampleRate, options.AnimTolerance);
+}
+
+//------------------------------------------------------------------------------
+/// write quantized values, as bytes up to 8 bits, else as 16-bit values
+static std::uint64_t
+writeQuantized(BlobWriter& blob, const std::vector<std::uint16_t>& values, int bits) {
+    if (bits <= 8) {
+        std::vector<std::uint8_t> bytes(values.begin(), values.end());
+        return blob.Write(bytes.data(), bytes.size());
+    }
+    return blob.Write(values.data(), values.size() * sizeof(std::uint16_t));
+}
+
+//------------------------------------------------------------------------------
+/// convert a 3 or 4 component range to a property value
+static Value
+rangeValue(const float* v, int size) {
+    Value val;
+    if (4 == size) {
+        val.Set(FbxDouble4(v[0], v[1], v[2], v[3]));
+    }
+    else {
+        val.Set(FbxDouble3(v[0], v[1], v[2]));
+    }
+    return val;
+}
+
+//------------------------------------------------------------------------------
+void
+AnimPipeline::Write(const ExportOptions& options, BlobWriter& blob, ProxyAnimation& anim) {
+    if (options.AnimBits > 0) {
+        WriteQuantized(options, blob, anim);
+        return;
+    }
+    for (ProxyTrack& track : anim.Tracks) {
+        const AnimTrack& data = track.Data;
+        std::vector<float> times(data.Keys.size());
+        for (std::size_t i = 0; i < data.Keys.size(); i++) {
+            times[i] = (float) (data.Keys[i] / options.AnimSampleRate);
+        }
+        // blob offsets are 64-bit, blobs may be larger than 2 GB
+        track.Properties.Add("numkeys", (std::int32_t) data.Keys.size());
+        track.Properties.Add("timesoffset", blob.Write(times.data(), times.size() * sizeof(float)));
+        track.Properties.Add("valuesoffset", blob.Write(data.Values.data(), data.Values.size() * sizeof(float)));
+        if (!data.Tangents.empty()) {
+            track.Properties.Add("tangentsoffset", blob.Write(data.Tangents.data(), data.Tangents.size() * sizeof(float)));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AnimPipeline::WriteQuantized(const ExportOptions& options, BlobWriter& blob, ProxyAnimation& anim) {
+    // key times are sample indices, 16 bits unless the animation is longer
+    const int numSamples = anim.Properties["numsamples"].Get<std::int32_t>();
+    const bool shortKeys = numSamples <= 0x10000;
+    anim.Properties.Add("quantization", (std::int32_t) options.AnimBits);
+    anim.Properties.Add("keyindexsize", (std::int32_t) (shortKeys ? 2 : 4));
+
+    // identity tracks are what a missing track means anyway
+    anim.Tracks.erase(std::remove_if(anim.Tracks.begin(), anim.Tracks.end(), [&options](const ProxyTrack& track) {
+        return TrackQuantizer::IsIdentity(track.Data, options.AnimTolerance);
+    }), anim.Tracks.end());
+
+    std::vector<std::uint16_t> quantized;
+    for (ProxyTrack& track : anim.Tracks) {
+        AnimTrack& data = track.Data;
+        const int size = AnimTrack::ChannelSize(data.Chn);
+        track.Properties.Add("numkeys", (std::int32_t) data.Keys.size());
+        if (data.Keys.size() == 1) {
+            // constant tracks only need their value in the scene file
+            track.Properties.Add("value", rangeValue(data.Values.data(), size));
+            continue;
+        }
+        // blob offsets are 64-bit, blobs may be larger than 2 GB
+        if (shortKeys) {
+            std::vector<std::uint16_t> keys(data.Keys.begin(), data.Keys.end());
+            track.Properties.Add("keysoffset", blob.Write(keys.data(), keys.size() * sizeof(std::uint16_t)));
+        }
+        else {
+            track.Properties.Add("keysoffset", blob.Write(data.Keys.data(), data.Keys.size() * sizeof(std::uint32_t)));
+        }
+        float rangeMin[4], rangeExtent[4];
+        if (AnimTrack::Rotation == data.Chn) {
+            TrackQuantizer::PackRotations(data, options.AnimBits, quantized);
+        }
+        else {
+            TrackQuantizer::QuantizeRange(data.Values, size, options.AnimBits, quantized, rangeMin, rangeExtent);
+            track.Properties.Add("min", rangeValue(rangeMin, size));
+            track.Properties.Add("extent", rangeValue(rangeExtent, size));
+        }
+        track.Properties.Add("valuesoffset", writeQuantized(blob, quantized, options.AnimBits));
+        if (!data.Tangents.empty()) {
+            TrackQuantizer::QuantizeRange(data.Tangents, size, options.AnimBits, quantized, rangeMin, rangeExtent);
+            track.Properties.Add("tangentmin", rangeValue(rangeMin, size));
+            track.Properties.Add("tangentextent", rangeValue(rangeExtent, size));
+            track.Properties.Add("tangentsoffset", writeQuantized(blob, quantized, options.AnimBits));
+        }
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,45 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::AnimPipeline
+    @brief samples and keyframe-reduces animations, writes the keys to a blob
+
+    Setup() allocates the 3 tracks of each animation target and their
+    sample buffers. Sample() evaluates a range of samples of one target:
+    the curves of the target's local translation, rotation and scaling
+    are evaluated with the job's own curve cursors, the local matrix is
+    built from the node's transform setup and decomposed into
+    translation, rotation quaternion and scaling. Jobs for different
+    targets or sample ranges are independent and run in parallel.
+    Reduce() makes the rotation samples hemisphere-continuous and runs
+    the KeyReducer on a track. Write() appends the keys to the blob and
+    records their layout in the track properties, either as float keys
+    or quantized by the TrackQuantizer (ExportOptions::AnimBits).
+*/
+#include "ProxyAnimation.h"
+#include "ProxyNode.h"
+#include "BlobWriter.h"
+#include "ExportOptions.h"
+
+namespace FBXC {
+
+class AnimPipeline {
+public:
+    /// number of samples of a sampling job
+    static const int SamplesPerJob = 256;
+
+    /// allocate the tracks of an animation after its curves are set up, return number of samples
+    static int Setup(const ExportOptions& options, const std::vector<ProxyNode>& nodes, ProxyAnimation& anim);
+    /// sample the tracks of a target for a range of samples (thread-safe for different targets or ranges)
+    static void Sample(const ExportOptions& options, ProxyAnimation& anim, int target, int firstSample, int numSamples);
+    /// keyframe-reduce a track after all its samples are in (thread-safe for different tracks)
+    static void Reduce(const ExportOptions& options, ProxyTrack& track);
+    /// write the keys of all tracks to the blob and add their layout to the track properties
+    static void Write(const ExportOptions& options, BlobWriter& blob, ProxyAnimation& anim);
+
+private:
+    /// write quantized keys, drops identity tracks and writes constant tracks to the track properties
+    static void WriteQuantized(const ExportOptions& options, BlobWriter& blob, ProxyAnimation& anim);
+};
+
+} // namespace FBXC
@@ -0,0 +1,19 @@
+//------------------------------------------------------------------------------
+//  AnimTrack.cc
+//------------------------------------------------------------------------------
+#include "AnimTrack.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+const char*
+AnimTrack::ChannelName(Channel chn) {
+    static const char* names[NumChannels] = {
+        "translation",
+        "rotation",
+        "scaling"
+    };
+    return names[chn];
+}
+
+} // namespace FBXC
@@ -0,0 +1,54 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::AnimTrack
+    @brief sampled and keyframe-reduced data of an animation channel
+
+    Samples are taken at a fixed rate, the keyframe reduction keeps the
+    samples in Keys from which the dropped samples can be rebuilt by
+    linear or Hermite interpolation. Rotations are quaternions (xyzw)
+    in a continuous hemisphere, so that interpolating them component
+    by component and normalizing gives the sampled rotations.
+*/
+#include <cstdint>
+#include <vector>
+
+namespace FBXC {
+
+class AnimTrack {
+public:
+    /// animated channels of a node's local transform
+    enum Channel {
+        Translation = 0,
+        Rotation,       // quaternion xyzw
+        Scaling,
+
+        NumChannels,
+    };
+
+    /// number of floats per sample of a channel
+    static int ChannelSize(Channel chn);
+    /// get channel name (as used in JSON output)
+    static const char* ChannelName(Channel chn);
+
+    /// the animated channel
+    Channel Chn = Translation;
+    /// number of samples
+    int NumSamples = 0;
+    /// NumSamples * ChannelSize values, released by the keyframe reduction
+    std::vector<float> Samples;
+    /// sample index of each key
+    std::vector<std::uint32_t> Keys;
+    /// key values (Keys.size() * ChannelSize)
+    std::vector<float> Values;
+    /// key tangents (value change per second) for Hermite keys, else empty
+    std::vector<float> Tangents;
+};
+
+//------------------------------------------------------------------------------
+inline int
+AnimTrack::ChannelSize(Channel chn) {
+    return (Rotation == chn) ? 4 : 3;
+}
+
+} // namespace FBXC
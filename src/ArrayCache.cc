@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+//  ArrayCache.cc
+//------------------------------------------------------------------------------
+#include "ArrayCache.h"
+#include <cassert>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+ArrayCache::Setup(ThreadPool* pool_) {
+    this->pool = pool_;
+}
+
+//------------------------------------------------------------------------------
+void
+ArrayCache::Clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->inflated.clear();
+    this->numInflatedBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+ArrayCache::Prefetch(const std::vector<BinaryFbx::Property>& props) {
+
+    // only inflate compressed arrays which are not in the cache yet
+    std::vector<BinaryFbx::Property> todo;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (const auto& prop : props) {
+            assert(prop.IsArray());
+            if ((0 != prop.Encoding) && (this->inflated.find(prop.Data) == this->inflated.end())) {
+                // reserve the slot so that duplicates in props are only inflated once
+                this->inflated[prop.Data] = nullptr;
+                todo.push_back(prop);
+            }
+        }
+    }
+    std::vector<std::unique_ptr<std::vector<std::uint8_t>>> results(todo.size());
+    auto inflate = [&todo, &results](int i) {
+        results[i].reset(new std::vector<std::uint8_t>());
+        BinaryFbx::Inflate(todo[i], *results[i]);
+    };
+    if (this->pool) {
+        this->pool->ParallelFor((int) todo.size(), inflate);
+    }
+    else {
+        for (int i = 0; i < (int) todo.size(); i++) {
+            inflate(i);
+        }
+    }
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (std::size_t i = 0; i < todo.size(); i++) {
+        // a concurrent Get() may have filled the slot already
+        std::unique_ptr<std::vector<std::uint8_t>>& slot = this->inflated[todo[i].Data];
+        if (!slot) {
+            this->numInflatedBytes += results[i]->size();
+            slot = std::move(results[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+const std::uint8_t*
+ArrayCache::Get(const BinaryFbx::Property& prop, std::size_t& outNumBytes) {
+    assert(prop.IsArray());
+    if (0 == prop.Encoding) {
+        outNumBytes = prop.Size;
+        return prop.Data;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->inflated.find(prop.Data);
+        if ((it != this->inflated.end()) && it->second) {
+            outNumBytes = it->second->size();
+            return it->second->data();
+        }
+    }
+    // not prefetched, inflate on the calling thread
+    std::unique_ptr<std::vector<std::uint8_t>> bytes(new std::vector<std::uint8_t>());
+    BinaryFbx::Inflate(prop, *bytes);
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::unique_ptr<std::vector<std::uint8_t>>& slot = this->inflated[prop.Data];
+    if (!slot) {
+        this->numInflatedBytes += bytes->size();
+        slot = std::move(bytes);
+    }
+    outNumBytes = slot->size();
+    return slot->data();
+}
+
+//------------------------------------------------------------------------------
+void
+ArrayCache::Read(const BinaryFbx::Property& prop, std::vector<double>& out) {
+    std::size_t numBytes = 0;
+    const std::uint8_t* bytes = this->Get(prop, numBytes);
+    BinaryFbx::DecodeArray(prop, bytes, numBytes, out);
+}
+
+//------------------------------------------------------------------------------
+void
+ArrayCache::Read(const BinaryFbx::Property& prop, std::vector<std::int32_t>& out) {
+    std::size_t numBytes = 0;
+    const std::uint8_t* bytes = this->Get(prop, numBytes);
+    BinaryFbx::DecodeArray(prop, bytes, numBytes, out);
+}
+
+//------------------------------------------------------------------------------
+int
+ArrayCache::NumInflated() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return (int) this->inflated.size();
+}
+
+//------------------------------------------------------------------------------
+std::size_t
+ArrayCache::NumInflatedBytes() const {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->numInflatedBytes;
+}
+
+} // namespace FBXC
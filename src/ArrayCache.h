@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ArrayCache
+    @brief on-demand decoding of BinaryFbx array properties
+
+    Array properties are only recorded as byte ranges in the mapped
+    file until a consumer asks for their content. Uncompressed arrays
+    are returned in place, compressed arrays are inflated once and
+    kept until Clear(). Prefetch() inflates a whole set of arrays
+    in parallel on a ThreadPool, this is what the mesh stages call
+    before touching vertex data.
+*/
+#include "BinaryFbx.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace FBXC {
+
+class ArrayCache {
+public:
+    /// setup with a thread pool used for prefetching (may be nullptr)
+    void Setup(ThreadPool* pool);
+    /// discard all inflated arrays
+    void Clear();
+
+    /// inflate a set of array properties in parallel
+    void Prefetch(const std::vector<BinaryFbx::Property>& props);
+    /// get the raw element bytes of an array property and their number (inflates if needed)
+    const std::uint8_t* Get(const BinaryFbx::Property& prop, std::size_t& outNumBytes);
+    /// decode an array property into doubles
+    void Read(const BinaryFbx::Property& prop, std::vector<double>& out);
+    /// decode an array property into 32-bit integers
+    void Read(const BinaryFbx::Property& prop, std::vector<std::int32_t>& out);
+
+    /// number of arrays inflated so far
+    int NumInflated() const;
+    /// number of bytes inflated so far
+    std::size_t NumInflatedBytes() const;
+
+private:
+    ThreadPool* pool = nullptr;
+    mutable std::mutex mutex;
+    std::unordered_map<const std::uint8_t*, std::unique_ptr<std::vector<std::uint8_t>>> inflated;
+    std::size_t numInflatedBytes = 0;
+};
+
+} // namespace FBXC
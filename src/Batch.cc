@@ -0,0 +1,224 @@
+//------------------------------------------------------------------------------
+//  Batch.cc
+//------------------------------------------------------------------------------
+#include "Batch.h"
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <thread>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+Batch::CollectFiles(const std::string& manifestOrPattern, std::vector<std::string>& outPaths) {
+    const std::string::size_type dirEnd = manifestOrPattern.find_last_of("/\\");
+    const std::string fileName = (dirEnd == std::string::npos) ? manifestOrPattern : manifestOrPattern.substr(dirEnd + 1);
+    if (fileName.find_first_of("*?") != std::string::npos) {
+        // wildcard pattern, only the last path component may contain wildcards
+        const std::string dir = (dirEnd == std::string::npos) ? std::string(".") : manifestOrPattern.substr(0, dirEnd);
+        const std::string prefix = (dirEnd == std::string::npos) ? std::string() : manifestOrPattern.substr(0, dirEnd + 1);
+        std::vector<std::string> matches;
+        #if defined(_WIN32)
+        WIN32_FIND_DATAA findData;
+        HANDLE findHandle = FindFirstFileA((dir + "\\*").c_str(), &findData);
+        if (INVALID_HANDLE_VALUE == findHandle) {
+            Log::Fatal("failed to open directory '%s'\n", dir.c_str());
+        }
+        do {
+            if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && Rules::Match(fileName.c_str(), findData.cFileName)) {
+                matches.push_back(prefix + findData.cFileName);
+            }
+        }
+        while (FindNextFileA(findHandle, &findData));
+        FindClose(findHandle);
+        #else
+        DIR* dirHandle = opendir(dir.c_str());
+        if (nullptr == dirHandle) {
+            Log::Fatal("failed to open directory '%s'\n", dir.c_str());
+        }
+        while (const dirent* entry = readdir(dirHandle)) {
+            if ((entry->d_name[0] != '.') && Rules::Match(fileName.c_str(), entry->d_name)) {
+                matches.push_back(prefix + entry->d_name);
+            }
+        }
+        closedir(dirHandle);
+        #endif
+        // directory order is arbitrary, keep results reproducible
+        std::sort(matches.begin(), matches.end());
+        outPaths.insert(outPaths.end(), matches.begin(), matches.end());
+    }
+    else {
+        // manifest file, one path per line
+        std::FILE* fp = std::fopen(manifestOrPattern.c_str(), "rb");
+        if (nullptr == fp) {
+            Log::Fatal("failed to open batch manifest '%s'\n", manifestOrPattern.c_str());
+        }
+        std::string content;
+        char buf[4096];
+        std::size_t num;
+        while ((num = std::fread(buf, 1, sizeof(buf), fp)) > 0) {
+            content.append(buf, num);
+        }
+        std::fclose(fp);
+        std::string::size_type pos = 0;
+        while (pos < content.size()) {
+            std::string::size_type end = content.find('\n', pos);
+            if (end == std::string::npos) {
+                end = content.size();
+            }
+            std::string line = content.substr(pos, end - pos);
+            pos = end + 1;
+            const std::string::size_type first = line.find_first_not_of(" \t\r");
+            if ((first == std::string::npos) || (line[first] == '#')) {
+                continue;
+            }
+            const std::string::size_type last = line.find_last_not_of(" \t\r");
+            outPaths.push_back(line.substr(first, last - first + 1));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+std::string
+Batch::OutputPath(const std::string& fbxPath, const std::string& outputDir, const ExportOptions& options) {
+    const std::string::size_type dirEnd = fbxPath.find_last_of("/\\");
+    std::string name = (dirEnd == std::string::npos) ? fbxPath : fbxPath.substr(dirEnd + 1);
+    const std::string::size_type extStart = name.find_last_of('.');
+    if (extStart != std::string::npos) {
+        name.erase(extStart);
+    }
+    std::string path = outputDir;
+    if (!path.empty() && (path.back() != '/') && (path.back() != '\\')) {
+        path.push_back('/');
+    }
+    return path + name + ((ExportOptions::BinaryFormat == options.Format) ? ".scene" : ".json");
+}
+
+//------------------------------------------------------------------------------
+void
+Batch::Run(const std::vector<std::string>& fbxPaths, const std::string& outputDir, FBX::Reader reader, int numJobs, int numConcurrent,
+    const Rules& rules, const ExportOptions& options, const ExportCache* cache, const MeshCache* meshCache) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const int numFiles = (int) fbxPaths.size();
+    std::vector<Result> results(numFiles);
+    std::vector<int> todo;
+    std::set<std::string> outputPaths;
+    for (int i = 0; i < numFiles; i++) {
+        Result& result = results[i];
+        result.FbxPath = fbxPaths[i];
+        result.OutputPath = OutputPath(fbxPaths[i], outputDir, options);
+        // two inputs with the same base name would overwrite each other's output
+        if (!outputPaths.insert(result.OutputPath).second) {
+            Log::Fatal("batch files with the same output path '%s'\n", result.OutputPath.c_str());
+        }
+        std::FILE* fp = std::fopen(result.FbxPath.c_str(), "rb");
+        if (nullptr == fp) {
+            result.Status = "missing";
+            continue;
+        }
+        std::fclose(fp);
+        todo.push_back(i);
+    }
+
+    // split the hardware threads between the concurrent files
+    numConcurrent = std::max(1, std::min(numConcurrent, (int) todo.size()));
+    if ((0 == numJobs) && (numConcurrent > 1)) {
+        numJobs = std::max(1, (int) std::thread::hardware_concurrency() / numConcurrent);
+    }
+
+    // each slot converts files with its own FBX object, which is setup
+    // on the first cache miss and stays setup for all following files
+    std::atomic<int> next(0);
+    auto slot = [&]() {
+        std::unique_ptr<FBX> fbx(new FBX());
+        int t;
+        while ((t = next.fetch_add(1)) < (int) todo.size()) {
+            Result& result = results[todo[t]];
+            const auto fileStartTime = std::chrono::steady_clock::now();
+            std::string cacheKey;
+            if (cache) {
+                cacheKey = cache->Key(result.FbxPath, reader, options, result.OutputPath);
+                result.Cached = cache->Fetch(cacheKey, result.OutputPath);
+            }
+            if (result.Cached) {
+                result.Status = "cached";
+            }
+            else {
+                if (!fbx->IsValid()) {
+                    fbx->Setup(reader, numJobs);
+                }
+                fbx->Load(result.FbxPath, rules);
+                fbx->Export(result.OutputPath, options, meshCache);
+                result.NumMeshes = (int) fbx->Scene().Meshes.size();
+                result.NumCachedMeshes = fbx->NumCachedMeshes();
+                fbx->Unload();
+                if (cache) {
+                    cache->Store(cacheKey, result.OutputPath);
+                }
+                result.Status = "ok";
+            }
+            result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fileStartTime).count();
+            result.Ok = true;
+        }
+        if (fbx->IsValid()) {
+            fbx->Discard();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < numConcurrent; i++) {
+        threads.emplace_back(slot);
+    }
+    slot();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    PrintSummary(results, seconds);
+    const int numFailed = (int) std::count_if(results.begin(), results.end(), [](const Result& r) { return !r.Ok; });
+    if (numFailed > 0) {
+        Log::Fatal("%d of %d batch files failed\n", numFailed, numFiles);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Batch::PrintSummary(const std::vector<Result>& results, double seconds) {
+    int numOk = 0;
+    int numCached = 0;
+    int numMeshes = 0;
+    int numCachedMeshes = 0;
+    for (const Result& result : results) {
+        if (result.Cached) {
+            numOk++;
+            numCached++;
+            Log::Info("%-8s %8.3fs               %s -> %s\n", result.Status, result.Seconds,
+                result.FbxPath.c_str(), result.OutputPath.c_str());
+        }
+        else if (result.Ok) {
+            numOk++;
+            numMeshes += result.NumMeshes;
+            numCachedMeshes += result.NumCachedMeshes;
+            Log::Info("%-8s %8.3fs %5d meshes (%d cached)  %s -> %s\n", result.Status, result.Seconds, result.NumMeshes,
+                result.NumCachedMeshes, result.FbxPath.c_str(), result.OutputPath.c_str());
+        }
+        else {
+            Log::Info("%-8s %s\n", result.Status, result.FbxPath.c_str());
+        }
+    }
+    Log::Info("%d of %d files converted (%d from cache) in %.3fs\n", numOk, (int) results.size(), numCached, seconds);
+    Log::Info("mesh cache: %d hits, %d misses\n", numCachedMeshes, numMeshes - numCachedMeshes);
+}
+
+} // namespace FBXC
@@ -0,0 +1,52 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::Batch
+    @brief convert many FBX files in one process
+
+    The files come from a manifest (one path per line, empty lines and
+    lines starting with '#' are ignored) or from a wildcard pattern
+    in the last path component (e.g. '*.fbx' in a directory). Each file is
+    exported to outputDir/[basename].json and .bin.
+
+    Several files are converted concurrently, each concurrent slot owns
+    an FBX object which is setup once, so the FBX SDK manager and its
+    IO plugins are only initialized once per slot instead of once per
+    file, between files only the scene is reset. Files found in the
+    export cache are not loaded at all.
+*/
+#include <string>
+#include <vector>
+#include "FBX.h"
+#include "ExportCache.h"
+
+namespace FBXC {
+
+class Batch {
+public:
+    /// conversion result of a single file
+    struct Result {
+        std::string FbxPath;
+        std::string OutputPath;
+        bool Ok = false;
+        bool Cached = false;
+        const char* Status = "skipped";
+        double Seconds = 0.0;
+        int NumMeshes = 0;
+        int NumCachedMeshes = 0;
+    };
+
+    /// collect FBX file paths from a manifest file or a wildcard pattern
+    static void CollectFiles(const std::string& manifestOrPattern, std::vector<std::string>& outPaths);
+    /// convert files, numConcurrent files at a time, optional export and mesh cache, fatal error if any file failed
+    static void Run(const std::vector<std::string>& fbxPaths, const std::string& outputDir, FBX::Reader reader, int numJobs, int numConcurrent,
+                    const Rules& rules, const ExportOptions& options, const ExportCache* cache, const MeshCache* meshCache);
+
+private:
+    /// return the output scene file path for an FBX file (.json or .scene)
+    static std::string OutputPath(const std::string& fbxPath, const std::string& outputDir, const ExportOptions& options);
+    /// print the per-file results and totals
+    static void PrintSummary(const std::vector<Result>& results, double seconds);
+};
+
+} // namespace FBXC
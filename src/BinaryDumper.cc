@@ -0,0 +1,257 @@
+//------------------------------------------------------------------------------
+//  BinaryDumper.cc
+//------------------------------------------------------------------------------
+#include "BinaryDumper.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace FBXC {
+
+static_assert(sizeof(fbxc_value) == 16, "fbxc_value size");
+static_assert(sizeof(fbxc_property) == 24, "fbxc_property size");
+static_assert(sizeof(fbxc_node) == 32, "fbxc_node size");
+static_assert(sizeof(fbxc_scene_header) == 208, "fbxc_scene_header size");
+
+//------------------------------------------------------------------------------
+void
+BinaryDumper::Dump(const ProxyScene& scene, const std::string& path) {
+    BinaryDumper dumper;
+    dumper.Build(scene);
+    dumper.Write(path);
+}
+
+//------------------------------------------------------------------------------
+std::uint32_t
+BinaryDumper::AddString(const char* str) {
+    assert(str);
+    auto it = this->stringOffsets.find(str);
+    if (it != this->stringOffsets.end()) {
+        return it->second;
+    }
+    const std::size_t len = std::strlen(str);
+    if (this->strings.size() + len + 1 > std::numeric_limits<std::uint32_t>::max()) {
+        Log::Fatal("binary scene string table exceeds 4 GB\n");
+    }
+    const std::uint32_t offset = (std::uint32_t) this->strings.size();
+    this->strings.insert(this->strings.end(), str, str + len + 1);
+    this->stringOffsets.emplace(str, offset);
+    return offset;
+}
+
+//------------------------------------------------------------------------------
+fbxc_value
+BinaryDumper::AddValue(const Value& value) {
+    fbxc_value val = { };
+    val.count = 1;
+    switch (value.GetType()) {
+        case Value::Bool:
+            val.type = FBXC_BOOL;
+            val.v.u = value.Get<bool>() ? 1 : 0;
+            break;
+        case Value::Id:
+            val.type = FBXC_ID;
+            val.v.u = value.Get<std::uint64_t>();
+            break;
+        case Value::Int:
+            val.type = FBXC_INT;
+            val.v.i = value.Get<std::int32_t>();
+            break;
+        case Value::Float:
+            val.type = FBXC_FLOAT;
+            val.v.f = value.Get<double>();
+            break;
+        case Value::Float2:
+            {
+                FbxDouble2 v = value.Get<FbxDouble2>();
+                val.type = FBXC_FLOAT2;
+                val.count = 2;
+                val.v.u = this->doubles.size();
+                this->doubles.insert(this->doubles.end(), v.mData, v.mData + 2);
+            }
+            break;
+        case Value::Float3:
+            {
+                FbxDouble3 v = value.Get<FbxDouble3>();
+                val.type = FBXC_FLOAT3;
+                val.count = 3;
+                val.v.u = this->doubles.size();
+                this->doubles.insert(this->doubles.end(), v.mData, v.mData + 3);
+            }
+            break;
+        case Value::Float4:
+            {
+                FbxDouble4 v = value.Get<FbxDouble4>();
+                val.type = FBXC_FLOAT4;
+                val.count = 4;
+                val.v.u = this->doubles.size();
+                this->doubles.insert(this->doubles.end(), v.mData, v.mData + 4);
+            }
+            break;
+        case Value::String:
+            val.type = FBXC_STRING;
+            val.count = (std::uint32_t) std::strlen(value.GetString());
+            val.v.u = this->AddString(value.GetString());
+            break;
+        case Value::Array:
+            {
+                // reserve the element range first, nested arrays append
+                // their own elements behind it
+                const std::vector<Value>& elms = value.GetArray();
+                const std::size_t first = this->values.size();
+                this->values.resize(first + elms.size());
+                for (std::size_t i = 0; i < elms.size(); i++) {
+                    const fbxc_value elm = this->AddValue(elms[i]);
+                    this->values[first + i] = elm;
+                }
+                val.type = FBXC_ARRAY;
+                val.count = (std::uint32_t) elms.size();
+                val.v.u = first;
+            }
+            break;
+        default:
+            val.type = FBXC_VOID;
+            val.count = 0;
+            break;
+    }
+    return val;
+}
+
+//------------------------------------------------------------------------------
+fbxc_props
+BinaryDumper::AddProps(const PropertyMap& props) {
+    // PropertyMap entries are already sorted by key
+    fbxc_props range;
+    range.first = (std::uint32_t) this->properties.size();
+    range.count = (std::uint32_t) props.Size();
+    for (const PropertyMap::Entry& entry : props) {
+        fbxc_property prop = { };
+        prop.key = this->AddString(entry.Key);
+        prop.value = this->AddValue(entry.Val);
+        this->properties.push_back(prop);
+    }
+    return range;
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryDumper::Build(const ProxyScene& scene) {
+    this->AddString("");
+    this->sceneProps = this->AddProps(scene.Properties);
+    for (const ProxyObject& tex : scene.Textures) {
+        fbxc_object obj;
+        obj.props = this->AddProps(tex.Properties);
+        obj.user_props = this->AddProps(tex.UserProperties);
+        this->textures.push_back(obj);
+    }
+    for (const ProxyObject& mat : scene.Materials) {
+        fbxc_object obj;
+        obj.props = this->AddProps(mat.Properties);
+        obj.user_props = this->AddProps(mat.UserProperties);
+        this->materials.push_back(obj);
+    }
+    for (const ProxyMesh& mesh : scene.Meshes) {
+        fbxc_mesh m;
+        m.props = this->AddProps(mesh.Properties);
+        m.user_props = this->AddProps(mesh.UserProperties);
+        m.first_piece = (std::uint32_t) this->pieces.size();
+        m.num_pieces = (std::uint32_t) mesh.Pieces.size();
+        for (const auto& piece : mesh.Pieces) {
+            fbxc_piece p;
+            p.props = this->AddProps(piece.Properties);
+            this->pieces.push_back(p);
+        }
+        this->meshes.push_back(m);
+    }
+    for (const ProxyAnimation& anim : scene.Animations) {
+        fbxc_animation a;
+        a.props = this->AddProps(anim.Properties);
+        a.user_props = this->AddProps(anim.UserProperties);
+        a.first_track = (std::uint32_t) this->tracks.size();
+        a.num_tracks = (std::uint32_t) anim.Tracks.size();
+        for (const ProxyTrack& track : anim.Tracks) {
+            fbxc_track t;
+            t.props = this->AddProps(track.Properties);
+            this->tracks.push_back(t);
+        }
+        this->animations.push_back(a);
+    }
+    // the node links are already indices into the flat node array
+    this->nodes.reserve(scene.Nodes.size());
+    for (const ProxyNode& node : scene.Nodes) {
+        fbxc_node n;
+        n.props = this->AddProps(node.Properties);
+        n.user_props = this->AddProps(node.UserProperties);
+        n.parent = node.Parent;
+        n.first_child = node.FirstChild;
+        n.next_sibling = node.NextSibling;
+        n.reserved = 0;
+        this->nodes.push_back(n);
+    }
+    if (this->properties.size() > std::numeric_limits<std::uint32_t>::max()) {
+        Log::Fatal("binary scene has too many properties\n");
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryDumper::Write(const std::string& path) const {
+
+    // lay out the sections behind the header, each 8-byte aligned
+    fbxc_scene_header header = { };
+    std::memcpy(header.magic, FBXC_SCENE_MAGIC, sizeof(header.magic));
+    header.version = FBXC_SCENE_VERSION;
+    header.header_size = sizeof(header);
+    header.scene_props = this->sceneProps;
+    struct Chunk {
+        fbxc_section* Section;
+        const void* Data;
+        std::size_t Count;
+        std::size_t Size;
+    };
+    const Chunk chunks[] = {
+        { &header.nodes, this->nodes.data(), this->nodes.size(), this->nodes.size() * sizeof(fbxc_node) },
+        { &header.meshes, this->meshes.data(), this->meshes.size(), this->meshes.size() * sizeof(fbxc_mesh) },
+        { &header.pieces, this->pieces.data(), this->pieces.size(), this->pieces.size() * sizeof(fbxc_piece) },
+        { &header.animations, this->animations.data(), this->animations.size(), this->animations.size() * sizeof(fbxc_animation) },
+        { &header.tracks, this->tracks.data(), this->tracks.size(), this->tracks.size() * sizeof(fbxc_track) },
+        { &header.materials, this->materials.data(), this->materials.size(), this->materials.size() * sizeof(fbxc_object) },
+        { &header.textures, this->textures.data(), this->textures.size(), this->textures.size() * sizeof(fbxc_object) },
+        { &header.properties, this->properties.data(), this->properties.size(), this->properties.size() * sizeof(fbxc_property) },
+        { &header.values, this->values.data(), this->values.size(), this->values.size() * sizeof(fbxc_value) },
+        { &header.doubles, this->doubles.data(), this->doubles.size(), this->doubles.size() * sizeof(double) },
+        { &header.strings, this->strings.data(), this->strings.size(), this->strings.size() },
+    };
+    std::uint64_t pos = sizeof(header);
+    for (const Chunk& chunk : chunks) {
+        pos = (pos + 7) & ~std::uint64_t(7);
+        chunk.Section->offset = pos;
+        chunk.Section->count = chunk.Count;
+        pos += chunk.Size;
+    }
+    header.file_size = pos;
+
+    std::FILE* fp = std::fopen(path.c_str(), "wb");
+    if (nullptr == fp) {
+        Log::Fatal("failed to open output file '%s'\n", path.c_str());
+    }
+    static const char padding[8] = { };
+    bool writeOk = std::fwrite(&header, sizeof(header), 1, fp) == 1;
+    std::uint64_t written = sizeof(header);
+    for (const Chunk& chunk : chunks) {
+        const std::size_t padSize = (std::size_t) (chunk.Section->offset - written);
+        if (padSize > 0) {
+            writeOk &= std::fwrite(padding, 1, padSize, fp) == padSize;
+        }
+        if (chunk.Size > 0) {
+            writeOk &= std::fwrite(chunk.Data, 1, chunk.Size, fp) == chunk.Size;
+        }
+        written = chunk.Section->offset + chunk.Size;
+    }
+    if ((0 != std::fclose(fp)) || !writeOk) {
+        Log::Fatal("failed to write output file '%s'\n", path.c_str());
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,50 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::BinaryDumper
+    @brief dump a ProxyScene to a memory-mappable binary scene file
+
+    The file format is described in fbxc_scene.h, which is also the
+    reader for tools consuming the files.
+*/
+#include "ProxyScene.h"
+#include "fbxc_scene.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FBXC {
+
+class BinaryDumper {
+public:
+    /// write ProxyScene to a binary scene file
+    static void Dump(const ProxyScene& scene, const std::string& path);
+
+private:
+    /// add a string to the string table (if not yet there), return its offset
+    std::uint32_t AddString(const char* str);
+    /// convert a value, adds its data to the doubles, strings or values section
+    fbxc_value AddValue(const Value& value);
+    /// add the entries of a property map, return their range
+    fbxc_props AddProps(const PropertyMap& props);
+    /// build all sections from the proxy scene
+    void Build(const ProxyScene& scene);
+    /// write header and sections
+    void Write(const std::string& path) const;
+
+    fbxc_props sceneProps = { };
+    std::vector<char> strings;
+    std::unordered_map<std::string, std::uint32_t> stringOffsets;
+    std::vector<double> doubles;
+    std::vector<fbxc_value> values;
+    std::vector<fbxc_property> properties;
+    std::vector<fbxc_object> textures;
+    std::vector<fbxc_object> materials;
+    std::vector<fbxc_mesh> meshes;
+    std::vector<fbxc_piece> pieces;
+    std::vector<fbxc_animation> animations;
+    std::vector<fbxc_track> tracks;
+    std::vector<fbxc_node> nodes;
+};
+
+} // namespace FBXC
@@ -0,0 +1,396 @@
+//------------------------------------------------------------------------------
+//  BinaryFbx.cc
+//------------------------------------------------------------------------------
+#include "BinaryFbx.h"
+#include "Log.h"
+#include "zlib.h"
+#include <cstring>
+#include <fstream>
+
+namespace FBXC {
+
+/// the magic string at the start of every binary FBX file (including the trailing 0x1A, 0x00)
+static const char BinaryMagic[] = "Kaydara FBX Binary  \0\x1a";
+static const std::size_t BinaryMagicSize = sizeof(BinaryMagic);
+static const std::size_t BinaryHeaderSize = BinaryMagicSize + 4;
+
+//------------------------------------------------------------------------------
+template<typename TYPE> static TYPE
+ReadUnaligned(const std::uint8_t* ptr) {
+    TYPE val;
+    std::memcpy(&val, ptr, sizeof(val));
+    return val;
+}
+
+//------------------------------------------------------------------------------
+static std::uint32_t
+ArrayElementSize(char type) {
+    switch (type) {
+        case 'b': return 1;
+        case 'i':
+        case 'f': return 4;
+        case 'l':
+        case 'd': return 8;
+        default: return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/// decoded size of an array property in bytes, computed in 64 bits so it can't wrap
+static std::uint64_t
+ArrayByteSize(const BinaryFbx::Property& prop) {
+    return (std::uint64_t) prop.ArrayLength * ArrayElementSize(prop.Type);
+}
+
+/// upper limit for the decoded size of an array property
+static const std::uint64_t MaxArrayBytes = 1ull << 30;
+/// deflate can't compress better than about 1032:1
+static const std::uint64_t MaxInflateRatio = 1032;
+
+//------------------------------------------------------------------------------
+bool
+BinaryFbx::Node::Is(const char* name) const {
+    return (std::strlen(name) == this->NameLength) &&
+           (0 == std::memcmp(name, this->Name, this->NameLength));
+}
+
+//------------------------------------------------------------------------------
+std::int64_t
+BinaryFbx::Property::ToInt() const {
+    switch (this->Type) {
+        case 'C': return this->Data[0] != 0;
+        case 'Y': return ReadUnaligned<std::int16_t>(this->Data);
+        case 'I': return ReadUnaligned<std::int32_t>(this->Data);
+        case 'L': return ReadUnaligned<std::int64_t>(this->Data);
+        case 'F': return (std::int64_t) ReadUnaligned<float>(this->Data);
+        case 'D': return (std::int64_t) ReadUnaligned<double>(this->Data);
+        default: return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+double
+BinaryFbx::Property::ToDouble() const {
+    switch (this->Type) {
+        case 'F': return ReadUnaligned<float>(this->Data);
+        case 'D': return ReadUnaligned<double>(this->Data);
+        default: return (double) this->ToInt();
+    }
+}
+
+//------------------------------------------------------------------------------
+std::string
+BinaryFbx::Property::ToString() const {
+    if (this->IsString()) {
+        return std::string((const char*) this->Data, this->Size);
+    }
+    else {
+        return std::string();
+    }
+}
+
+//------------------------------------------------------------------------------
+BinaryFbx::BinaryFbx() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+BinaryFbx::~BinaryFbx() {
+    if (this->IsOpen()) {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+BinaryFbx::IsBinaryFbx(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char buf[BinaryMagicSize];
+    if (in.read(buf, BinaryMagicSize)) {
+        return 0 == std::memcmp(buf, BinaryMagic, BinaryMagicSize);
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::Open(const std::string& path) {
+    assert(!this->IsOpen());
+    if (!this->file.Open(path)) {
+        Log::Fatal("failed to map file '%s'\n", path.c_str());
+    }
+    if ((this->file.Size() < BinaryHeaderSize) ||
+        (0 != std::memcmp(this->file.Data(), BinaryMagic, BinaryMagicSize))) {
+        Log::Fatal("'%s' is not a binary FBX file\n", path.c_str());
+    }
+    this->version = ReadUnaligned<std::uint32_t>(this->file.Data() + BinaryMagicSize);
+    this->Parse();
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::Close() {
+    assert(this->IsOpen());
+    this->file.Close();
+    this->nodes.clear();
+    this->version = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::Parse() {
+    // starting with 7.5, record header fields are 64 bits wide
+    const bool wide = this->version >= 7500;
+    const std::size_t recHeaderSize = wide ? 25 : 13;
+    const std::uint8_t* base = this->file.Data();
+    const std::size_t size = this->file.Size();
+
+    // node 0 is a virtual root which owns the top-level records
+    this->nodes.clear();
+    this->nodes.emplace_back();
+
+    // walk the record tree iteratively, each frame is an open record list
+    struct Frame {
+        int parent;
+        int lastChild;
+        std::size_t end;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({ 0, -1, size });
+    std::size_t pos = BinaryHeaderSize;
+    while (!stack.empty()) {
+        const std::size_t listEnd = stack.back().end;
+        if ((pos == listEnd) && (stack.size() > 1)) {
+            // child list without terminating null record
+            stack.pop_back();
+            continue;
+        }
+        if (pos + recHeaderSize > listEnd) {
+            Log::Fatal("truncated FBX node record at offset %zu\n", pos);
+        }
+        const std::uint8_t* ptr = base + pos;
+        std::uint64_t endOffset, numProps, propListLen;
+        if (wide) {
+            endOffset = ReadUnaligned<std::uint64_t>(ptr);
+            numProps = ReadUnaligned<std::uint64_t>(ptr + 8);
+            propListLen = ReadUnaligned<std::uint64_t>(ptr + 16);
+        }
+        else {
+            endOffset = ReadUnaligned<std::uint32_t>(ptr);
+            numProps = ReadUnaligned<std::uint32_t>(ptr + 4);
+            propListLen = ReadUnaligned<std::uint32_t>(ptr + 8);
+        }
+        const std::uint8_t nameLen = ptr[recHeaderSize - 1];
+        if (0 == endOffset) {
+            // null record terminates the current list
+            pos += recHeaderSize;
+            stack.pop_back();
+            continue;
+        }
+        // compare against the remaining bytes, sizes from the file may overflow an addition
+        const std::size_t propBegin = pos + recHeaderSize + nameLen;
+        if ((endOffset > listEnd) || (endOffset <= pos) || (propBegin > endOffset) ||
+            (propListLen > endOffset - propBegin) || (numProps > propListLen)) {
+            Log::Fatal("malformed FBX node record at offset %zu\n", pos);
+        }
+
+        Node node;
+        node.Name = (const char*) (ptr + recHeaderSize);
+        node.NameLength = nameLen;
+        node.NumProperties = (std::uint32_t) numProps;
+        node.PropBegin = base + propBegin;
+        node.PropEnd = node.PropBegin + propListLen;
+        const int nodeIndex = (int) this->nodes.size();
+        this->nodes.push_back(node);
+
+        Frame& frame = stack.back();
+        if (frame.lastChild >= 0) {
+            this->nodes[frame.lastChild].NextSibling = nodeIndex;
+        }
+        else {
+            this->nodes[frame.parent].FirstChild = nodeIndex;
+        }
+        frame.lastChild = nodeIndex;
+
+        pos = propBegin + propListLen;
+        if (pos < endOffset) {
+            // record has a nested list
+            stack.push_back({ nodeIndex, -1, (std::size_t) endOffset });
+        }
+        else {
+            pos = endOffset;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+const BinaryFbx::Node*
+BinaryFbx::Find(const Node& node, const char* name) const {
+    for (const Node* child = this->Child(node); child; child = this->Next(*child)) {
+        if (child->Is(name)) {
+            return child;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+const std::uint8_t*
+BinaryFbx::ParseProperty(const std::uint8_t* ptr, const std::uint8_t* end, Property& outProp) {
+    if (ptr >= end) {
+        Log::Fatal("FBX property list overrun\n");
+    }
+    outProp = Property();
+    outProp.Type = (char) *ptr++;
+    std::uint32_t size = 0;
+    switch (outProp.Type) {
+        case 'C': size = 1; break;
+        case 'Y': size = 2; break;
+        case 'I':
+        case 'F': size = 4; break;
+        case 'L':
+        case 'D': size = 8; break;
+        case 'S':
+        case 'R':
+            if (ptr + 4 > end) {
+                Log::Fatal("FBX property list overrun\n");
+            }
+            size = ReadUnaligned<std::uint32_t>(ptr);
+            ptr += 4;
+            break;
+        case 'f':
+        case 'd':
+        case 'l':
+        case 'i':
+        case 'b':
+            if (ptr + 12 > end) {
+                Log::Fatal("FBX property list overrun\n");
+            }
+            outProp.ArrayLength = ReadUnaligned<std::uint32_t>(ptr);
+            outProp.Encoding = ReadUnaligned<std::uint32_t>(ptr + 4);
+            size = ReadUnaligned<std::uint32_t>(ptr + 8);
+            ptr += 12;
+            if ((0 == outProp.Encoding) && (size != ArrayByteSize(outProp))) {
+                Log::Fatal("FBX array property has invalid size\n");
+            }
+            if ((ArrayByteSize(outProp) > MaxArrayBytes) || (ArrayByteSize(outProp) > ((std::uint64_t) size + 64) * MaxInflateRatio)) {
+                Log::Fatal("FBX array property has invalid length %u\n", outProp.ArrayLength);
+            }
+            break;
+        default:
+            Log::Fatal("unknown FBX property type '%c'\n", outProp.Type);
+            break;
+    }
+    if (size > (std::size_t) (end - ptr)) {
+        Log::Fatal("FBX property list overrun\n");
+    }
+    outProp.Data = ptr;
+    outProp.Size = size;
+    return ptr + size;
+}
+
+//------------------------------------------------------------------------------
+BinaryFbx::Property
+BinaryFbx::GetProperty(const Node& node, std::uint32_t index) const {
+    assert(index < node.NumProperties);
+    Property prop;
+    const std::uint8_t* ptr = node.PropBegin;
+    for (std::uint32_t i = 0; i <= index; i++) {
+        ptr = ParseProperty(ptr, node.PropEnd, prop);
+    }
+    return prop;
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::Inflate(const Property& prop, std::vector<std::uint8_t>& out) {
+    assert(prop.IsArray());
+    if (1 != prop.Encoding) {
+        Log::Fatal("unknown FBX array encoding %d\n", prop.Encoding);
+    }
+    // the length has been validated by ParseProperty(), so this fits into a uLongf
+    assert(ArrayByteSize(prop) <= MaxArrayBytes);
+    uLongf dstSize = (uLongf) ArrayByteSize(prop);
+    out.resize(dstSize);
+    if (0 == dstSize) {
+        return;
+    }
+    int res = uncompress(out.data(), &dstSize, prop.Data, prop.Size);
+    if ((Z_OK != res) || (dstSize != out.size())) {
+        Log::Fatal("failed to inflate FBX array property (zlib error %d)\n", res);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> static void
+ConvertArray(char type, const std::uint8_t* src, std::uint32_t num, TYPE* dst) {
+    for (std::uint32_t i = 0; i < num; i++) {
+        switch (type) {
+            case 'b': dst[i] = (TYPE) src[i]; break;
+            case 'i': dst[i] = (TYPE) ReadUnaligned<std::int32_t>(src + i * 4); break;
+            case 'f': dst[i] = (TYPE) ReadUnaligned<float>(src + i * 4); break;
+            case 'l': dst[i] = (TYPE) ReadUnaligned<std::int64_t>(src + i * 8); break;
+            case 'd': dst[i] = (TYPE) ReadUnaligned<double>(src + i * 8); break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::DecodeArray(const Property& prop, const std::uint8_t* bytes, std::size_t numBytes, std::vector<double>& out) {
+    if (numBytes < ArrayByteSize(prop)) {
+        Log::Fatal("FBX array property has %u elements but only %u bytes\n", prop.ArrayLength, (unsigned) numBytes);
+    }
+    out.resize(prop.ArrayLength);
+    if ('d' == prop.Type) {
+        std::memcpy(out.data(), bytes, prop.ArrayLength * sizeof(double));
+    }
+    else {
+        ConvertArray(prop.Type, bytes, prop.ArrayLength, out.data());
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::DecodeArray(const Property& prop, const std::uint8_t* bytes, std::size_t numBytes, std::vector<std::int32_t>& out) {
+    if (numBytes < ArrayByteSize(prop)) {
+        Log::Fatal("FBX array property has %u elements but only %u bytes\n", prop.ArrayLength, (unsigned) numBytes);
+    }
+    out.resize(prop.ArrayLength);
+    if ('i' == prop.Type) {
+        std::memcpy(out.data(), bytes, prop.ArrayLength * sizeof(std::int32_t));
+    }
+    else {
+        ConvertArray(prop.Type, bytes, prop.ArrayLength, out.data());
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::ReadArray(const Property& prop, std::vector<double>& out) {
+    assert(prop.IsArray());
+    if (0 == prop.Encoding) {
+        DecodeArray(prop, prop.Data, prop.Size, out);
+    }
+    else {
+        std::vector<std::uint8_t> bytes;
+        Inflate(prop, bytes);
+        DecodeArray(prop, bytes.data(), bytes.size(), out);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BinaryFbx::ReadArray(const Property& prop, std::vector<std::int32_t>& out) {
+    assert(prop.IsArray());
+    if (0 == prop.Encoding) {
+        DecodeArray(prop, prop.Data, prop.Size, out);
+    }
+    else {
+        std::vector<std::uint8_t> bytes;
+        Inflate(prop, bytes);
+        DecodeArray(prop, bytes.data(), bytes.size(), out);
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,152 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::BinaryFbx
+    @brief in-place reader for binary FBX files
+
+    Maps a binary FBX file into memory and builds a flat index of its
+    node records. Node names and property values are not copied, they
+    point directly into the mapped file data. Property lists are decoded
+    on demand. Only little-endian hosts are supported.
+*/
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace FBXC {
+
+class BinaryFbx {
+public:
+    /// a typed property of a node record
+    struct Property {
+        /// FBX type code (Y, C, I, F, D, L, S, R, or f, d, l, i, b for arrays)
+        char Type = 0;
+        /// start of the payload in the mapped file
+        const std::uint8_t* Data = nullptr;
+        /// size of the payload in bytes (for arrays: the stored, possibly compressed size)
+        std::uint32_t Size = 0;
+        /// number of array elements
+        std::uint32_t ArrayLength = 0;
+        /// array encoding (0: raw, 1: zlib)
+        std::uint32_t Encoding = 0;
+
+        /// return true if this is an array property
+        bool IsArray() const;
+        /// return true if this is a string property
+        bool IsString() const;
+        /// get scalar value as integer
+        std::int64_t ToInt() const;
+        /// get scalar value as double
+        double ToDouble() const;
+        /// get string or raw value as std::string
+        std::string ToString() const;
+    };
+
+    /// a node record
+    struct Node {
+        const char* Name = nullptr;
+        std::uint32_t NameLength = 0;
+        std::uint32_t NumProperties = 0;
+        const std::uint8_t* PropBegin = nullptr;
+        const std::uint8_t* PropEnd = nullptr;
+        int FirstChild = -1;
+        int NextSibling = -1;
+
+        /// test the node name
+        bool Is(const char* name) const;
+    };
+
+    /// constructor
+    BinaryFbx();
+    /// destructor
+    ~BinaryFbx();
+
+    /// return true if the file at path is a binary FBX file
+    static bool IsBinaryFbx(const std::string& path);
+    /// map and index a binary FBX file
+    void Open(const std::string& path);
+    /// unmap file and discard node index
+    void Close();
+    /// return true if a file is open
+    bool IsOpen() const;
+    /// get the FBX file format version (e.g. 7400)
+    std::uint32_t Version() const;
+
+    /// get the virtual root node, its children are the top-level records
+    const Node& Root() const;
+    /// get first child of a node, or nullptr
+    const Node* Child(const Node& node) const;
+    /// get next sibling of a node, or nullptr
+    const Node* Next(const Node& node) const;
+    /// find first child node by name, or nullptr
+    const Node* Find(const Node& node, const char* name) const;
+    /// get a property of a node by index
+    Property GetProperty(const Node& node, std::uint32_t index) const;
+
+    /// decode a numeric array property into doubles
+    static void ReadArray(const Property& prop, std::vector<double>& out);
+    /// decode a numeric array property into 32-bit integers
+    static void ReadArray(const Property& prop, std::vector<std::int32_t>& out);
+    /// inflate a compressed array property into its raw element bytes
+    static void Inflate(const Property& prop, std::vector<std::uint8_t>& out);
+    /// convert raw element bytes of an array property into doubles, fatal error if numBytes is too small
+    static void DecodeArray(const Property& prop, const std::uint8_t* bytes, std::size_t numBytes, std::vector<double>& out);
+    /// convert raw element bytes of an array property into 32-bit integers, fatal error if numBytes is too small
+    static void DecodeArray(const Property& prop, const std::uint8_t* bytes, std::size_t numBytes, std::vector<std::int32_t>& out);
+
+private:
+    /// build the flat node index
+    void Parse();
+    /// parse a property header at ptr, return pointer past the property
+    static const std::uint8_t* ParseProperty(const std::uint8_t* ptr, const std::uint8_t* end, Property& outProp);
+
+    MappedFile file;
+    std::uint32_t version = 0;
+    std::vector<Node> nodes;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+BinaryFbx::Property::IsArray() const {
+    return (this->Type == 'f') || (this->Type == 'd') || (this->Type == 'l') ||
+           (this->Type == 'i') || (this->Type == 'b');
+}
+
+//------------------------------------------------------------------------------
+inline bool
+BinaryFbx::Property::IsString() const {
+    return (this->Type == 'S') || (this->Type == 'R');
+}
+
+//------------------------------------------------------------------------------
+inline bool
+BinaryFbx::IsOpen() const {
+    return this->file.IsOpen();
+}
+
+//------------------------------------------------------------------------------
+inline std::uint32_t
+BinaryFbx::Version() const {
+    return this->version;
+}
+
+//------------------------------------------------------------------------------
+inline const BinaryFbx::Node&
+BinaryFbx::Root() const {
+    return this->nodes[0];
+}
+
+//------------------------------------------------------------------------------
+inline const BinaryFbx::Node*
+BinaryFbx::Child(const Node& node) const {
+    return node.FirstChild >= 0 ? &this->nodes[node.FirstChild] : nullptr;
+}
+
+//------------------------------------------------------------------------------
+inline const BinaryFbx::Node*
+BinaryFbx::Next(const Node& node) const {
+    return node.NextSibling >= 0 ? &this->nodes[node.NextSibling] : nullptr;
+}
+
+} // namespace FBXC
@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+//  BlobWriter.cc
+//------------------------------------------------------------------------------
+#include "BlobWriter.h"
+#include "Log.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+BlobWriter::BlobWriter() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+BlobWriter::~BlobWriter() {
+    if (this->IsOpen()) {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+BlobWriter::Open(const std::string& path_) {
+    assert(!this->IsOpen());
+    this->fp = std::fopen(path_.c_str(), "wb");
+    if (nullptr == this->fp) {
+        Log::Fatal("failed to open blob file '%s' for writing\n", path_.c_str());
+    }
+    this->path = path_;
+    this->pos = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+BlobWriter::Close() {
+    assert(this->IsOpen());
+    if (0 != std::fclose(this->fp)) {
+        Log::Fatal("failed to write blob file '%s'\n", this->path.c_str());
+    }
+    this->fp = nullptr;
+}
+
+//------------------------------------------------------------------------------
+std::uint64_t
+BlobWriter::Write(const void* data, std::size_t size, std::size_t align) {
+    assert(this->IsOpen());
+    assert((align > 0) && (0 == (align & (align - 1))));
+    static const std::uint8_t padding[64] = { };
+    std::size_t padSize = (std::size_t) (((this->pos + align - 1) & ~(std::uint64_t)(align - 1)) - this->pos);
+    while (padSize > 0) {
+        const std::size_t chunk = padSize < sizeof(padding) ? padSize : sizeof(padding);
+        if (std::fwrite(padding, 1, chunk, this->fp) != chunk) {
+            Log::Fatal("failed to write blob file '%s'\n", this->path.c_str());
+        }
+        this->pos += chunk;
+        padSize -= chunk;
+    }
+    const std::uint64_t offset = this->pos;
+    if ((size > 0) && (std::fwrite(data, 1, size, this->fp) != size)) {
+        Log::Fatal("failed to write blob file '%s'\n", this->path.c_str());
+    }
+    this->pos += size;
+    return offset;
+}
+
+} // namespace FBXC
@@ -0,0 +1,52 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::BlobWriter
+    @brief sequentially write binary data chunks to a blob file
+
+    Each chunk is padded to the requested alignment, the returned
+    byte offsets are what ends up in the JSON output.
+*/
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace FBXC {
+
+class BlobWriter {
+public:
+    /// constructor
+    BlobWriter();
+    /// destructor
+    ~BlobWriter();
+
+    /// open blob file for writing
+    void Open(const std::string& path);
+    /// close the blob file
+    void Close();
+    /// return true if blob file is open
+    bool IsOpen() const;
+    /// write a chunk of data, return its byte offset in the blob
+    std::uint64_t Write(const void* data, std::size_t size, std::size_t align = 16);
+    /// get current blob size in bytes
+    std::uint64_t Size() const;
+
+private:
+    std::string path;
+    std::FILE* fp = nullptr;
+    std::uint64_t pos = 0;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+BlobWriter::IsOpen() const {
+    return nullptr != this->fp;
+}
+
+//------------------------------------------------------------------------------
+inline std::uint64_t
+BlobWriter::Size() const {
+    return this->pos;
+}
+
+} // namespace FBXC
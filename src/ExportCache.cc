@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+//  ExportCache.cc
+//------------------------------------------------------------------------------
+#include "ExportCache.h"
+#include "Hasher.h"
+#include "Log.h"
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+static void
+makeDirs(const std::string& path) {
+    for (std::string::size_type i = 1; i <= path.size(); i++) {
+        if ((i == path.size()) || (path[i] == '/') || (path[i] == '\\')) {
+            const std::string sub = path.substr(0, i);
+            #if defined(_WIN32)
+            _mkdir(sub.c_str());
+            #else
+            mkdir(sub.c_str(), 0755);
+            #endif
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static bool
+fileExists(const std::string& path) {
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    if (fp) {
+        std::fclose(fp);
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ExportCache::Setup(const std::string& dir_, const std::string& rulesPath, const char* version) {
+    assert(!this->isValid);
+    this->dir = dir_;
+    if (!this->dir.empty() && (this->dir.back() != '/') && (this->dir.back() != '\\')) {
+        this->dir.push_back('/');
+    }
+    makeDirs(this->dir.substr(0, this->dir.size() - 1));
+
+    // everything that is the same for all exported files
+    Hasher hasher;
+    hasher.Add(std::string(version));
+    if (!rulesPath.empty() && !hasher.AddFile(rulesPath)) {
+        Log::Fatal("failed to read rules file '%s'\n", rulesPath.c_str());
+    }
+    hasher.Digest(this->baseHash[0], this->baseHash[1]);
+    this->isValid = true;
+}
+
+//------------------------------------------------------------------------------
+std::string
+ExportCache::Key(const std::string& fbxPath, FBX::Reader reader, const ExportOptions& options, const std::string& outputPath) const {
+    assert(this->isValid);
+    Hasher hasher;
+    hasher.AddValue(this->baseHash);
+    hasher.AddValue((std::int32_t) reader);
+    hasher.AddValue(options.PlanarVertices);
+    hasher.AddValue(options.Weld);
+    hasher.AddValue(options.WeldEpsilon);
+    hasher.AddValue(options.OptimizeIndices);
+    hasher.AddValue(options.VertexCacheSize);
+    hasher.AddValue(options.SplitMeshes);
+    hasher.AddValue(options.FlattenHierarchy);
+    hasher.AddValue(options.Animations);
+    hasher.AddValue(options.AnimSampleRate);
+    hasher.AddValue((std::int32_t) options.AnimKeys);
+    hasher.AddValue(options.AnimTolerance);
+    hasher.AddValue((std::int32_t) options.AnimBits);
+    hasher.AddValue(options.Skin);
+    hasher.AddValue((std::int32_t) options.SkinInfluences);
+    hasher.AddValue(options.BlendShapes);
+    hasher.AddValue(options.BlendShapeEpsilon);
+    for (VertexFormat::Code fmt : options.VertexFormats) {
+        hasher.AddValue((std::int32_t) fmt);
+    }
+    hasher.AddValue((std::int32_t) options.Format);
+    hasher.AddValue(options.CompactJson);
+    // the JSON file references the blob by name
+    const std::string blobPath = FBX::BlobPath(outputPath);
+    const std::string::size_type dirEnd = blobPath.find_last_of("/\\");
+    hasher.Add((dirEnd == std::string::npos) ? blobPath : blobPath.substr(dirEnd + 1));
+    // ...and contains the FBX path as 'file'
+    hasher.Add(fbxPath);
+    if (!hasher.AddFile(fbxPath)) {
+        return std::string();
+    }
+    return hasher.HexDigest();
+}
+
+//------------------------------------------------------------------------------
+bool
+ExportCache::LinkOrCopy(const std::string& src, const std::string& dst) {
+    std::remove(dst.c_str());
+    #if defined(_WIN32)
+    if (CreateHardLinkA(dst.c_str(), src.c_str(), NULL)) {
+        return true;
+    }
+    #else
+    if (0 == link(src.c_str(), dst.c_str())) {
+        return true;
+    }
+    #endif
+
+    // different file systems, or no hard link support
+    std::FILE* srcFp = std::fopen(src.c_str(), "rb");
+    if (nullptr == srcFp) {
+        return false;
+    }
+    std::FILE* dstFp = std::fopen(dst.c_str(), "wb");
+    if (nullptr == dstFp) {
+        std::fclose(srcFp);
+        return false;
+    }
+    std::vector<char> buf(1 << 20);
+    bool ok = true;
+    std::size_t num;
+    while (ok && ((num = std::fread(buf.data(), 1, buf.size(), srcFp)) > 0)) {
+        ok = std::fwrite(buf.data(), 1, num, dstFp) == num;
+    }
+    ok = ok && !std::ferror(srcFp);
+    std::fclose(srcFp);
+    ok = (0 == std::fclose(dstFp)) && ok;
+    if (!ok) {
+        std::remove(dst.c_str());
+    }
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+bool
+ExportCache::Fetch(const std::string& key, const std::string& outputPath) const {
+    assert(this->isValid);
+    if (key.empty()) {
+        return false;
+    }
+    // Store() adds the JSON file last, so if it exists the blob exists too
+    const std::string jsonEntry = this->dir + key + ".json";
+    if (!fileExists(jsonEntry)) {
+        return false;
+    }
+    if (LinkOrCopy(this->dir + key + ".bin", FBX::BlobPath(outputPath)) && LinkOrCopy(jsonEntry, outputPath)) {
+        return true;
+    }
+    std::remove(outputPath.c_str());
+    std::remove(FBX::BlobPath(outputPath).c_str());
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ExportCache::Store(const std::string& key, const std::string& outputPath) const {
+    assert(this->isValid);
+    if (key.empty()) {
+        return;
+    }
+    // add entries under temporary names and rename them, so that
+    // concurrent fbxc processes and batch jobs never see partially
+    // written entries
+    #if defined(_WIN32)
+    const int pid = _getpid();
+    #else
+    const int pid = getpid();
+    #endif
+    const std::size_t tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+    const std::string tmpSuffix = ".tmp" + std::to_string(pid) + "_" + std::to_string(tid);
+    const std::string srcPaths[2] = { FBX::BlobPath(outputPath), outputPath };
+    const std::string entryPaths[2] = { this->dir + key + ".bin", this->dir + key + ".json" };
+    for (int i = 0; i < 2; i++) {
+        const std::string tmpPath = entryPaths[i] + tmpSuffix;
+        bool ok = LinkOrCopy(srcPaths[i], tmpPath);
+        #if defined(_WIN32)
+        ok = ok && MoveFileExA(tmpPath.c_str(), entryPaths[i].c_str(), MOVEFILE_REPLACE_EXISTING);
+        #else
+        ok = ok && (0 == std::rename(tmpPath.c_str(), entryPaths[i].c_str()));
+        #endif
+        if (!ok) {
+            std::remove(tmpPath.c_str());
+            Log::Warn("failed to add '%s' to export cache\n", srcPaths[i].c_str());
+            return;
+        }
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,52 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ExportCache
+    @brief content-addressed on-disk cache of exported JSON and blob files
+
+    The cache key is a hash of the FBX file path and content, the rules
+    file content, the fbxc version, the reader and export options, and
+    the blob file name (the path and blob name are referenced from the
+    JSON, so identical FBX files at different paths don't share
+    entries). On a hit the cached files are hard-linked (or copied if
+    linking fails) to the output paths, so the FBX file doesn't need
+    to be loaded.
+
+    Since outputs may be hard links into the cache, FBX::Export()
+    removes existing output files instead of overwriting them.
+*/
+#include <string>
+#include "FBX.h"
+
+namespace FBXC {
+
+class ExportCache {
+public:
+    /// setup with cache directory (created if missing), rules file path and tool version
+    void Setup(const std::string& dir, const std::string& rulesPath, const char* version);
+    /// return true if the cache has been setup
+    bool IsValid() const;
+
+    /// compute the cache key of an export, empty string if the FBX file can't be read
+    std::string Key(const std::string& fbxPath, FBX::Reader reader, const ExportOptions& options, const std::string& outputPath) const;
+    /// link or copy cached outputs to outputPath and its blob, return false on miss
+    bool Fetch(const std::string& key, const std::string& outputPath) const;
+    /// add outputs of a finished export to the cache
+    void Store(const std::string& key, const std::string& outputPath) const;
+
+private:
+    /// hard-link or copy a file, replacing dst, return false on failure
+    static bool LinkOrCopy(const std::string& src, const std::string& dst);
+
+    bool isValid = false;
+    std::string dir;
+    std::uint64_t baseHash[2] = { 0, 0 };
+};
+
+//------------------------------------------------------------------------------
+inline bool
+ExportCache::IsValid() const {
+    return this->isValid;
+}
+
+} // namespace FBXC
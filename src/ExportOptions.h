@@ -0,0 +1,80 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ExportOptions
+    @brief options which control what is exported and how
+
+    NOTE: options which change the exported data must also be added
+    to the cache key in ExportCache::Key().
+*/
+#include "MeshData.h"
+#include "VertexFormat.h"
+
+namespace FBXC {
+
+class ExportOptions {
+public:
+    /// scene structure output formats
+    enum SceneFormat {
+        JsonFormat,         // JSON text file
+        BinaryFormat,       // memory-mappable binary file, see fbxc_scene.h
+    };
+    /// interpolation between animation keys the keyframe reduction is done for
+    enum KeyInterpolation {
+        LinearKeys,
+        HermiteKeys,        // keys with tangents
+    };
+
+
+    /// constructor, sets float vertex formats, except for the skin components
+    ExportOptions() {
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            this->VertexFormats[i] = VertexFormat::FloatFormat(MeshData::ComponentSize((MeshData::Component) i));
+        }
+        this->VertexFormats[MeshData::Joints0] = VertexFormat::UByte4;
+        this->VertexFormats[MeshData::Joints1] = VertexFormat::UByte4;
+        this->VertexFormats[MeshData::Weights0] = VertexFormat::UByte4N;
+        this->VertexFormats[MeshData::Weights1] = VertexFormat::UByte4N;
+    };
+
+    /// write one stream per vertex component instead of interleaved vertices
+    bool PlanarVertices = false;
+    /// merge identical vertices and remove degenerate triangles
+    bool Weld = true;
+    /// if > 0, vertex components closer than this are considered identical
+    float WeldEpsilon = 0.0f;
+    /// reorder triangles and vertices for the vertex cache and vertex fetch
+    bool OptimizeIndices = true;
+    /// size of the simulated post-transform vertex cache
+    int VertexCacheSize = 16;
+    /// write 16-bit indices, split meshes with too many vertices into pieces
+    bool SplitMeshes = false;
+    /// merge the meshes of each subtree into one mesh per kept node (see HierarchyFlattener)
+    bool FlattenHierarchy = false;
+    /// sample node animation into keyframe tracks
+    bool Animations = false;
+    /// animation samples per second
+    double AnimSampleRate = 30.0;
+    /// interpolation of the animation keys
+    KeyInterpolation AnimKeys = LinearKeys;
+    /// max. per-component error of samples dropped by the keyframe reduction
+    float AnimTolerance = 0.0001f;
+    /// if > 0, quantize animation keys to this many bits and drop constant tracks (see TrackQuantizer)
+    int AnimBits = 0;
+    /// export skin influences of skinned meshes (see SkinExtractor)
+    bool Skin = false;
+    /// max. number of skin influences per vertex (1..8)
+    int SkinInfluences = 4;
+    /// export sparse blend shape deltas (see ShapeExtractor)
+    bool BlendShapes = false;
+    /// blend shape deltas up to this size are dropped
+    float BlendShapeEpsilon = 0.00001f;
+    /// output format of each vertex component
+    VertexFormat::Code VertexFormats[MeshData::NumComponents];
+    /// format of the scene structure file
+    SceneFormat Format = JsonFormat;
+    /// write JSON without line breaks and indentation
+    bool CompactJson = false;
+};
+
+} // namespace FBXC
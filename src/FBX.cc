@@ -4,7 +4,20 @@
 #include "FBX.h"
 #include "Log.h"
 #include "ProxyBuilder.h"
+#include "NativeBuilder.h"
 #include "JsonDumper.h"
+#include "BinaryDumper.h"
+#include "MeshSource.h"
+#include "MeshPipeline.h"
+#include "BlobWriter.h"
+#include "HierarchyFlattener.h"
+#include "AnimPipeline.h"
+#include "TangentGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <unordered_map>
 
 namespace FBXC {
 
@@ -22,12 +35,19 @@ FBX::~FBX() {
 
 //------------------------------------------------------------------------------
 void
-FBX::Setup() {
+FBX::Setup(Reader reader_, int numJobs) {
     assert(!this->isValid);
     assert(nullptr == this->fbxManager);
     assert(nullptr == this->fbxIoSettings);
     assert(nullptr == this->fbxScene);
     
+    this->reader = reader_;
+    this->threadPool.Setup(numJobs);
+    this->arrayCache.Setup(&this->threadPool);
+    if (NativeReader == this->reader) {
+        this->isValid = true;
+        return;
+    }
     this->fbxManager = FbxManager::Create();
     if (nullptr == this->fbxManager) {
         Log::Fatal("failed to  FbxManager\n");
@@ -48,8 +68,13 @@ FBX::Setup() {
 void
 FBX::Discard() {
     assert(this->isValid);
-    assert(nullptr != this->fbxManager);
-    this->fbxManager->Destroy();
+    if (this->IsLoaded()) {
+        this->Unload();
+    }
+    this->threadPool.Discard();
+    if (this->fbxManager) {
+        this->fbxManager->Destroy();
+    }
     this->fbxManager = nullptr;
     this->fbxIoSettings = nullptr;
     this->fbxScene = nullptr;
@@ -58,10 +83,19 @@ FBX::Discard() {
 
 //------------------------------------------------------------------------------
 void
-FBX::Load(const std::string& fbxPath) {
+FBX::Load(const std::string& fbxPath, const Rules& rules) {
+    assert(this->isValid);
+    assert(!this->IsLoaded());
+    this->filePath = fbxPath;
+
+    if (NativeReader == this->reader) {
+        this->binaryFbx.Open(fbxPath);
+        NativeBuilder::Build(this->binaryFbx, this->arrayCache, fbxPath, rules, this->proxyScene);
+        return;
+    }
+
     assert(nullptr != this->fbxManager);
     assert(nullptr != this->fbxScene);
-    this->filePath = fbxPath;
     
     // setup the importer
     FbxImporter* fbxImporter = FbxImporter::Create(this->fbxManager, "importer");
@@ -80,15 +114,290 @@ FBX::Load(const std::string& fbxPath) {
     fbxImporter->Destroy();
     
     // build proxy scene
-    ProxyBuilder::Build(this->fbxScene, fbxPath, this->proxyScene);
+    ProxyBuilder::Build(this->fbxScene, fbxPath, rules, this->proxyScene);
 }
 
 //------------------------------------------------------------------------------
 void
-FBX::Dump() {
-    std::string jsonString = JsonDumper::Dump(this->proxyScene);
-    Log::Info("%s\n", jsonString.c_str());
+FBX::Unload() {
+    assert(this->isValid);
+    assert(this->IsLoaded());
+
+    // the proxy scene points into the FbxScene and BinaryFbx, so it must go first
+    this->proxyScene = ProxyScene();
+    this->arrayCache.Clear();
+    if (this->binaryFbx.IsOpen()) {
+        this->binaryFbx.Close();
+    }
+    // only the scene content is reset, the manager and its IO plugins stay registered
+    if (this->fbxScene) {
+        this->fbxScene->Clear();
+    }
+    this->filePath.clear();
 }
 
-} // namespace FBXC
+//------------------------------------------------------------------------------
+void
+FBX::Dump(bool compact) {
+    JsonWriter writer;
+    writer.OpenStdout(compact);
+    JsonDumper::Dump(this->proxyScene, writer);
+    writer.Raw("\n");
+    writer.Close();
+}
+
+//------------------------------------------------------------------------------
+std::string
+FBX::BlobPath(const std::string& outputPath) {
+    const std::string::size_type dirEnd = outputPath.find_last_of("/\\");
+    const std::string::size_type extStart = outputPath.find_last_of('.');
+    std::string blobPath = outputPath;
+    if ((extStart != std::string::npos) && ((dirEnd == std::string::npos) || (extStart > dirEnd))) {
+        blobPath.erase(extStart);
+    }
+    blobPath.append(".bin");
+    return blobPath;
+}
 
+//------------------------------------------------------------------------------
+void
+FBX::Export(const std::string& outputPath, const ExportOptions& options, const MeshCache* meshCache) {
+    assert(this->isValid);
+
+    // flattening replaces the scene meshes with merged meshes, the
+    // source meshes then only provide the vertex data
+    std::vector<ProxyMesh> sourceMeshes;
+    std::vector<std::vector<MeshMerger::Part>> mergedParts;
+    if (options.FlattenHierarchy) {
+        HierarchyFlattener::Flatten(this->proxyScene, sourceMeshes, mergedParts);
+    }
+    const std::vector<ProxyMesh>& sourceList = options.FlattenHierarchy ? sourceMeshes : this->proxyScene.Meshes;
+
+    // inflate all mesh arrays of the native reader up front, in parallel
+    if (NativeReader == this->reader) {
+        std::vector<BinaryFbx::Property> arrays;
+        for (const ProxyMesh& mesh : sourceList) {
+            if (mesh.GeomNode) {
+                MeshSource::CollectArrays(this->binaryFbx, *mesh.GeomNode, arrays);
+            }
+            if (options.Skin) {
+                for (const BinaryFbx::Node* clusterNode : mesh.ClusterNodes) {
+                    MeshSource::CollectClusterArrays(this->binaryFbx, *clusterNode, arrays);
+                }
+            }
+            if (options.BlendShapes) {
+                for (const BinaryFbx::Node* shapeNode : mesh.ShapeNodes) {
+                    if (shapeNode) {
+                        MeshSource::CollectShapeArrays(this->binaryFbx, *shapeNode, arrays);
+                    }
+                }
+            }
+        }
+        this->arrayCache.Prefetch(arrays);
+    }
+
+    // the blob file goes next to the scene file, existing outputs are
+    // removed rather than overwritten because they may be hard links
+    // into an export cache
+    const std::string blobPath = BlobPath(outputPath);
+    if (blobPath == outputPath) {
+        Log::Fatal("output path '%s' must not have a .bin extension, it's used for the vertex data blob\n", outputPath.c_str());
+    }
+    const std::string::size_type dirEnd = blobPath.find_last_of("/\\");
+    const std::string blobName = (dirEnd == std::string::npos) ? blobPath : blobPath.substr(dirEnd + 1);
+    std::remove(outputPath.c_str());
+    std::remove(blobPath.c_str());
+
+    // process meshes in parallel, FBX SDK calls are not thread-safe, so
+    // the SDK mesh arrays are locked up front and released afterwards
+    // on this thread, the native reader decodes its arrays in parallel
+    std::vector<ProxyMesh>& meshes = this->proxyScene.Meshes;
+    std::atomic<int> numCacheHits(0);
+    if (options.FlattenHierarchy) {
+        // a source mesh may be instanced into several merged meshes,
+        // so all sources are set up before the merged meshes are processed
+        std::vector<std::unique_ptr<MeshSource>> sources(sourceMeshes.size());
+        std::vector<const MeshSource*> sourcePtrs(sourceMeshes.size());
+        auto setupSource = [this, &sourceMeshes, &sources, &sourcePtrs](int i) {
+            sources[i].reset(new MeshSource());
+            if (NativeReader == this->reader) {
+                sources[i]->Setup(this->binaryFbx, this->arrayCache, *sourceMeshes[i].GeomNode);
+            }
+            else {
+                sources[i]->Setup(sourceMeshes[i].As<FbxMesh>());
+            }
+            sourcePtrs[i] = sources[i].get();
+        };
+        if (NativeReader == this->reader) {
+            this->threadPool.ParallelFor((int) sourceMeshes.size(), setupSource);
+        }
+        else {
+            for (std::size_t i = 0; i < sourceMeshes.size(); i++) {
+                setupSource((int) i);
+            }
+        }
+        this->ProcessMeshes([&meshes, &mergedParts, &sourcePtrs, &options, meshCache, &numCacheHits](int i, ThreadPool* pool) {
+            if (MeshPipeline::ProcessMerged(mergedParts[i], sourcePtrs, options, meshCache, pool, meshes[i])) {
+                numCacheHits++;
+            }
+        });
+        sources.clear();
+    }
+    else {
+        // a mesh gets generated tangents if any node using it asks for them
+        std::unordered_map<std::uint64_t, int> meshIndexById;
+        for (std::size_t i = 0; i < meshes.size(); i++) {
+            meshIndexById[meshes[i].Properties["id"].Get<std::uint64_t>()] = (int) i;
+        }
+        for (const ProxyNode& node : this->proxyScene.Nodes) {
+            if (node.RegenerateTangents && node.Properties.Contains("meshes")) {
+                for (const Value& meshId : node.Properties["meshes"].GetArray()) {
+                    auto it = meshIndexById.find(meshId.Get<std::uint64_t>());
+                    if (it != meshIndexById.end()) {
+                        meshes[it->second].GenerateTangents = true;
+                    }
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<MeshSource>> sources(meshes.size());
+        if (SdkReader == this->reader) {
+            for (std::size_t i = 0; i < meshes.size(); i++) {
+                sources[i].reset(new MeshSource());
+                sources[i]->Setup(meshes[i].As<FbxMesh>());
+                if (options.BlendShapes) {
+                    sources[i]->SetupShapes(meshes[i].As<FbxMesh>());
+                }
+            }
+        }
+        this->ProcessMeshes([this, &meshes, &sources, &options, meshCache, &numCacheHits](int i, ThreadPool* pool) {
+            bool cacheHit = false;
+            if (NativeReader == this->reader) {
+                sources[i].reset(new MeshSource());
+                sources[i]->Setup(this->binaryFbx, this->arrayCache, *meshes[i].GeomNode);
+                if (options.Skin && !meshes[i].ClusterNodes.empty()) {
+                    sources[i]->SetupSkin(this->binaryFbx, this->arrayCache, meshes[i].ClusterNodes);
+                }
+                if (options.BlendShapes && !meshes[i].ShapeNodes.empty()) {
+                    sources[i]->SetupShapes(this->binaryFbx, this->arrayCache, meshes[i].ShapeNodes);
+                }
+                cacheHit = MeshPipeline::Process(*sources[i], options, meshCache, pool, meshes[i]);
+                sources[i].reset();
+            }
+            else {
+                cacheHit = MeshPipeline::Process(*sources[i], options, meshCache, pool, meshes[i]);
+            }
+            if (cacheHit) {
+                numCacheHits++;
+            }
+        });
+        sources.clear();
+    }
+    this->numCachedMeshes = numCacheHits;
+    if (options.Animations) {
+        this->ProcessAnimations(options);
+    }
+    else {
+        this->proxyScene.Animations.clear();
+    }
+
+    // blob layout only depends on mesh order, not on the number of threads
+    BlobWriter blob;
+    blob.Open(blobPath);
+    for (ProxyMesh& mesh : meshes) {
+        MeshPipeline::Write(options, blob, mesh);
+    }
+    for (ProxyAnimation& anim : this->proxyScene.Animations) {
+        AnimPipeline::Write(options, blob, anim);
+    }
+    blob.Close();
+    this->proxyScene.Properties.Add("blob", blobName);
+
+    if (ExportOptions::BinaryFormat == options.Format) {
+        BinaryDumper::Dump(this->proxyScene, outputPath);
+    }
+    else {
+        JsonWriter writer;
+        writer.Open(outputPath, options.CompactJson);
+        JsonDumper::Dump(this->proxyScene, writer);
+        writer.Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+FBX::ProcessMeshes(const std::function<void(int, ThreadPool*)>& process) {
+    // a mesh ParallelFor job can't use the pool itself, so meshes with
+    // enough triangles for a tangent job on each thread go first, one
+    // at a time with the whole pool, and the others in parallel
+    std::vector<ProxyMesh>& meshes = this->proxyScene.Meshes;
+    const std::int32_t minPolygons = (std::int32_t) TangentGenerator::ItemsPerJob * this->threadPool.NumThreads();
+    std::vector<int> others;
+    for (std::size_t i = 0; i < meshes.size(); i++) {
+        const bool large = meshes[i].GenerateTangents && (this->threadPool.NumThreads() > 1) &&
+            meshes[i].Properties.Contains("numpolygons") && (meshes[i].Properties["numpolygons"].Get<std::int32_t>() >= minPolygons);
+        if (large) {
+            process((int) i, &this->threadPool);
+        }
+        else {
+            others.push_back((int) i);
+        }
+    }
+    this->threadPool.ParallelFor((int) others.size(), [&others, &process](int i) {
+        process(others[i], nullptr);
+    });
+}
+
+//------------------------------------------------------------------------------
+void
+FBX::ProcessAnimations(const ExportOptions& options) {
+    std::vector<ProxyAnimation>& anims = this->proxyScene.Animations;
+
+    // the curve keys are copied into the converter's own curves, SDK
+    // curves on this thread, native curves decode their arrays in parallel
+    std::vector<ProxyAnimation::Curve*> curves;
+    for (ProxyAnimation& anim : anims) {
+        for (ProxyAnimation::Curve& curve : anim.Curves) {
+            curves.push_back(&curve);
+        }
+    }
+    if (NativeReader == this->reader) {
+        this->threadPool.ParallelFor((int) curves.size(), [this, &curves](int i) {
+            curves[i]->Data.Setup(this->binaryFbx, this->arrayCache, *curves[i]->CurveNode);
+        });
+    }
+    else {
+        for (ProxyAnimation::Curve* curve : curves) {
+            curve->Data.Setup(curve->FbxCurve);
+        }
+    }
+
+    // each job samples a range of one target with its own curve cursors
+    struct Job {
+        ProxyAnimation* Anim;
+        int Target;
+        int FirstSample;
+        int NumSamples;
+    };
+    std::vector<Job> jobs;
+    std::vector<ProxyTrack*> tracks;
+    for (ProxyAnimation& anim : anims) {
+        const int numSamples = AnimPipeline::Setup(options, this->proxyScene.Nodes, anim);
+        for (std::size_t target = 0; target < anim.Targets.size(); target++) {
+            for (int first = 0; first < numSamples; first += AnimPipeline::SamplesPerJob) {
+                jobs.push_back(Job{ &anim, (int) target, first, std::min(numSamples - first, (int) AnimPipeline::SamplesPerJob) });
+            }
+        }
+        for (ProxyTrack& track : anim.Tracks) {
+            tracks.push_back(&track);
+        }
+    }
+    this->threadPool.ParallelFor((int) jobs.size(), [&jobs, &options](int i) {
+        AnimPipeline::Sample(options, *jobs[i].Anim, jobs[i].Target, jobs[i].FirstSample, jobs[i].NumSamples);
+    });
+    this->threadPool.ParallelFor((int) tracks.size(), [&tracks, &options](int i) {
+        AnimPipeline::Reduce(options, *tracks[i]);
+    });
+}
+
+} // namespace FBXC
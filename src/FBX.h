@@ -7,36 +7,70 @@
 #include <fbxsdk.h>
 #include <string>
 #include "ProxyScene.h"
+#include "BinaryFbx.h"
+#include "ArrayCache.h"
+#include "ThreadPool.h"
+#include "ExportOptions.h"
+#include "MeshCache.h"
+#include "Rules.h"
 
 namespace FBXC {
 
 class FBX {
 public:
+    /// FBX file readers
+    enum Reader {
+        SdkReader,      // FbxImporter + ProxyBuilder
+        NativeReader,   // memory-mapped BinaryFbx + NativeBuilder
+    };
+
     /// constructor
     FBX();
     /// destructor
     ~FBX();
     
-    /// setup the FBX SDK
-    void Setup();
+    /// setup the FBX SDK (not needed by the native reader), numJobs 0 means one job per hardware thread
+    void Setup(Reader reader, int numJobs);
     /// discard everything
     void Discard();
     /// return true if object has been setup
     bool IsValid() const;
     
     /// load an FBX file
-    void Load(const std::string& path);
-    /// dump the FBX scene structure
-    void Dump();
+    void Load(const std::string& path, const Rules& rules);
+    /// discard the loaded file, keeps the FBX SDK manager and thread pool alive for the next Load()
+    void Unload();
+    /// return true if a file is loaded
+    bool IsLoaded() const;
+    /// access to the proxy scene of the loaded file
+    const ProxyScene& Scene() const;
+    /// dump the FBX scene structure as JSON to stdout
+    void Dump(bool compact);
+    /// process meshes (reusing processed meshes from an optional mesh cache), write JSON to outputPath and vertex/index data to a blob next to it
+    void Export(const std::string& outputPath, const ExportOptions& options, const MeshCache* meshCache);
+    /// number of meshes taken from the mesh cache by the last Export()
+    int NumCachedMeshes() const;
+    /// return the blob path of a JSON output path (same path with .bin extension)
+    static std::string BlobPath(const std::string& outputPath);
     
     
 private:
-    bool isValid;
+    /// call process(i, pool) for each mesh, meshes large enough to spread tangent generation over the pool first, one at a time, the others in parallel
+    void ProcessMeshes(const std::function<void(int, ThreadPool*)>& process);
+    /// set up the animation curves, sample and keyframe-reduce all tracks in parallel
+    void ProcessAnimations(const ExportOptions& options);
+
+    bool isValid = false;
+    Reader reader = SdkReader;
     std::string filePath;
     FbxManager* fbxManager = nullptr;
     FbxIOSettings* fbxIoSettings = nullptr;
     FbxScene* fbxScene = nullptr;
+    BinaryFbx binaryFbx;
+    ThreadPool threadPool;
+    ArrayCache arrayCache;
     ProxyScene proxyScene;
+    int numCachedMeshes = 0;
 };
 
 //------------------------------------------------------------------------------
@@ -45,4 +79,22 @@ FBX::IsValid() const {
     return this->isValid;
 }
 
+//------------------------------------------------------------------------------
+inline bool
+FBX::IsLoaded() const {
+    return !this->filePath.empty();
+}
+
+//------------------------------------------------------------------------------
+inline int
+FBX::NumCachedMeshes() const {
+    return this->numCachedMeshes;
+}
+
+//------------------------------------------------------------------------------
+inline const ProxyScene&
+FBX::Scene() const {
+    return this->proxyScene;
+}
+
 } // namespace FBXC
\ No newline at end of file
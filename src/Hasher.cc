@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+//  Hasher.cc
+//------------------------------------------------------------------------------
+#include "Hasher.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace FBXC {
+
+static const std::uint64_t c1 = 0x87c37b91114253d5ULL;
+static const std::uint64_t c2 = 0x4cf5ad432745937fULL;
+
+//------------------------------------------------------------------------------
+static inline std::uint64_t
+rotl(std::uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+//------------------------------------------------------------------------------
+static inline std::uint64_t
+fmix(std::uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+//------------------------------------------------------------------------------
+Hasher::Hasher(std::uint64_t seed) :
+    h1(seed),
+    h2(seed) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+Hasher::Block(const std::uint8_t* block) {
+    std::uint64_t k1, k2;
+    std::memcpy(&k1, block, 8);
+    std::memcpy(&k2, block + 8, 8);
+
+    k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; this->h1 ^= k1;
+    this->h1 = rotl(this->h1, 27); this->h1 += this->h2; this->h1 = this->h1 * 5 + 0x52dce729;
+    k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; this->h2 ^= k2;
+    this->h2 = rotl(this->h2, 31); this->h2 += this->h1; this->h2 = this->h2 * 5 + 0x38495ab5;
+}
+
+//------------------------------------------------------------------------------
+void
+Hasher::Add(const void* data, std::size_t size) {
+    const std::uint8_t* ptr = (const std::uint8_t*) data;
+    this->totalSize += size;
+
+    // complete a pending partial block first
+    if (this->tailSize > 0) {
+        const std::size_t num = std::min(size, sizeof(this->tail) - this->tailSize);
+        std::memcpy(this->tail + this->tailSize, ptr, num);
+        this->tailSize += num;
+        ptr += num;
+        size -= num;
+        if (this->tailSize < sizeof(this->tail)) {
+            return;
+        }
+        this->Block(this->tail);
+        this->tailSize = 0;
+    }
+    while (size >= 16) {
+        this->Block(ptr);
+        ptr += 16;
+        size -= 16;
+    }
+    if (size > 0) {
+        std::memcpy(this->tail, ptr, size);
+        this->tailSize = size;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Hasher::Add(const std::string& str) {
+    this->AddValue((std::uint64_t) str.size());
+    this->Add(str.data(), str.size());
+}
+
+//------------------------------------------------------------------------------
+bool
+Hasher::AddFile(const std::string& path) {
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    if (nullptr == fp) {
+        return false;
+    }
+    // hashed in chunks, the result is the same as for a single Add()
+    std::vector<std::uint8_t> buf(1 << 20);
+    std::size_t num;
+    while ((num = std::fread(buf.data(), 1, buf.size(), fp)) > 0) {
+        this->Add(buf.data(), num);
+    }
+    const bool readOk = !std::ferror(fp);
+    std::fclose(fp);
+    return readOk;
+}
+
+//------------------------------------------------------------------------------
+void
+Hasher::Digest(std::uint64_t& outH1, std::uint64_t& outH2) const {
+    std::uint64_t x1 = this->h1;
+    std::uint64_t x2 = this->h2;
+
+    // remaining bytes of the last partial block
+    std::uint64_t k1 = 0;
+    std::uint64_t k2 = 0;
+    for (std::size_t i = this->tailSize; i > 8; i--) {
+        k2 ^= std::uint64_t(this->tail[i - 1]) << ((i - 9) * 8);
+    }
+    if (this->tailSize > 8) {
+        k2 *= c2; k2 = rotl(k2, 33); k2 *= c1; x2 ^= k2;
+    }
+    for (std::size_t i = std::min<std::size_t>(this->tailSize, 8); i > 0; i--) {
+        k1 ^= std::uint64_t(this->tail[i - 1]) << ((i - 1) * 8);
+    }
+    if (this->tailSize > 0) {
+        k1 *= c1; k1 = rotl(k1, 31); k1 *= c2; x1 ^= k1;
+    }
+
+    x1 ^= this->totalSize;
+    x2 ^= this->totalSize;
+    x1 += x2;
+    x2 += x1;
+    x1 = fmix(x1);
+    x2 = fmix(x2);
+    x1 += x2;
+    x2 += x1;
+    outH1 = x1;
+    outH2 = x2;
+}
+
+//------------------------------------------------------------------------------
+std::string
+Hasher::HexDigest() const {
+    std::uint64_t d[2];
+    this->Digest(d[0], d[1]);
+    static const char* hexDigits = "0123456789abcdef";
+    std::string str;
+    for (std::uint64_t x : d) {
+        for (int shift = 60; shift >= 0; shift -= 4) {
+            str.push_back(hexDigits[(x >> shift) & 0xF]);
+        }
+    }
+    return str;
+}
+
+} // namespace FBXC
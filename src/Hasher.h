@@ -0,0 +1,52 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::Hasher
+    @brief incremental 128-bit content hash (MurmurHash3 x64_128)
+
+    Feeding the same bytes in different chunks produces the same hash.
+    Not a cryptographic hash, only meant to identify content.
+*/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FBXC {
+
+class Hasher {
+public:
+    /// constructor
+    Hasher(std::uint64_t seed = 0);
+
+    /// add raw bytes
+    void Add(const void* data, std::size_t size);
+    /// add a string, prefixed with its length
+    void Add(const std::string& str);
+    /// add a plain-old-data value
+    template<class T> void AddValue(const T& val);
+    /// add the content of a file, return false if the file can't be read
+    bool AddFile(const std::string& path);
+
+    /// get the 128-bit hash of all bytes added so far
+    void Digest(std::uint64_t& outH1, std::uint64_t& outH2) const;
+    /// get the hash as a 32 character hex string
+    std::string HexDigest() const;
+
+private:
+    /// mix a 16-byte block into the hash state
+    void Block(const std::uint8_t* block);
+
+    std::uint64_t h1;
+    std::uint64_t h2;
+    std::uint64_t totalSize = 0;
+    std::uint8_t tail[16];
+    std::size_t tailSize = 0;
+};
+
+//------------------------------------------------------------------------------
+template<class T> inline void
+Hasher::AddValue(const T& val) {
+    this->Add(&val, sizeof(val));
+}
+
+} // namespace FBXC
@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+//  HierarchyFlattener.cc
+//------------------------------------------------------------------------------
+#include "HierarchyFlattener.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+HierarchyFlattener::Flatten(ProxyScene& scene, std::vector<ProxyMesh>& outSourceMeshes, std::vector<std::vector<MeshMerger::Part>>& outParts) {
+    outSourceMeshes.clear();
+    outParts.clear();
+    std::unordered_map<std::uint64_t, int> meshIndexById;
+    for (std::size_t i = 0; i < scene.Meshes.size(); i++) {
+        meshIndexById[scene.Meshes[i].Properties["id"].Get<std::uint64_t>()] = (int) i;
+    }
+
+    // parents come before their children in the flat node array, so
+    // the owner of a node (itself if it remains, else the owner of its
+    // parent) is always known when the node is visited
+    ProxyScene flat;
+    const int numNodes = (int) scene.Nodes.size();
+    std::vector<int> owner(numNodes);
+    std::vector<int> flatIndex(numNodes);
+    std::vector<int> lastChild;
+    std::vector<Matrix44> invWorlds;
+    std::vector<std::vector<MeshMerger::Part>> parts;
+    std::vector<std::vector<std::uint64_t>> materialIds;
+    for (int i = 0; i < numNodes; i++) {
+        const ProxyNode& node = scene.Nodes[i];
+        const bool isRoot = 0 == i;
+        if (isRoot || node.Keep) {
+            const int parent = isRoot ? ProxyNode::InvalidIndex : flatIndex[owner[node.Parent]];
+            const int index = flat.AddNode(parent, isRoot ? ProxyNode::InvalidIndex : lastChild[parent]);
+            if (!isRoot) {
+                lastChild[parent] = index;
+            }
+            lastChild.resize(index + 1);
+            lastChild[index] = ProxyNode::InvalidIndex;
+            owner[i] = i;
+            flatIndex[i] = index;
+
+            ProxyNode& flatNode = flat.Nodes[index];
+            flatNode.Object = node.Object;
+            flatNode.World = node.World;
+            flatNode.Keep = node.Keep;
+            flatNode.UserProperties = node.UserProperties;
+            for (const PropertyMap::Entry& entry : node.Properties) {
+                if (0 != std::strcmp(entry.Key, "meshes")) {
+                    flatNode.Properties.Add(entry.Key, entry.Val);
+                }
+            }
+            if (!isRoot) {
+                const Matrix44 local = scene.Nodes[owner[node.Parent]].World.Inverse() * node.World;
+                std::vector<Value> values(16);
+                for (int j = 0; j < 16; j++) {
+                    values[j].Set(local.M[j]);
+                }
+                flatNode.Properties.Add("transform", std::move(values));
+            }
+            invWorlds.push_back(node.World.Inverse());
+            parts.emplace_back();
+            materialIds.emplace_back();
+        }
+        else {
+            owner[i] = owner[node.Parent];
+        }
+
+        // the node's mesh instances go into the merged mesh of its owner
+        if (!node.Properties.Contains("meshes")) {
+            continue;
+        }
+        const int ownerIndex = flatIndex[owner[i]];
+        const Matrix44 transform = invWorlds[ownerIndex] * node.World * node.Geometric;
+        for (const Value& meshId : node.Properties["meshes"].GetArray()) {
+            auto it = meshIndexById.find(meshId.Get<std::uint64_t>());
+            if (it == meshIndexById.end()) {
+                continue;
+            }
+            MeshMerger::Part part;
+            part.Source = it->second;
+            part.Transform = transform;
+            part.GenerateTangents = node.RegenerateTangents;
+            const ProxyMesh& srcMesh = scene.Meshes[it->second];
+            if (srcMesh.Properties.Contains("materials")) {
+                std::vector<std::uint64_t>& ids = materialIds[ownerIndex];
+                for (const Value& matId : srcMesh.Properties["materials"].GetArray()) {
+                    const std::uint64_t id = matId.Get<std::uint64_t>();
+                    auto idIt = std::find(ids.begin(), ids.end(), id);
+                    part.MaterialMap.push_back((std::int32_t) (idIt - ids.begin()));
+                    if (idIt == ids.end()) {
+                        ids.push_back(id);
+                    }
+                }
+            }
+            parts[ownerIndex].push_back(std::move(part));
+        }
+    }
+
+    // one merged mesh for each remaining node with mesh instances
+    std::vector<ProxyMesh> mergedMeshes;
+    for (std::size_t i = 0; i < parts.size(); i++) {
+        if (parts[i].empty()) {
+            continue;
+        }
+        ProxyNode& flatNode = flat.Nodes[i];
+        mergedMeshes.emplace_back();
+        ProxyMesh& mesh = mergedMeshes.back();
+        BuildMergedProperties(scene.Meshes, parts[i], mesh);
+        for (const MeshMerger::Part& part : parts[i]) {
+            mesh.GenerateTangents |= part.GenerateTangents;
+        }
+        const Value& id = flatNode.Properties["id"];
+        mesh.Properties.Add("id", id);
+        flatNode.Properties.Add("meshes", std::vector<Value>(1, id));
+        if (!materialIds[i].empty()) {
+            std::vector<Value> ids(materialIds[i].size());
+            for (std::size_t j = 0; j < ids.size(); j++) {
+                ids[j].Set(materialIds[i][j]);
+            }
+            mesh.Properties.Add("materials", std::move(ids));
+        }
+        outParts.push_back(std::move(parts[i]));
+    }
+
+    // only the source meshes which are used move out of the scene
+    std::vector<int> sourceIndex(scene.Meshes.size(), -1);
+    for (std::vector<MeshMerger::Part>& meshParts : outParts) {
+        for (MeshMerger::Part& part : meshParts) {
+            if (sourceIndex[part.Source] < 0) {
+                sourceIndex[part.Source] = (int) outSourceMeshes.size();
+                outSourceMeshes.push_back(std::move(scene.Meshes[part.Source]));
+            }
+            part.Source = sourceIndex[part.Source];
+        }
+    }
+    // animation targets of merged nodes are dropped with their node
+    for (ProxyAnimation& anim : scene.Animations) {
+        std::vector<ProxyAnimation::Target> targets;
+        for (ProxyAnimation::Target& target : anim.Targets) {
+            if (owner[target.Node] == target.Node) {
+                target.Node = flatIndex[target.Node];
+                targets.push_back(target);
+            }
+        }
+        anim.Targets = std::move(targets);
+    }
+    scene.Meshes = std::move(mergedMeshes);
+    scene.Nodes = std::move(flat.Nodes);
+}
+
+//------------------------------------------------------------------------------
+void
+HierarchyFlattener::BuildMergedProperties(const std::vector<ProxyMesh>& sourceMeshes, const std::vector<MeshMerger::Part>& parts, ProxyMesh& mesh) {
+    static const char* flags[] = {
+        "hasnormals", "hastangents", "hasbinormals", "hasmaterials",
+        "haspolygongroups", "hasvertexcolor", "hasuserdata", "hasvisibility"
+    };
+    std::int32_t numPoints = 0;
+    std::int32_t numPolygons = 0;
+    bool flagValues[sizeof(flags) / sizeof(flags[0])] = { };
+    const Value* uvSets = nullptr;
+    std::vector<Value> sourceIds;
+    for (const MeshMerger::Part& part : parts) {
+        const PropertyMap& props = sourceMeshes[part.Source].Properties;
+        numPoints += props.Contains("numpoints") ? props["numpoints"].Get<std::int32_t>() : 0;
+        numPolygons += props.Contains("numpolygons") ? props["numpolygons"].Get<std::int32_t>() : 0;
+        for (std::size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+            flagValues[i] |= props.Contains(flags[i]) && props[flags[i]].Get<bool>();
+        }
+        // texcoord streams are merged by index, so take the names of the longest list
+        if (props.Contains("uvsets") && (!uvSets || (props["uvsets"].GetArray().size() > uvSets->GetArray().size()))) {
+            uvSets = &props["uvsets"];
+        }
+        sourceIds.push_back(props["id"]);
+    }
+    mesh.Properties.Add("numpoints", numPoints);
+    mesh.Properties.Add("numpolygons", numPolygons);
+    for (std::size_t i = 0; i < sizeof(flags) / sizeof(flags[0]); i++) {
+        mesh.Properties.Add(flags[i], flagValues[i]);
+    }
+    if (uvSets) {
+        mesh.Properties.Add("uvsets", *uvSets);
+    }
+    mesh.Properties.Add("sourcemeshes", std::move(sourceIds));
+}
+
+} // namespace FBXC
@@ -0,0 +1,36 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::HierarchyFlattener
+    @brief collapse the node hierarchy into merged meshes
+
+    Only the root node and the nodes marked with the 'keep' rule action
+    remain, every other node is merged into its nearest remaining
+    ancestor (its owner). Each remaining node gets a single merged mesh
+    with the meshes of all nodes it owns, the material lists of the
+    source meshes are combined, so that the mesh pipeline's material
+    sort groups the triangles of all source meshes by material.
+
+    Merged meshes have the id of their owner node. A kept node gets
+    a 'transform' property (16 doubles, column-major) relative to its
+    remaining parent, mesh vertices are transformed into the space of
+    the owner node (world space for the root). Animation targets of
+    merged nodes are dropped, the tracks of kept nodes stay relative
+    to their FBX parent.
+*/
+#include "ProxyScene.h"
+#include "MeshMerger.h"
+
+namespace FBXC {
+
+class HierarchyFlattener {
+public:
+    /// flatten the scene, the source meshes move to outSourceMeshes, scene.Meshes[i] is merged from outParts[i]
+    static void Flatten(ProxyScene& scene, std::vector<ProxyMesh>& outSourceMeshes, std::vector<std::vector<MeshMerger::Part>>& outParts);
+
+private:
+    /// build the properties of a merged mesh from its source meshes
+    static void BuildMergedProperties(const std::vector<ProxyMesh>& sourceMeshes, const std::vector<MeshMerger::Part>& parts, ProxyMesh& mesh);
+};
+
+} // namespace FBXC
@@ -2,193 +2,214 @@
 //  JsonDumper.cc
 //------------------------------------------------------------------------------
 #include "JsonDumper.h"
-#include <cstdlib>
+#include <algorithm>
+#include <vector>
 
 namespace FBXC {
 
 //------------------------------------------------------------------------------
-std::string
-JsonDumper::Dump(const ProxyScene& scene) {
-    cJSON* jsonRoot = cJSON_CreateObject();
-    
-    DumpProperties(scene.Properties, jsonRoot);
-    DumpTextures(scene, jsonRoot);
-    DumpMaterials(scene, jsonRoot);
-    DumpMeshes(scene, jsonRoot);
-    DumpNodes(scene, jsonRoot, nullptr);
-    
-    char* rawStr = cJSON_Print(jsonRoot);
-    std::string jsonStr(rawStr);
-    std::free(rawStr);
-    cJSON_Delete(jsonRoot);
-    return jsonStr;
+void
+JsonDumper::Dump(const ProxyScene& scene, JsonWriter& writer) {
+    writer.BeginObject();
+    DumpProperties(scene.Properties, writer);
+    DumpTextures(scene, writer);
+    DumpMaterials(scene, writer);
+    DumpMeshes(scene, writer);
+    DumpAnimations(scene, writer);
+    DumpNodes(scene, writer);
+    writer.EndObject();
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpProperties(const PropertyMap& props, cJSON* jsonNode) {
-    for (const auto& kvp : props.Content()) {
-        const std::string& key = kvp.first;
-        const Value& value = kvp.second;
-        switch (value.type) {
-            case Value::Bool:
-                cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateBool(value.Get<bool>()));
-                break;
-            case Value::Id:
-                cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateNumber(value.Get<std::uint64_t>()));
-                break;
-            case Value::Int:
-                cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateNumber(value.Get<std::int32_t>()));
-                break;
-            case Value::Float:
-                cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateNumber(value.Get<double>()));
-                break;
-            case Value::Float2:
-                {
-                    FbxDouble2 v = value.Get<FbxDouble2>();
-                    cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateDoubleArray(v.mData, 2));
-                }
-                break;
-            case Value::Float3:
-                {
-                    FbxDouble3 v = value.Get<FbxDouble3>();
-                    cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateDoubleArray(v.mData, 3));
-                }
-                break;
-            case Value::Float4:
-                {
-                    FbxDouble4 v = value.Get<FbxDouble4>();
-                    cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateDoubleArray(v.mData, 4));
-                }
-                break;
-            case Value::String:
-                cJSON_AddItemToObject(jsonNode, key.c_str(), cJSON_CreateString(value.strValue.c_str()));
-                break;
-                
-            case Value::Array:
-                {
-                    cJSON* jsonArray = cJSON_CreateArray();
-                    cJSON_AddItemToObject(jsonNode, key.c_str(), jsonArray);
-                    for (const auto& arrayVal : value.arrayValue) {
-                        switch (arrayVal.type) {
-                            case Value::Bool:
-                                cJSON_AddItemToArray(jsonArray, cJSON_CreateBool(arrayVal.Get<bool>()));
-                                break;
-                            case Value::Id:
-                                cJSON_AddItemToArray(jsonArray, cJSON_CreateNumber(arrayVal.Get<std::uint64_t>()));
-                                break;
-                            case Value::Int:
-                                cJSON_AddItemToArray(jsonArray, cJSON_CreateNumber(arrayVal.Get<std::int32_t>()));
-                                break;
-                            case Value::Float:
-                                cJSON_AddItemToArray(jsonArray, cJSON_CreateNumber(arrayVal.Get<double>()));
-                                break;
-                            case Value::Float2:
-                                {
-                                    FbxDouble2 v = arrayVal.Get<FbxDouble2>();
-                                    cJSON_AddItemToArray(jsonArray, cJSON_CreateDoubleArray(v.mData, 2));
-                                }
-                                break;
-                            case Value::Float3:
-                                {
-                                    FbxDouble3 v = arrayVal.Get<FbxDouble3>();
-                                    cJSON_AddItemToArray(jsonArray, cJSON_CreateDoubleArray(v.mData, 3));
-                                }
-                                break;
-                            case Value::Float4:
-                                {
-                                    FbxDouble4 v = arrayVal.Get<FbxDouble4>();
-                                    cJSON_AddItemToArray(jsonArray, cJSON_CreateDoubleArray(v.mData, 4));
-                                }
-                                break;
-                            case Value::String:
-                                cJSON_AddItemToArray(jsonArray, cJSON_CreateString(arrayVal.strValue.c_str()));
-                                break;
-                            default:
-                                // nested array type not supported
-                                break;
-                        }
-                    }
-                }
-                break;
-                
-            default:
-                // void type, do nothing
-                break;
+JsonDumper::DumpProperties(const PropertyMap& props, JsonWriter& writer) {
+    for (const PropertyMap::Entry& entry : props) {
+        if (Value::Void != entry.Val.GetType()) {
+            writer.Key(entry.Key);
+            DumpValue(entry.Val, writer);
         }
     }
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpUserProperties(const ProxyObject& obj, cJSON* jsonNode) {
-    if (obj.UserProperties.Content().size() > 0) {
-        cJSON* jsonUserProps = cJSON_CreateObject();
-        cJSON_AddItemToObject(jsonNode, "userproperties", jsonUserProps);
-        DumpProperties(obj.UserProperties, jsonUserProps);
+JsonDumper::DumpValue(const Value& value, JsonWriter& writer) {
+    switch (value.GetType()) {
+        case Value::Bool:
+            writer.Bool(value.Get<bool>());
+            break;
+        case Value::Id:
+            writer.UInt64(value.Get<std::uint64_t>());
+            break;
+        case Value::Int:
+            writer.Int(value.Get<std::int32_t>());
+            break;
+        case Value::Float:
+            writer.Double(value.Get<double>());
+            break;
+        case Value::Float2:
+            {
+                FbxDouble2 v = value.Get<FbxDouble2>();
+                writer.DoubleArray(v.mData, 2);
+            }
+            break;
+        case Value::Float3:
+            {
+                FbxDouble3 v = value.Get<FbxDouble3>();
+                writer.DoubleArray(v.mData, 3);
+            }
+            break;
+        case Value::Float4:
+            {
+                FbxDouble4 v = value.Get<FbxDouble4>();
+                writer.DoubleArray(v.mData, 4);
+            }
+            break;
+        case Value::String:
+            writer.String(value.GetString());
+            break;
+
+        case Value::Array:
+            writer.BeginArray();
+            for (const auto& arrayVal : value.GetArray()) {
+                // nested array type not supported
+                if ((Value::Void != arrayVal.GetType()) && (Value::Array != arrayVal.GetType())) {
+                    DumpValue(arrayVal, writer);
+                }
+            }
+            writer.EndArray();
+            break;
+
+        default:
+            // void type, skipped by the callers
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JsonDumper::DumpUserProperties(const ProxyObject& obj, JsonWriter& writer) {
+    if (!obj.UserProperties.Empty()) {
+        writer.Key("userproperties");
+        writer.BeginObject();
+        DumpProperties(obj.UserProperties, writer);
+        writer.EndObject();
     }
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpTextures(const ProxyScene& scene, cJSON* jsonNode) {
-    cJSON* jsonTextures = cJSON_CreateArray();
-    cJSON_AddItemToObject(jsonNode, "textures", jsonTextures);
+JsonDumper::DumpTextures(const ProxyScene& scene, JsonWriter& writer) {
+    writer.Key("textures");
+    writer.BeginArray();
     for (const auto& tex : scene.Textures) {
-        cJSON* jsonTex = cJSON_CreateObject();
-        cJSON_AddItemToArray(jsonTextures, jsonTex);
-        DumpProperties(tex.Properties, jsonTex);
-        DumpUserProperties(tex, jsonTex);
+        writer.BeginObject();
+        DumpProperties(tex.Properties, writer);
+        DumpUserProperties(tex, writer);
+        writer.EndObject();
     }
+    writer.EndArray();
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpMaterials(const ProxyScene& scene, cJSON* jsonNode) {
-    cJSON* jsonMaterials = cJSON_CreateArray();
-    cJSON_AddItemToObject(jsonNode, "materials", jsonMaterials);
+JsonDumper::DumpMaterials(const ProxyScene& scene, JsonWriter& writer) {
+    writer.Key("materials");
+    writer.BeginArray();
     for (const auto& mat : scene.Materials) {
-        cJSON* jsonMat = cJSON_CreateObject();
-        cJSON_AddItemToArray(jsonMaterials, jsonMat);
-        DumpProperties(mat.Properties, jsonMat);
-        DumpUserProperties(mat, jsonMat);
+        writer.BeginObject();
+        DumpProperties(mat.Properties, writer);
+        DumpUserProperties(mat, writer);
+        writer.EndObject();
     }
+    writer.EndArray();
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpMeshes(const ProxyScene& scene, cJSON* jsonNode) {
-    cJSON* jsonMeshes = cJSON_CreateArray();
-    cJSON_AddItemToObject(jsonNode, "meshes", jsonMeshes);
+JsonDumper::DumpMeshes(const ProxyScene& scene, JsonWriter& writer) {
+    writer.Key("meshes");
+    writer.BeginArray();
     for (const auto& mesh : scene.Meshes) {
-        cJSON* jsonMesh = cJSON_CreateObject();
-        cJSON_AddItemToArray(jsonMeshes, jsonMesh);
-        DumpProperties(mesh.Properties, jsonMesh);
-        DumpUserProperties(mesh, jsonMesh);
+        writer.BeginObject();
+        DumpProperties(mesh.Properties, writer);
+        DumpUserProperties(mesh, writer);
+        if (!mesh.Pieces.empty()) {
+            writer.Key("pieces");
+            writer.BeginArray();
+            for (const auto& piece : mesh.Pieces) {
+                writer.BeginObject();
+                DumpProperties(piece.Properties, writer);
+                writer.EndObject();
+            }
+            writer.EndArray();
+        }
+        writer.EndObject();
+    }
+    writer.EndArray();
+}
+
+//------------------------------------------------------------------------------
+void
+JsonDumper::DumpAnimations(const ProxyScene& scene, JsonWriter& writer) {
+    if (scene.Animations.empty()) {
+        return;
     }
+    writer.Key("animations");
+    writer.BeginArray();
+    for (const auto& anim : scene.Animations) {
+        writer.BeginObject();
+        DumpProperties(anim.Properties, writer);
+        DumpUserProperties(anim, writer);
+        writer.Key("tracks");
+        writer.BeginArray();
+        for (const auto& track : anim.Tracks) {
+            writer.BeginObject();
+            DumpProperties(track.Properties, writer);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
 }
 
 //------------------------------------------------------------------------------
 void
-JsonDumper::DumpNodes(const ProxyScene& scene, cJSON* jsonNode, const ProxyNode* node) {
-    if (nullptr == node) {
-        cJSON* jsonRoot = cJSON_CreateObject();
-        cJSON_AddItemToObject(jsonNode, "nodes", jsonRoot);
-        jsonNode = jsonRoot;
-        node = &scene.Nodes;
+JsonDumper::DumpNodes(const ProxyScene& scene, JsonWriter& writer) {
+    if (scene.Nodes.empty()) {
+        return;
     }
-    
-    DumpProperties(node->Properties, jsonNode);
-    DumpUserProperties(*node, jsonNode);
-    
-    // recurse into children
-    if (node->Children.size() > 0) {
-        cJSON* jsonChildArray = cJSON_CreateArray();
-        cJSON_AddItemToObject(jsonNode, "children", jsonChildArray);
-        for (const auto& childNode : node->Children) {
-            cJSON* jsonChildNode = cJSON_CreateObject();
-            cJSON_AddItemToArray(jsonChildArray, jsonChildNode);
-            DumpNodes(scene, jsonChildNode, &childNode);
+    writer.Key("nodes");
+
+    // a node's object stays open while its children are written, this is
+    // marked by pushing the bitwise complement of its index before them
+    std::vector<int> stack(1, 0);
+    while (!stack.empty()) {
+        const int entry = stack.back();
+        stack.pop_back();
+        if (entry < 0) {
+            writer.EndArray();
+            writer.EndObject();
+            continue;
+        }
+        const ProxyNode& node = scene.Nodes[entry];
+        writer.BeginObject();
+        DumpProperties(node.Properties, writer);
+        DumpUserProperties(node, writer);
+
+        if (node.FirstChild != ProxyNode::InvalidIndex) {
+            writer.Key("children");
+            writer.BeginArray();
+            stack.push_back(~entry);
+            const std::size_t first = stack.size();
+            for (int child = node.FirstChild; child != ProxyNode::InvalidIndex; child = scene.Nodes[child].NextSibling) {
+                stack.push_back(child);
+            }
+            std::reverse(stack.begin() + first, stack.end());
+        }
+        else {
+            writer.EndObject();
         }
     }
 }
@@ -5,28 +5,32 @@
     @brief dump a ProxyScene to JSON
 */
 #include "ProxyScene.h"
-#include "cJSON.h"
+#include "JsonWriter.h"
 
 namespace FBXC {
 
 class JsonDumper {
 public:
-    /// dump ProxyScene to string
-    static std::string Dump(const ProxyScene& scene);
-    
+    /// stream ProxyScene as a JSON object into an open writer
+    static void Dump(const ProxyScene& scene, JsonWriter& writer);
+
 private:
-    /// dump a property key/values to json object
-    static void DumpProperties(const PropertyMap& props, cJSON* jsonNode);
+    /// dump property key/values into the current json object
+    static void DumpProperties(const PropertyMap& props, JsonWriter& writer);
+    /// dump a single (non-void) value
+    static void DumpValue(const Value& value, JsonWriter& writer);
     /// dump user properties of an object
-    static void DumpUserProperties(const ProxyObject& obj, cJSON* jsonNode);
+    static void DumpUserProperties(const ProxyObject& obj, JsonWriter& writer);
     /// dump textures in scene
-    static void DumpTextures(const ProxyScene& scene, cJSON* jsonNode);
+    static void DumpTextures(const ProxyScene& scene, JsonWriter& writer);
     /// dump materials in scene
-    static void DumpMaterials(const ProxyScene& scene, cJSON* jsonNode);
+    static void DumpMaterials(const ProxyScene& scene, JsonWriter& writer);
     /// dump meshes in scene
-    static void DumpMeshes(const ProxyScene& scene, cJSON* jsonNode);
+    static void DumpMeshes(const ProxyScene& scene, JsonWriter& writer);
+    /// dump animations with their tracks (only if there are any)
+    static void DumpAnimations(const ProxyScene& scene, JsonWriter& writer);
     /// dump node hierarchy
-    static void DumpNodes(const ProxyScene& scene, cJSON* jsonNode, const ProxyNode* node);
+    static void DumpNodes(const ProxyScene& scene, JsonWriter& writer);
 };
 
-} // namespace FBXC
\ No newline at end of file
+} // namespace FBXC
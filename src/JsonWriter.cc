@@ -0,0 +1,285 @@
+//------------------------------------------------------------------------------
+//  JsonWriter.cc
+//------------------------------------------------------------------------------
+#include "JsonWriter.h"
+#include "Log.h"
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+JsonWriter::JsonWriter() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+JsonWriter::~JsonWriter() {
+    if (this->IsOpen()) {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Open(const std::string& path_, bool compact_) {
+    assert(!this->IsOpen());
+    this->fp = std::fopen(path_.c_str(), "wb");
+    if (nullptr == this->fp) {
+        Log::Fatal("failed to open output file '%s'\n", path_.c_str());
+    }
+    this->path = path_;
+    this->ownsFile = true;
+    this->compact = compact_;
+    this->afterKey = false;
+    this->writeFailed = false;
+    this->scopes.clear();
+    this->buffer.resize(BufferSize);
+    this->bufferPos = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::OpenStdout(bool compact_) {
+    assert(!this->IsOpen());
+    std::fflush(stdout);
+    this->fp = stdout;
+    this->path = "<stdout>";
+    this->ownsFile = false;
+    this->compact = compact_;
+    this->afterKey = false;
+    this->writeFailed = false;
+    this->scopes.clear();
+    this->buffer.resize(BufferSize);
+    this->bufferPos = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Close() {
+    assert(this->IsOpen());
+    assert(this->scopes.empty());
+    this->Flush();
+    if (this->ownsFile) {
+        if (0 != std::fclose(this->fp)) {
+            this->writeFailed = true;
+        }
+    }
+    else if (0 != std::fflush(this->fp)) {
+        this->writeFailed = true;
+    }
+    this->fp = nullptr;
+    if (this->writeFailed) {
+        Log::Fatal("failed to write output file '%s'\n", this->path.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Flush() {
+    assert(this->IsOpen());
+    if ((this->bufferPos > 0) && (std::fwrite(this->buffer.data(), 1, this->bufferPos, this->fp) != this->bufferPos)) {
+        this->writeFailed = true;
+    }
+    this->bufferPos = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Put(const char* data, std::size_t size) {
+    if (this->bufferPos + size > BufferSize) {
+        this->Flush();
+        if (size > BufferSize) {
+            if (std::fwrite(data, 1, size, this->fp) != size) {
+                this->writeFailed = true;
+            }
+            return;
+        }
+    }
+    std::memcpy(this->buffer.data() + this->bufferPos, data, size);
+    this->bufferPos += size;
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::BeginValue() {
+    if (this->afterKey) {
+        this->afterKey = false;
+        return;
+    }
+    if (!this->scopes.empty()) {
+        Scope& scope = this->scopes.back();
+        assert(!scope.IsObject);
+        if (scope.NumItems++ > 0) {
+            this->compact ? this->Put(',') : this->Put(", ", 2);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::BeginObject() {
+    this->BeginValue();
+    this->Put('{');
+    this->scopes.push_back(Scope{ true, 0 });
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::EndObject() {
+    assert(!this->scopes.empty() && this->scopes.back().IsObject && !this->afterKey);
+    const bool empty = 0 == this->scopes.back().NumItems;
+    this->scopes.pop_back();
+    if (!this->compact && !empty) {
+        this->Put('\n');
+        for (std::size_t i = 0; i < this->scopes.size(); i++) {
+            this->Put('\t');
+        }
+    }
+    this->Put('}');
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::BeginArray() {
+    this->BeginValue();
+    this->Put('[');
+    this->scopes.push_back(Scope{ false, 0 });
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::EndArray() {
+    assert(!this->scopes.empty() && !this->scopes.back().IsObject);
+    this->scopes.pop_back();
+    this->Put(']');
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Key(const char* key) {
+    assert(key);
+    assert(!this->scopes.empty() && this->scopes.back().IsObject && !this->afterKey);
+    Scope& scope = this->scopes.back();
+    if (scope.NumItems++ > 0) {
+        this->Put(',');
+    }
+    if (!this->compact) {
+        this->Put('\n');
+        for (std::size_t i = 0; i < this->scopes.size(); i++) {
+            this->Put('\t');
+        }
+    }
+    this->PutString(key);
+    this->compact ? this->Put(':') : this->Put(":\t", 2);
+    this->afterKey = true;
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Bool(bool b) {
+    this->BeginValue();
+    b ? this->Put("true", 4) : this->Put("false", 5);
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Int(std::int32_t i) {
+    this->BeginValue();
+    char buf[16];
+    const int len = std::snprintf(buf, sizeof(buf), "%" PRId32, i);
+    this->Put(buf, len);
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::UInt64(std::uint64_t u) {
+    this->BeginValue();
+    char buf[24];
+    const int len = std::snprintf(buf, sizeof(buf), "%" PRIu64, u);
+    this->Put(buf, len);
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Double(double d) {
+    this->BeginValue();
+    if (!std::isfinite(d)) {
+        this->Put("null", 4);
+        return;
+    }
+    // any decimal with up to 15 significant digits survives a round trip
+    // through double, so the first precision which reads back exactly is
+    // also the shortest representation
+    char buf[32];
+    int len = 0;
+    for (int precision = 15; precision <= 17; precision++) {
+        len = std::snprintf(buf, sizeof(buf), "%.*g", precision, d);
+        if (std::strtod(buf, nullptr) == d) {
+            break;
+        }
+    }
+    this->Put(buf, len);
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::DoubleArray(const double* d, int num) {
+    this->BeginArray();
+    for (int i = 0; i < num; i++) {
+        this->Double(d[i]);
+    }
+    this->EndArray();
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::String(const char* str) {
+    this->BeginValue();
+    this->PutString(str);
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::Raw(const char* str) {
+    assert(str);
+    this->Put(str, std::strlen(str));
+}
+
+//------------------------------------------------------------------------------
+void
+JsonWriter::PutString(const char* str) {
+    assert(str);
+    this->Put('"');
+    // copy runs of characters which don't need escaping in one go
+    const char* run = str;
+    for (const char* p = str; *p; p++) {
+        const unsigned char c = (unsigned char) *p;
+        if ((c >= 0x20) && (c != '"') && (c != '\\')) {
+            continue;
+        }
+        this->Put(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"':   this->Put("\\\"", 2); break;
+            case '\\':  this->Put("\\\\", 2); break;
+            case '\b':  this->Put("\\b", 2); break;
+            case '\f':  this->Put("\\f", 2); break;
+            case '\n':  this->Put("\\n", 2); break;
+            case '\r':  this->Put("\\r", 2); break;
+            case '\t':  this->Put("\\t", 2); break;
+            default:
+                {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    this->Put(buf, 6);
+                }
+                break;
+        }
+    }
+    this->Put(run, std::strlen(run));
+    this->Put('"');
+}
+
+} // namespace FBXC
@@ -0,0 +1,106 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::JsonWriter
+    @brief stream JSON text to a file or stdout through a fixed-size buffer
+
+    The document is written front to back as the Begin/End/Key/value
+    calls come in, memory use doesn't depend on the document size.
+    Doubles are written with the fewest digits which read back to the
+    same value. The pretty layout indents object members with tabs and
+    keeps arrays on one line, compact mode writes no whitespace at all.
+*/
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace FBXC {
+
+class JsonWriter {
+public:
+    /// constructor
+    JsonWriter();
+    /// destructor
+    ~JsonWriter();
+
+    /// open a JSON file for writing
+    void Open(const std::string& path, bool compact);
+    /// write to stdout instead of a file
+    void OpenStdout(bool compact);
+    /// flush the buffer and close the file
+    void Close();
+    /// return true if writer is open
+    bool IsOpen() const;
+
+    /// begin an object
+    void BeginObject();
+    /// end the current object
+    void EndObject();
+    /// begin an array
+    void BeginArray();
+    /// end the current array
+    void EndArray();
+    /// write the key of the next object member
+    void Key(const char* key);
+    /// write a bool value
+    void Bool(bool b);
+    /// write a signed integer value
+    void Int(std::int32_t i);
+    /// write an unsigned 64-bit integer value
+    void UInt64(std::uint64_t u);
+    /// write a double value (null if not finite)
+    void Double(double d);
+    /// write an array of double values
+    void DoubleArray(const double* d, int num);
+    /// write a string value
+    void String(const char* str);
+    /// write raw text (e.g. a line break)
+    void Raw(const char* str);
+
+private:
+    /// an open object or array
+    struct Scope {
+        bool IsObject;
+        int NumItems;
+    };
+    /// write separator and indentation before a value
+    void BeginValue();
+    /// write a quoted, escaped string
+    void PutString(const char* str);
+    /// append bytes to the buffer
+    void Put(const char* data, std::size_t size);
+    /// append a single char to the buffer
+    void Put(char c);
+    /// write buffer content to the file
+    void Flush();
+
+    static const std::size_t BufferSize = 64 * 1024;
+
+    std::string path;
+    std::FILE* fp = nullptr;
+    bool ownsFile = false;
+    bool compact = false;
+    bool afterKey = false;
+    bool writeFailed = false;
+    std::vector<Scope> scopes;
+    std::vector<char> buffer;
+    std::size_t bufferPos = 0;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+JsonWriter::IsOpen() const {
+    return nullptr != this->fp;
+}
+
+//------------------------------------------------------------------------------
+inline void
+JsonWriter::Put(char c) {
+    if (this->bufferPos == BufferSize) {
+        this->Flush();
+    }
+    this->buffer[this->bufferPos++] = c;
+}
+
+} // namespace FBXC
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+//  KeyReducer.cc
+//------------------------------------------------------------------------------
+#include "KeyReducer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+bool
+KeyReducer::Fits(const AnimTrack& track, const std::vector<float>& tangents, int first, int last, float tolerance) {
+    const int size = AnimTrack::ChannelSize(track.Chn);
+    const float* v0 = &track.Samples[first * size];
+    const float* v1 = &track.Samples[last * size];
+    const float len = (float) (last - first);
+    for (int i = first + 1; i < last; i++) {
+        const float u = (float) (i - first) / len;
+        const float* v = &track.Samples[i * size];
+        if (tangents.empty()) {
+            for (int c = 0; c < size; c++) {
+                if (std::fabs(v0[c] + (v1[c] - v0[c]) * u - v[c]) > tolerance) {
+                    return false;
+                }
+            }
+        }
+        else {
+            // tangents are per sample, the segment spans len samples
+            const float* m0 = &tangents[first * size];
+            const float* m1 = &tangents[last * size];
+            const float u2 = u * u;
+            const float u3 = u2 * u;
+            const float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+            const float h10 = (u3 - 2.0f * u2 + u) * len;
+            const float h01 = -2.0f * u3 + 3.0f * u2;
+            const float h11 = (u3 - u2) * len;
+            for (int c = 0; c < size; c++) {
+                if (std::fabs(h00 * v0[c] + h10 * m0[c] + h01 * v1[c] + h11 * m1[c] - v[c]) > tolerance) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+KeyReducer::Reduce(AnimTrack& track, ExportOptions::KeyInterpolation interp, double sampleRate, float tolerance) {
+    const int size = AnimTrack::ChannelSize(track.Chn);
+    const int num = track.NumSamples;
+    track.Keys.clear();
+    track.Values.clear();
+    track.Tangents.clear();
+    if (0 == num) {
+        return;
+    }
+
+    // Hermite tangents in value change per sample
+    std::vector<float> tangents;
+    if (ExportOptions::HermiteKeys == interp) {
+        tangents.resize(num * size, 0.0f);
+        for (int i = 0; (num > 1) && (i < num); i++) {
+            const int prev = std::max(i - 1, 0);
+            const int next = std::min(i + 1, num - 1);
+            const float scale = 1.0f / (float) (next - prev);
+            for (int c = 0; c < size; c++) {
+                tangents[i * size + c] = (track.Samples[next * size + c] - track.Samples[prev * size + c]) * scale;
+            }
+        }
+    }
+
+    bool constant = true;
+    for (int i = 1; constant && (i < num); i++) {
+        for (int c = 0; c < size; c++) {
+            if (std::fabs(track.Samples[i * size + c] - track.Samples[c]) > tolerance) {
+                constant = false;
+                break;
+            }
+        }
+    }
+    track.Keys.push_back(0);
+    if (!constant) {
+        int first = 0;
+        while (first < num - 1) {
+            // the next sample always fits, find a failing end in doubling
+            // steps, then the last fitting end between the two
+            int good = first + 1;
+            int step = 1;
+            while ((good + step < num) && Fits(track, tangents, first, good + step, tolerance)) {
+                good += step;
+                step *= 2;
+            }
+            int bad = std::min(good + step, num);
+            while (bad - good > 1) {
+                const int mid = good + (bad - good) / 2;
+                if (Fits(track, tangents, first, mid, tolerance)) {
+                    good = mid;
+                }
+                else {
+                    bad = mid;
+                }
+            }
+            track.Keys.push_back((std::uint32_t) good);
+            first = good;
+        }
+    }
+
+    for (std::uint32_t key : track.Keys) {
+        track.Values.insert(track.Values.end(), &track.Samples[key * size], &track.Samples[key * size] + size);
+        if (!tangents.empty()) {
+            for (int c = 0; c < size; c++) {
+                track.Tangents.push_back(constant ? 0.0f : (float) (tangents[key * size + c] * sampleRate));
+            }
+        }
+    }
+    track.Samples.clear();
+    track.Samples.shrink_to_fit();
+}
+
+} // namespace FBXC
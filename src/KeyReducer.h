@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::KeyReducer
+    @brief drop animation samples which interpolation can rebuild
+
+    Reduces the samples of an AnimTrack to keys: a sample is dropped if
+    linear or Hermite interpolation between the surrounding keys rebuilds
+    it (and all other dropped samples between them) within a tolerance
+    per component. Hermite tangents are the central differences of the
+    samples. Segments are extended greedily from each key, first in
+    doubling steps, then by binary search, so long constant or linear
+    stretches take O(n log n) instead of O(n^2) checks. A track which
+    stays within the tolerance of its first sample is reduced to that
+    single key.
+*/
+#include "AnimTrack.h"
+#include "ExportOptions.h"
+
+namespace FBXC {
+
+class KeyReducer {
+public:
+    /// reduce track samples to keys, sampleRate scales the Hermite tangents to value change per second
+    static void Reduce(AnimTrack& track, ExportOptions::KeyInterpolation interp, double sampleRate, float tolerance);
+
+private:
+    /// return true if interpolating from sample first to sample last rebuilds the samples in between
+    static bool Fits(const AnimTrack& track, const std::vector<float>& tangents, int first, int last, float tolerance);
+};
+
+} // namespace FBXC
@@ -4,7 +4,9 @@
     @class FBXC::Log
     @brief static logging functions
 */
+#include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <cassert>
 
 namespace FBXC {
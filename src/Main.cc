@@ -3,8 +3,11 @@
 //------------------------------------------------------------------------------
 #include "Main.h"
 #include "Log.h"
+#include "Batch.h"
+#include "SkinExtractor.h"
 #include "cpptoml.h"
 #include <iostream>
+#include <cstdlib>
 
 namespace FBXC {
 
@@ -27,10 +30,45 @@ Main::Run() {
         this->ShowHelp();
     }
     else {
-        this->fbx.Setup();
-        this->fbx.Load(this->fbxPath);
+        if (!this->rulesPath.empty()) {
+            this->rules.Load(this->rulesPath);
+        }
+        if (!this->cacheDir.empty()) {
+            this->exportCache.Setup(this->cacheDir, this->rulesPath, Version);
+            this->meshCache.Setup(this->cacheDir + "/meshes");
+        }
+        const MeshCache* meshCachePtr = this->meshCache.IsValid() ? &this->meshCache : nullptr;
+        if (!this->batchPath.empty()) {
+            std::vector<std::string> fbxPaths;
+            Batch::CollectFiles(this->batchPath, fbxPaths);
+            Batch::Run(fbxPaths, this->outputPath, this->reader, this->numJobs, this->numBatchJobs, this->rules, this->exportOptions,
+                this->exportCache.IsValid() ? &this->exportCache : nullptr, meshCachePtr);
+            return;
+        }
+
+        // on a cache hit the FBX file doesn't need to be loaded at all
+        std::string cacheKey;
+        if (this->exportCache.IsValid() && !this->outputPath.empty() && !this->dumpFbx) {
+            cacheKey = this->exportCache.Key(this->fbxPath, this->reader, this->exportOptions, this->outputPath);
+            if (this->exportCache.Fetch(cacheKey, this->outputPath)) {
+                return;
+            }
+        }
+        this->fbx.Setup(this->reader, this->numJobs);
+        this->fbx.Load(this->fbxPath, this->rules);
         if (this->dumpFbx) {
-            this->fbx.Dump();
+            this->fbx.Dump(this->exportOptions.CompactJson);
+        }
+        if (!this->outputPath.empty()) {
+            this->fbx.Export(this->outputPath, this->exportOptions, meshCachePtr);
+            if (meshCachePtr) {
+                const int numMeshes = (int) this->fbx.Scene().Meshes.size();
+                const int numHits = this->fbx.NumCachedMeshes();
+                Log::Info("mesh cache: %d hits, %d misses\n", numHits, numMeshes - numHits);
+            }
+            if (!cacheKey.empty()) {
+                this->exportCache.Store(cacheKey, this->outputPath);
+            }
         }
         this->fbx.Discard();
     }
@@ -46,13 +84,55 @@ Main::ShowVersion() {
 void
 Main::ShowHelp() {
     Log::Info(
-        "fbxc [--version] [--help] [--fbx path] [--rules path] [--output path]\n"
+        "fbxc [--version] [--help] [--fbx path] [--rules path] [--output path] [--reader sdk|native]\n"
+        "     [--vertex-streams interleaved|planar] [--no-weld] [--weld-epsilon eps]\n"
+        "     [--no-optimize] [--vertex-cache-size n] [--vertex-format component=format]\n"
+        "     [--split-meshes] [--flatten] [--format json|bin] [--compact-json] [--jobs n]\n"
+        "     [--anim] [--anim-rate n] [--anim-keys linear|hermite] [--anim-error e]\n"
+        "     [--anim-bits n] [--skin] [--skin-influences n] [--blendshapes] [--blendshape-epsilon e]\n"
+        "     [--batch manifest|pattern] [--batch-jobs n] [--cache-dir path]\n"
         "source and docs: https://github.com/floooh/fbxc\n\n"
         "--version:         show version information\n"
         "--help:            show this help text\n"
         "--fbx path:        FBX file path (input)\n"
-        "--rules path:      rules file path (input)\n"
-        "--output path:     output file(s) path\n"
+        "--rules path:      rules file path (input), selects the exported nodes and their\n"
+        "                   tangent mode (keep or regenerate), see src/Rules.h\n"
+        "--output path:     output scene file path, vertex data goes to a .bin file next to it\n"
+        "--reader name:     'sdk' (default) or 'native' (binary FBX files only)\n"
+        "--vertex-streams:  'interleaved' (default) or 'planar' vertex components\n"
+        "--no-weld:         don't merge identical vertices and remove degenerate triangles\n"
+        "--weld-epsilon e:  merge vertices whose components differ by less than e (default: 0)\n"
+        "--no-optimize:     don't reorder triangles and vertices for the vertex cache\n"
+        "--vertex-cache-size n: vertex cache size to optimize for (default: 16)\n"
+        "--vertex-format c=f: output format of a vertex component, e.g. 'normal=byte4n', formats:\n"
+        "                   float2..4, byte4n, ubyte4n, short2n, short4n, half2, half4, uint10n2, int10n2,\n"
+        "                   ubyte4, ushort4, ushort4n (joints0/1 default to ubyte4, weights0/1 to ubyte4n,\n"
+        "                   ubyte4 joints become ushort4 for meshes with more than 256 joints)\n"
+        "--split-meshes:    write 16-bit indices, split meshes with more than 65535 vertices\n"
+        "--flatten:         collapse the node hierarchy into the root and the nodes with the 'keep'\n"
+        "                   rule action, each with one mesh grouped by material\n"
+        "--anim:            export node animation, sampled and keyframe-reduced per node and channel\n"
+        "--anim-rate n:     animation sample rate in samples per second (default: 30)\n"
+        "--anim-keys name:  'linear' (default) or 'hermite' key interpolation\n"
+        "--anim-error e:    max deviation of reduced animation tracks from the samples (default: 0.0001)\n"
+        "--anim-bits n:     quantize animation keys to n bits (8..16), rotations as smallest three,\n"
+        "                   constant tracks go into the scene file, identity tracks are dropped\n"
+        "--skin:            export skin joints, inverse bind matrices and per-vertex influences\n"
+        "                   (not for meshes merged by --flatten)\n"
+        "--skin-influences n: max. influences per vertex (1..8, default: 4), the strongest are kept\n"
+        "                   and renormalized\n"
+        "--blendshapes:     export blend shape channels as sparse, quantized position and normal deltas\n"
+        "                   (not for meshes merged by --flatten)\n"
+        "--blendshape-epsilon e: drop blend shape deltas up to e (default: 0.00001)\n"
+        "--format name:     scene file format, 'json' (default) or 'bin' (memory-mappable, see\n"
+        "                   src/fbxc_scene.h), batch mode names the files .json or .scene\n"
+        "--compact-json:    write JSON without line breaks and indentation\n"
+        "--jobs n:          number of worker threads (default: one per hardware thread)\n"
+        "--batch m:         convert all FBX files listed in manifest file m (one path per line),\n"
+        "                   or matching a pattern like 'dir/*.fbx', --output is a directory\n"
+        "--batch-jobs n:    number of files converted concurrently in batch mode (default: 1)\n"
+        "--cache-dir path:  reuse outputs of previous runs with identical FBX file, rules file,\n"
+        "                   fbxc version and options, and processed meshes with identical geometry\n"
         "--fbx-dump:        dump FBX scene structure to stdout\n\n"
     );
 }
@@ -92,6 +172,221 @@ Main::ParseArgs(int argc, const char** argv) {
                 Log::Fatal("expected output file path after '--output'\n");
             }
         }
+        else if (arg == "--reader") {
+            if (++i < argc) {
+                const std::string readerName = argv[i];
+                if (readerName == "sdk") {
+                    this->reader = FBX::SdkReader;
+                }
+                else if (readerName == "native") {
+                    this->reader = FBX::NativeReader;
+                }
+                else {
+                    Log::Fatal("unknown reader '%s', expected 'sdk' or 'native'\n", argv[i]);
+                }
+            }
+            else {
+                Log::Fatal("expected reader name after '--reader'\n");
+            }
+        }
+        else if (arg == "--vertex-streams") {
+            if (++i < argc) {
+                const std::string streamsName = argv[i];
+                if (streamsName == "interleaved") {
+                    this->exportOptions.PlanarVertices = false;
+                }
+                else if (streamsName == "planar") {
+                    this->exportOptions.PlanarVertices = true;
+                }
+                else {
+                    Log::Fatal("unknown vertex streams '%s', expected 'interleaved' or 'planar'\n", argv[i]);
+                }
+            }
+            else {
+                Log::Fatal("expected 'interleaved' or 'planar' after '--vertex-streams'\n");
+            }
+        }
+        else if (arg == "--no-weld") {
+            this->exportOptions.Weld = false;
+        }
+        else if (arg == "--weld-epsilon") {
+            if (++i < argc) {
+                this->exportOptions.WeldEpsilon = (float) std::atof(argv[i]);
+                if (this->exportOptions.WeldEpsilon < 0.0f) {
+                    Log::Fatal("--weld-epsilon must not be negative\n");
+                }
+            }
+            else {
+                Log::Fatal("expected epsilon value after '--weld-epsilon'\n");
+            }
+        }
+        else if (arg == "--no-optimize") {
+            this->exportOptions.OptimizeIndices = false;
+        }
+        else if (arg == "--vertex-cache-size") {
+            if (++i < argc) {
+                this->exportOptions.VertexCacheSize = std::atoi(argv[i]);
+                if (this->exportOptions.VertexCacheSize <= 0) {
+                    Log::Fatal("--vertex-cache-size must be greater than 0\n");
+                }
+            }
+            else {
+                Log::Fatal("expected cache size after '--vertex-cache-size'\n");
+            }
+        }
+        else if (arg == "--vertex-format") {
+            if (++i < argc) {
+                this->ParseVertexFormat(argv[i]);
+            }
+            else {
+                Log::Fatal("expected 'component=format' after '--vertex-format'\n");
+            }
+        }
+        else if (arg == "--split-meshes") {
+            this->exportOptions.SplitMeshes = true;
+        }
+        else if (arg == "--flatten") {
+            this->exportOptions.FlattenHierarchy = true;
+        }
+        else if (arg == "--anim") {
+            this->exportOptions.Animations = true;
+        }
+        else if (arg == "--anim-rate") {
+            if (++i < argc) {
+                this->exportOptions.AnimSampleRate = std::atof(argv[i]);
+                if (this->exportOptions.AnimSampleRate <= 0.0) {
+                    Log::Fatal("--anim-rate must be greater than 0\n");
+                }
+            }
+            else {
+                Log::Fatal("expected sample rate after '--anim-rate'\n");
+            }
+        }
+        else if (arg == "--anim-keys") {
+            if (++i < argc) {
+                const std::string keysName = argv[i];
+                if (keysName == "linear") {
+                    this->exportOptions.AnimKeys = ExportOptions::LinearKeys;
+                }
+                else if (keysName == "hermite") {
+                    this->exportOptions.AnimKeys = ExportOptions::HermiteKeys;
+                }
+                else {
+                    Log::Fatal("unknown key interpolation '%s', expected 'linear' or 'hermite'\n", argv[i]);
+                }
+            }
+            else {
+                Log::Fatal("expected 'linear' or 'hermite' after '--anim-keys'\n");
+            }
+        }
+        else if (arg == "--anim-error") {
+            if (++i < argc) {
+                this->exportOptions.AnimTolerance = (float) std::atof(argv[i]);
+                if (this->exportOptions.AnimTolerance < 0.0f) {
+                    Log::Fatal("--anim-error must not be negative\n");
+                }
+            }
+            else {
+                Log::Fatal("expected error value after '--anim-error'\n");
+            }
+        }
+        else if (arg == "--anim-bits") {
+            if (++i < argc) {
+                this->exportOptions.AnimBits = std::atoi(argv[i]);
+                if ((this->exportOptions.AnimBits < 8) || (this->exportOptions.AnimBits > 16)) {
+                    Log::Fatal("--anim-bits must be between 8 and 16\n");
+                }
+            }
+            else {
+                Log::Fatal("expected number of bits after '--anim-bits'\n");
+            }
+        }
+        else if (arg == "--skin") {
+            this->exportOptions.Skin = true;
+        }
+        else if (arg == "--skin-influences") {
+            if (++i < argc) {
+                this->exportOptions.SkinInfluences = std::atoi(argv[i]);
+                if ((this->exportOptions.SkinInfluences < 1) || (this->exportOptions.SkinInfluences > SkinExtractor::MaxInfluences)) {
+                    Log::Fatal("--skin-influences must be between 1 and %d\n", (int) SkinExtractor::MaxInfluences);
+                }
+            }
+            else {
+                Log::Fatal("expected number of influences after '--skin-influences'\n");
+            }
+        }
+        else if (arg == "--blendshapes") {
+            this->exportOptions.BlendShapes = true;
+        }
+        else if (arg == "--blendshape-epsilon") {
+            if (++i < argc) {
+                this->exportOptions.BlendShapeEpsilon = (float) std::atof(argv[i]);
+                if (this->exportOptions.BlendShapeEpsilon < 0.0f) {
+                    Log::Fatal("--blendshape-epsilon must not be negative\n");
+                }
+            }
+            else {
+                Log::Fatal("expected epsilon after '--blendshape-epsilon'\n");
+            }
+        }
+        else if (arg == "--format") {
+            if (++i < argc) {
+                const std::string formatName = argv[i];
+                if (formatName == "json") {
+                    this->exportOptions.Format = ExportOptions::JsonFormat;
+                }
+                else if (formatName == "bin") {
+                    this->exportOptions.Format = ExportOptions::BinaryFormat;
+                }
+                else {
+                    Log::Fatal("unknown format '%s', expected 'json' or 'bin'\n", argv[i]);
+                }
+            }
+            else {
+                Log::Fatal("expected 'json' or 'bin' after '--format'\n");
+            }
+        }
+        else if (arg == "--compact-json") {
+            this->exportOptions.CompactJson = true;
+        }
+        else if (arg == "--jobs") {
+            if (++i < argc) {
+                this->numJobs = std::atoi(argv[i]);
+                if (this->numJobs <= 0) {
+                    Log::Fatal("--jobs must be greater than 0\n");
+                }
+            }
+            else {
+                Log::Fatal("expected number of jobs after '--jobs'\n");
+            }
+        }
+        else if (arg == "--batch") {
+            if (++i < argc) {
+                this->batchPath = argv[i];
+            }
+            else {
+                Log::Fatal("expected manifest path or file pattern after '--batch'\n");
+            }
+        }
+        else if (arg == "--batch-jobs") {
+            if (++i < argc) {
+                this->numBatchJobs = std::atoi(argv[i]);
+                if (this->numBatchJobs <= 0) {
+                    Log::Fatal("--batch-jobs must be greater than 0\n");
+                }
+            }
+            else {
+                Log::Fatal("expected number of files after '--batch-jobs'\n");
+            }
+        }
+        else if (arg == "--cache-dir") {
+            if (++i < argc) {
+                this->cacheDir = argv[i];
+            }
+            else {
+                Log::Fatal("expected cache directory after '--cache-dir'\n");
+            }
+        }
         else if (arg == "--fbx-dump") {
             this->dumpFbx = true;
         }
@@ -101,12 +396,52 @@ Main::ParseArgs(int argc, const char** argv) {
     }
 }
 
+//------------------------------------------------------------------------------
+void
+Main::ParseVertexFormat(const std::string& arg) {
+    const std::string::size_type sep = arg.find('=');
+    if (sep == std::string::npos) {
+        Log::Fatal("invalid vertex format '%s', expected 'component=format'\n", arg.c_str());
+    }
+    const std::string compName = arg.substr(0, sep);
+    const std::string fmtName = arg.substr(sep + 1);
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        const MeshData::Component comp = (MeshData::Component) i;
+        if (compName == MeshData::ComponentName(comp)) {
+            const VertexFormat::Code fmt = VertexFormat::FromString(fmtName);
+            if (VertexFormat::Invalid == fmt) {
+                Log::Fatal("unknown vertex format '%s'\n", fmtName.c_str());
+            }
+            if (VertexFormat::NumComponents(fmt) < MeshData::ComponentSize(comp)) {
+                Log::Fatal("vertex format '%s' has too few components for '%s'\n", fmtName.c_str(), compName.c_str());
+            }
+            this->exportOptions.VertexFormats[comp] = fmt;
+            return;
+        }
+    }
+    Log::Fatal("unknown vertex component '%s'\n", compName.c_str());
+}
+
 //------------------------------------------------------------------------------
 void
 Main::ValidateArgs() {
-    if (!(this->showHelp || this->showVersion)) {
+    if (!(this->showHelp || this->showVersion) && !this->batchPath.empty()) {
+        if (!this->fbxPath.empty()) {
+            Log::Fatal("--fbx and --batch are mutually exclusive\n");
+        }
+        else if (this->dumpFbx) {
+            Log::Fatal("--fbx-dump is not supported in batch mode\n");
+        }
+        else if (this->rulesPath.empty()) {
+            Log::Fatal("--rules arg missing\n");
+        }
+        else if (this->outputPath.empty()) {
+            Log::Fatal("--output directory missing\n");
+        }
+    }
+    else if (!(this->showHelp || this->showVersion)) {
         if (this->fbxPath.empty()) {
-            Log::Fatal("--fbx arg required\n");
+            Log::Fatal("--fbx or --batch arg required\n");
         }
         else if (!this->dumpFbx && this->rulesPath.empty()) {
             Log::Fatal("--rules arg missing\n");
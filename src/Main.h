@@ -6,6 +6,7 @@
 */
 #include <string>
 #include "FBX.h"
+#include "ExportCache.h"
 
 namespace FBXC {
 class Main {
@@ -18,6 +19,8 @@ public:
 private:
     /// parse cmd line args
     void ParseArgs(int argc, const char** argv);
+    /// parse a 'component=format' vertex format arg
+    void ParseVertexFormat(const std::string& arg);
     /// check args, set error message on error
     void ValidateArgs();
     /// show version
@@ -28,9 +31,18 @@ private:
     bool showHelp = false;
     bool showVersion = false;
     bool dumpFbx = false;
+    FBX::Reader reader = FBX::SdkReader;
+    ExportOptions exportOptions;
+    int numJobs = 0;
+    int numBatchJobs = 1;
+    std::string batchPath;
+    std::string cacheDir;
     std::string fbxPath;
     std::string rulesPath;
     std::string outputPath;
+    Rules rules;
     FBX fbx;
+    ExportCache exportCache;
+    MeshCache meshCache;
 };
 } // namespace FBXC
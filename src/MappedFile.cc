@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+//  MappedFile.cc
+//------------------------------------------------------------------------------
+#include "MappedFile.h"
+#include <cassert>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+MappedFile::MappedFile() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+MappedFile::~MappedFile() {
+    if (this->IsOpen()) {
+        this->Close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+MappedFile::Open(const std::string& path) {
+    assert(!this->IsOpen());
+    #if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (INVALID_HANDLE_VALUE == file) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || (0 == fileSize.QuadPart)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (NULL == mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (nullptr == ptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    this->fileHandle = file;
+    this->mappingHandle = mapping;
+    this->data = (const std::uint8_t*) ptr;
+    this->size = (std::size_t) fileSize.QuadPart;
+    #else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (0 == st.st_size)) {
+        close(fd);
+        return false;
+    }
+    void* ptr = mmap(nullptr, (std::size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the file descriptor is closed
+    close(fd);
+    if (MAP_FAILED == ptr) {
+        return false;
+    }
+    this->data = (const std::uint8_t*) ptr;
+    this->size = (std::size_t) st.st_size;
+    #endif
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+MappedFile::Close() {
+    assert(this->IsOpen());
+    #if defined(_WIN32)
+    UnmapViewOfFile(this->data);
+    CloseHandle((HANDLE) this->mappingHandle);
+    CloseHandle((HANDLE) this->fileHandle);
+    this->mappingHandle = nullptr;
+    this->fileHandle = nullptr;
+    #else
+    munmap((void*) this->data, this->size);
+    #endif
+    this->data = nullptr;
+    this->size = 0;
+}
+
+} // namespace FBXC
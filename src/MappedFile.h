@@ -0,0 +1,61 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MappedFile
+    @brief read-only memory-mapped file
+*/
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace FBXC {
+
+class MappedFile {
+public:
+    /// constructor
+    MappedFile();
+    /// destructor
+    ~MappedFile();
+
+    /// map a file into memory, return false on failure
+    bool Open(const std::string& path);
+    /// unmap the file
+    void Close();
+    /// return true if a file is currently mapped
+    bool IsOpen() const;
+    /// pointer to the start of the mapped data
+    const std::uint8_t* Data() const;
+    /// size of the mapped data in bytes
+    std::size_t Size() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    #if defined(_WIN32)
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+    #endif
+};
+
+//------------------------------------------------------------------------------
+inline bool
+MappedFile::IsOpen() const {
+    return nullptr != this->data;
+}
+
+//------------------------------------------------------------------------------
+inline const std::uint8_t*
+MappedFile::Data() const {
+    return this->data;
+}
+
+//------------------------------------------------------------------------------
+inline std::size_t
+MappedFile::Size() const {
+    return this->size;
+}
+
+} // namespace FBXC
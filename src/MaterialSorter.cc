@@ -0,0 +1,61 @@
+//------------------------------------------------------------------------------
+//  MaterialSorter.cc
+//------------------------------------------------------------------------------
+#include "MaterialSorter.h"
+#include <algorithm>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+MaterialSorter::Sort(MeshData& data) {
+    data.Groups.clear();
+    const int numTris = data.NumTriangles();
+    if (0 == numTris) {
+        return;
+    }
+    const auto minMax = std::minmax_element(data.TriangleMaterials.begin(), data.TriangleMaterials.end());
+    const std::int32_t minMat = *minMax.first;
+    const std::int32_t maxMat = *minMax.second;
+    if (minMat == maxMat) {
+        MeshData::Group group;
+        group.Material = minMat;
+        group.NumIndices = numTris * 3;
+        data.Groups.push_back(group);
+        return;
+    }
+
+    // count triangles per material, then scatter into buckets
+    const int numBuckets = maxMat - minMat + 1;
+    std::vector<int> bucketStart(numBuckets + 1, 0);
+    for (std::int32_t mat : data.TriangleMaterials) {
+        bucketStart[mat - minMat + 1]++;
+    }
+    for (int i = 0; i < numBuckets; i++) {
+        bucketStart[i + 1] += bucketStart[i];
+    }
+    for (int i = 0; i < numBuckets; i++) {
+        const int numBucketTris = bucketStart[i + 1] - bucketStart[i];
+        if (numBucketTris > 0) {
+            MeshData::Group group;
+            group.Material = minMat + i;
+            group.FirstIndex = bucketStart[i] * 3;
+            group.NumIndices = numBucketTris * 3;
+            data.Groups.push_back(group);
+        }
+    }
+    std::vector<std::uint32_t> indices(numTris * 3);
+    std::vector<std::int32_t> materials(numTris);
+    for (int t = 0; t < numTris; t++) {
+        const std::int32_t mat = data.TriangleMaterials[t];
+        const int dst = bucketStart[mat - minMat]++;
+        indices[dst * 3 + 0] = data.Indices[t * 3 + 0];
+        indices[dst * 3 + 1] = data.Indices[t * 3 + 1];
+        indices[dst * 3 + 2] = data.Indices[t * 3 + 2];
+        materials[dst] = mat;
+    }
+    data.Indices.swap(indices);
+    data.TriangleMaterials.swap(materials);
+}
+
+} // namespace FBXC
@@ -0,0 +1,22 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MaterialSorter
+    @brief sort triangles into material groups
+
+    A single stable counting sort over the per-triangle material indices,
+    so the triangle order within a material (e.g. from the vertex cache
+    optimization) is preserved. Fills MeshData::Groups with one index
+    range per material which is used by at least one triangle.
+*/
+#include "MeshData.h"
+
+namespace FBXC {
+
+class MaterialSorter {
+public:
+    /// sort triangles by material and build material groups
+    static void Sort(MeshData& data);
+};
+
+} // namespace FBXC
@@ -0,0 +1,171 @@
+//------------------------------------------------------------------------------
+//  Matrix44.cc
+//------------------------------------------------------------------------------
+#include "Matrix44.h"
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+Matrix44
+Matrix44::Translation(double x, double y, double z) {
+    Matrix44 m;
+    m.M[12] = x;
+    m.M[13] = y;
+    m.M[14] = z;
+    return m;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+Matrix44::Scaling(double x, double y, double z) {
+    Matrix44 m;
+    m.M[0] = x;
+    m.M[5] = y;
+    m.M[10] = z;
+    return m;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+Matrix44::Rotation(double x, double y, double z, RotationOrder order) {
+    const double degToRad = 3.14159265358979323846 / 180.0;
+    const double cx = std::cos(x * degToRad), sx = std::sin(x * degToRad);
+    const double cy = std::cos(y * degToRad), sy = std::sin(y * degToRad);
+    const double cz = std::cos(z * degToRad), sz = std::sin(z * degToRad);
+    Matrix44 rx, ry, rz;
+    rx.Set(1, 1, cx); rx.Set(1, 2, -sx); rx.Set(2, 1, sx); rx.Set(2, 2, cx);
+    ry.Set(0, 0, cy); ry.Set(0, 2, sy); ry.Set(2, 0, -sy); ry.Set(2, 2, cy);
+    rz.Set(0, 0, cz); rz.Set(0, 1, -sz); rz.Set(1, 0, sz); rz.Set(1, 1, cz);
+    switch (order) {
+        case EulerXZY:  return ry * rz * rx;
+        case EulerYZX:  return rx * rz * ry;
+        case EulerYXZ:  return rz * rx * ry;
+        case EulerZXY:  return ry * rx * rz;
+        case EulerZYX:  return rx * ry * rz;
+        default:        return rz * ry * rx;
+    }
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+Matrix44::operator*(const Matrix44& rhs) const {
+    Matrix44 res;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            double sum = 0.0;
+            for (int i = 0; i < 4; i++) {
+                sum += this->Get(row, i) * rhs.Get(i, col);
+            }
+            res.Set(row, col, sum);
+        }
+    }
+    return res;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+Matrix44::Inverse() const {
+    // cofactor expansion, the result is the transposed cofactor matrix / determinant
+    const double* m = this->M;
+    double inv[16];
+    inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15] + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+    inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15] - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+    inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15] + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+    inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14] - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+    inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15] - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+    inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15] + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+    inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15] - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+    inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14] + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+    inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15] + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+    inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15] - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+    inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15] + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+    inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14] - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+    inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11] - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+    inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11] + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+    inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11] - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+    inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10] + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+    const double det = m[0]*inv[0] + m[1]*inv[4] + m[2]*inv[8] + m[3]*inv[12];
+    if (0.0 == det) {
+        return Matrix44();
+    }
+    Matrix44 res;
+    for (int i = 0; i < 16; i++) {
+        res.M[i] = inv[i] / det;
+    }
+    return res;
+}
+
+//------------------------------------------------------------------------------
+double
+Matrix44::Determinant3x3() const {
+    const double* m = this->M;
+    return m[0] * (m[5] * m[10] - m[9] * m[6])
+         - m[4] * (m[1] * m[10] - m[9] * m[2])
+         + m[8] * (m[1] * m[6] - m[5] * m[2]);
+}
+
+//------------------------------------------------------------------------------
+bool
+Matrix44::IsIdentity() const {
+    return 0 == std::memcmp(this->M, Matrix44().M, sizeof(this->M));
+}
+
+//------------------------------------------------------------------------------
+void
+Matrix44::Decompose(double* outTranslation, double* outRotation, double* outScaling) const {
+    for (int i = 0; i < 3; i++) {
+        outTranslation[i] = this->M[12 + i];
+    }
+
+    // scaling is the length of the basis vectors, a mirroring
+    // transform gets a negative x scale so that the rest is a rotation
+    double r[3][3];
+    for (int col = 0; col < 3; col++) {
+        const double* v = this->M + col * 4;
+        outScaling[col] = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    }
+    if (this->Determinant3x3() < 0.0) {
+        outScaling[0] = -outScaling[0];
+    }
+    for (int col = 0; col < 3; col++) {
+        const double s = (0.0 != outScaling[col]) ? 1.0 / outScaling[col] : 0.0;
+        for (int row = 0; row < 3; row++) {
+            r[row][col] = this->Get(row, col) * s;
+        }
+    }
+
+    // rotation matrix to quaternion, branching on the largest diagonal term for precision
+    const double trace = r[0][0] + r[1][1] + r[2][2];
+    double* q = outRotation;
+    if (trace > 0.0) {
+        const double s = 0.5 / std::sqrt(trace + 1.0);
+        q[0] = (r[2][1] - r[1][2]) * s;
+        q[1] = (r[0][2] - r[2][0]) * s;
+        q[2] = (r[1][0] - r[0][1]) * s;
+        q[3] = 0.25 / s;
+    }
+    else if ((r[0][0] > r[1][1]) && (r[0][0] > r[2][2])) {
+        const double s = 2.0 * std::sqrt(1.0 + r[0][0] - r[1][1] - r[2][2]);
+        q[0] = 0.25 * s;
+        q[1] = (r[0][1] + r[1][0]) / s;
+        q[2] = (r[0][2] + r[2][0]) / s;
+        q[3] = (r[2][1] - r[1][2]) / s;
+    }
+    else if (r[1][1] > r[2][2]) {
+        const double s = 2.0 * std::sqrt(1.0 + r[1][1] - r[0][0] - r[2][2]);
+        q[0] = (r[0][1] + r[1][0]) / s;
+        q[1] = 0.25 * s;
+        q[2] = (r[1][2] + r[2][1]) / s;
+        q[3] = (r[0][2] - r[2][0]) / s;
+    }
+    else {
+        const double s = 2.0 * std::sqrt(1.0 + r[2][2] - r[0][0] - r[1][1]);
+        q[0] = (r[0][2] + r[2][0]) / s;
+        q[1] = (r[1][2] + r[2][1]) / s;
+        q[2] = 0.25 * s;
+        q[3] = (r[1][0] - r[0][1]) / s;
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,83 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::Matrix44
+    @brief 4x4 double precision transform matrix
+
+    Column vector convention (p' = M * p), stored column-major, so the
+    translation is in M[12..14]. This is the same memory layout as
+    FbxAMatrix.
+*/
+#include <cstring>
+
+namespace FBXC {
+
+class Matrix44 {
+public:
+    /// euler rotation orders, same values as FBX's EFbxRotationOrder
+    enum RotationOrder {
+        EulerXYZ = 0,
+        EulerXZY,
+        EulerYZX,
+        EulerYXZ,
+        EulerZXY,
+        EulerZYX,
+    };
+
+    /// constructor, sets identity
+    Matrix44();
+    /// construct from 16 column-major values
+    explicit Matrix44(const double* values);
+
+    /// translation matrix
+    static Matrix44 Translation(double x, double y, double z);
+    /// scaling matrix
+    static Matrix44 Scaling(double x, double y, double z);
+    /// rotation matrix from euler angles in degrees, XYZ means X is applied first
+    static Matrix44 Rotation(double x, double y, double z, RotationOrder order);
+
+    /// matrix product (rhs is applied first)
+    Matrix44 operator*(const Matrix44& rhs) const;
+    /// general inverse, identity if the matrix is singular
+    Matrix44 Inverse() const;
+    /// determinant of the upper 3x3 part
+    double Determinant3x3() const;
+    /// return true if this is the identity matrix
+    bool IsIdentity() const;
+    /// decompose into translation, rotation quaternion (xyzw) and scaling, shear is lost
+    void Decompose(double* outTranslation, double* outRotation, double* outScaling) const;
+
+    /// get element by row and column
+    double Get(int row, int col) const;
+    /// set element by row and column
+    void Set(int row, int col, double val);
+
+    double M[16];
+};
+
+//------------------------------------------------------------------------------
+inline
+Matrix44::Matrix44() {
+    static const double identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    std::memcpy(this->M, identity, sizeof(this->M));
+}
+
+//------------------------------------------------------------------------------
+inline
+Matrix44::Matrix44(const double* values) {
+    std::memcpy(this->M, values, sizeof(this->M));
+}
+
+//------------------------------------------------------------------------------
+inline double
+Matrix44::Get(int row, int col) const {
+    return this->M[col * 4 + row];
+}
+
+//------------------------------------------------------------------------------
+inline void
+Matrix44::Set(int row, int col, double val) {
+    this->M[col * 4 + row] = val;
+}
+
+} // namespace FBXC
@@ -0,0 +1,428 @@
+//------------------------------------------------------------------------------
+//  MeshCache.cc
+//------------------------------------------------------------------------------
+#include "MeshCache.h"
+#include "Hasher.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FBXC {
+
+/// entry file header, bump the version when the entry layout or the processing stages change
+static const char entryMagic[8] = { 'F', 'B', 'X', 'C', 'M', 'E', 'S', 'H' };
+static const std::uint32_t entryVersion = 4;
+
+namespace {
+
+//------------------------------------------------------------------------------
+class EntryWriter {
+public:
+    template<class T> void Pod(const T& val) {
+        this->Bytes(&val, sizeof(val));
+    }
+    void Bytes(const void* data, std::size_t size) {
+        const std::uint8_t* ptr = (const std::uint8_t*) data;
+        this->buf.insert(this->buf.end(), ptr, ptr + size);
+    }
+    template<class T> void Array(const std::vector<T>& vec) {
+        this->Pod((std::uint64_t) vec.size());
+        this->Bytes(vec.data(), vec.size() * sizeof(T));
+    }
+    void String(const std::string& str) {
+        this->Pod((std::uint64_t) str.size());
+        this->Bytes(str.data(), str.size());
+    }
+    std::vector<std::uint8_t> buf;
+};
+
+//------------------------------------------------------------------------------
+class EntryReader {
+public:
+    EntryReader(const std::vector<std::uint8_t>& buf_) : buf(buf_) { };
+    template<class T> void Pod(T& val) {
+        this->Bytes(&val, sizeof(val));
+    }
+    void Bytes(void* data, std::size_t size) {
+        if (!this->ok || (size > (this->buf.size() - this->pos))) {
+            this->ok = false;
+            return;
+        }
+        if (0 == size) {
+            return;
+        }
+        std::memcpy(data, this->buf.data() + this->pos, size);
+        this->pos += size;
+    }
+    template<class T> void Array(std::vector<T>& vec) {
+        std::uint64_t num = 0;
+        this->Pod(num);
+        if (!this->ok || (num > (this->buf.size() - this->pos) / sizeof(T))) {
+            this->ok = false;
+            return;
+        }
+        vec.resize((std::size_t) num);
+        this->Bytes(vec.data(), vec.size() * sizeof(T));
+    }
+    void String(std::string& str) {
+        std::vector<char> chars;
+        this->Array(chars);
+        str.assign(chars.begin(), chars.end());
+    }
+    const std::vector<std::uint8_t>& buf;
+    std::size_t pos = 0;
+    bool ok = true;
+};
+
+//------------------------------------------------------------------------------
+void
+writeValue(EntryWriter& w, const Value& val) {
+    w.Pod((std::int32_t) val.GetType());
+    switch (val.GetType()) {
+        case Value::Bool:   w.Pod(val.Get<bool>()); break;
+        case Value::Id:     w.Pod(val.Get<std::uint64_t>()); break;
+        case Value::Int:    w.Pod(val.Get<std::int32_t>()); break;
+        case Value::Float:  w.Pod(val.Get<double>()); break;
+        case Value::Float2: w.Pod(val.Get<FbxDouble2>().mData); break;
+        case Value::Float3: w.Pod(val.Get<FbxDouble3>().mData); break;
+        case Value::Float4: w.Pod(val.Get<FbxDouble4>().mData); break;
+        case Value::String: w.String(val.GetString()); break;
+        case Value::Array:
+            w.Pod((std::uint64_t) val.GetArray().size());
+            for (const Value& elm : val.GetArray()) {
+                writeValue(w, elm);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+readValue(EntryReader& r, Value& val) {
+    std::int32_t type = 0;
+    r.Pod(type);
+    switch (type) {
+        case Value::Void:
+            val = Value();
+            break;
+        case Value::Bool: {
+            bool b = false;
+            r.Pod(b);
+            val.Set(b);
+            break;
+        }
+        case Value::Id: {
+            std::uint64_t id = 0;
+            r.Pod(id);
+            val.Set(id);
+            break;
+        }
+        case Value::Int: {
+            std::int32_t i = 0;
+            r.Pod(i);
+            val.Set(i);
+            break;
+        }
+        case Value::Float: {
+            double d = 0.0;
+            r.Pod(d);
+            val.Set(d);
+            break;
+        }
+        case Value::Float2: {
+            FbxDouble2 d;
+            r.Pod(d.mData);
+            val.Set(d);
+            break;
+        }
+        case Value::Float3: {
+            FbxDouble3 d;
+            r.Pod(d.mData);
+            val.Set(d);
+            break;
+        }
+        case Value::Float4: {
+            FbxDouble4 d;
+            r.Pod(d.mData);
+            val.Set(d);
+            break;
+        }
+        case Value::String: {
+            std::string str;
+            r.String(str);
+            val.Set(str);
+            break;
+        }
+        case Value::Array: {
+            std::uint64_t num = 0;
+            r.Pod(num);
+            // each element takes at least 4 bytes
+            if (!r.ok || (num > (r.buf.size() - r.pos) / 4)) {
+                r.ok = false;
+                break;
+            }
+            std::vector<Value> elms((std::size_t) num);
+            for (Value& elm : elms) {
+                readValue(r, elm);
+            }
+            val.Set(std::move(elms));
+            break;
+        }
+        default:
+            r.ok = false;
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+writeMeshData(EntryWriter& w, const MeshData& data) {
+    w.Pod((std::int32_t) data.NumVertices);
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        w.Array(data.Streams[i]);
+    }
+    w.Array(data.Indices);
+    w.Array(data.TriangleMaterials);
+    w.Array(data.PointIndices);
+    w.Array(data.Groups);
+    w.Pod((std::int32_t) data.Shapes.size());
+    for (const MeshData::Shape& shape : data.Shapes) {
+        w.Array(shape.Vertices);
+        w.Array(shape.Positions);
+        w.Array(shape.Normals);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+readMeshData(EntryReader& r, MeshData& data) {
+    std::int32_t numVerts = 0;
+    r.Pod(numVerts);
+    data.NumVertices = numVerts;
+    if (numVerts < 0) {
+        r.ok = false;
+    }
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        r.Array(data.Streams[i]);
+        const std::size_t size = MeshData::ComponentSize((MeshData::Component) i);
+        if (!data.Streams[i].empty() && (data.Streams[i].size() != numVerts * size)) {
+            r.ok = false;
+        }
+    }
+    r.Array(data.Indices);
+    r.Array(data.TriangleMaterials);
+    r.Array(data.PointIndices);
+    r.Array(data.Groups);
+    std::int32_t numShapes = 0;
+    r.Pod(numShapes);
+    if ((numShapes < 0) || (numShapes > (1 << 20))) {
+        r.ok = false;
+        numShapes = 0;
+    }
+    data.Shapes.resize(numShapes);
+    for (MeshData::Shape& shape : data.Shapes) {
+        r.Array(shape.Vertices);
+        r.Array(shape.Positions);
+        r.Array(shape.Normals);
+        if ((shape.Positions.size() != shape.Vertices.size() * 3) ||
+            (!shape.Normals.empty() && (shape.Normals.size() != shape.Vertices.size() * 3))) {
+            r.ok = false;
+        }
+        for (std::uint32_t vertex : shape.Vertices) {
+            if (vertex >= (std::uint32_t) numVerts) {
+                r.ok = false;
+                break;
+            }
+        }
+    }
+    for (std::uint32_t index : data.Indices) {
+        if (index >= (std::uint32_t) numVerts) {
+            r.ok = false;
+            break;
+        }
+    }
+}
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+void
+MeshCache::Setup(const std::string& dir_) {
+    assert(!this->isValid);
+    this->dir = dir_;
+    if (!this->dir.empty() && (this->dir.back() != '/') && (this->dir.back() != '\\')) {
+        this->dir.push_back('/');
+    }
+    // only the last directory level is created, the parent is the export cache directory
+    #if defined(_WIN32)
+    _mkdir(dir_.c_str());
+    #else
+    mkdir(dir_.c_str(), 0755);
+    #endif
+    this->isValid = true;
+}
+
+//------------------------------------------------------------------------------
+std::string
+MeshCache::Key(const MeshSource& src, const ExportOptions& options, bool generateTangents) const {
+    assert(this->isValid);
+    Hasher hasher;
+    hasher.AddValue(entryVersion);
+    hasher.AddValue(options.Weld);
+    hasher.AddValue(options.WeldEpsilon);
+    hasher.AddValue(options.OptimizeIndices);
+    hasher.AddValue(options.VertexCacheSize);
+    hasher.AddValue(options.SplitMeshes);
+    hasher.AddValue(options.Skin);
+    hasher.AddValue((std::int32_t) options.SkinInfluences);
+    hasher.AddValue(options.BlendShapes);
+    hasher.AddValue(options.BlendShapeEpsilon);
+    hasher.AddValue(generateTangents);
+    src.Fingerprint(hasher);
+    return hasher.HexDigest();
+}
+
+//------------------------------------------------------------------------------
+std::string
+MeshCache::Key(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options) const {
+    assert(this->isValid);
+    Hasher hasher;
+    hasher.AddValue(entryVersion);
+    hasher.Add(std::string("merged"));
+    hasher.AddValue(options.Weld);
+    hasher.AddValue(options.WeldEpsilon);
+    hasher.AddValue(options.OptimizeIndices);
+    hasher.AddValue(options.VertexCacheSize);
+    hasher.AddValue(options.SplitMeshes);
+    hasher.AddValue((std::uint64_t) parts.size());
+    for (const MeshMerger::Part& part : parts) {
+        sources[part.Source]->Fingerprint(hasher);
+        hasher.AddValue(part.Transform.M);
+        hasher.AddValue((std::uint64_t) part.MaterialMap.size());
+        hasher.Add(part.MaterialMap.data(), part.MaterialMap.size() * sizeof(std::int32_t));
+        hasher.AddValue(part.GenerateTangents);
+    }
+    return hasher.HexDigest();
+}
+
+//------------------------------------------------------------------------------
+bool
+MeshCache::Load(const std::string& key, ProxyMesh& mesh, PropertyMap& stats) const {
+    assert(this->isValid);
+    std::FILE* fp = std::fopen((this->dir + key + ".mesh").c_str(), "rb");
+    if (nullptr == fp) {
+        return false;
+    }
+    std::vector<std::uint8_t> buf;
+    std::uint8_t chunk[1 << 16];
+    std::size_t num;
+    while ((num = std::fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        buf.insert(buf.end(), chunk, chunk + num);
+    }
+    std::fclose(fp);
+
+    EntryReader r(buf);
+    char magic[8] = { };
+    std::uint32_t version = 0;
+    r.Bytes(magic, sizeof(magic));
+    r.Pod(version);
+    if (!r.ok || (0 != std::memcmp(magic, entryMagic, sizeof(magic))) || (version != entryVersion)) {
+        return false;
+    }
+    PropertyMap loadedStats;
+    std::uint64_t numStats = 0;
+    r.Pod(numStats);
+    for (std::uint64_t i = 0; r.ok && (i < numStats); i++) {
+        std::string statKey;
+        Value val;
+        r.String(statKey);
+        readValue(r, val);
+        if (r.ok && !loadedStats.Contains(statKey)) {
+            loadedStats.Add(statKey.c_str(), std::move(val));
+        }
+    }
+    MeshData data;
+    readMeshData(r, data);
+    std::uint64_t numPieces = 0;
+    r.Pod(numPieces);
+    std::vector<MeshData> pieces;
+    for (std::uint64_t i = 0; r.ok && (i < numPieces); i++) {
+        pieces.emplace_back();
+        readMeshData(r, pieces.back());
+    }
+    if (!r.ok || (r.pos != buf.size())) {
+        Log::Warn("ignoring corrupt mesh cache entry '%s'\n", key.c_str());
+        return false;
+    }
+
+    mesh.Data = std::move(data);
+    mesh.Pieces.clear();
+    for (MeshData& pieceData : pieces) {
+        mesh.Pieces.emplace_back();
+        mesh.Pieces.back().Data = std::move(pieceData);
+    }
+    stats = std::move(loadedStats);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshCache::Save(const std::string& key, const ProxyMesh& mesh, const PropertyMap& stats) const {
+    assert(this->isValid);
+    EntryWriter w;
+    w.Bytes(entryMagic, sizeof(entryMagic));
+    w.Pod(entryVersion);
+    w.Pod((std::uint64_t) stats.Size());
+    for (const PropertyMap::Entry& entry : stats) {
+        w.String(entry.Key);
+        writeValue(w, entry.Val);
+    }
+    writeMeshData(w, mesh.Data);
+    w.Pod((std::uint64_t) mesh.Pieces.size());
+    for (const ProxyMesh& piece : mesh.Pieces) {
+        writeMeshData(w, piece.Data);
+    }
+
+    // write under a temporary name and rename, so that other threads
+    // and processes never see a partially written entry
+    const std::string path = this->dir + key + ".mesh";
+    #if defined(_WIN32)
+    const int pid = _getpid();
+    #else
+    const int pid = getpid();
+    #endif
+    const std::size_t tid = std::hash<std::thread::id>()(std::this_thread::get_id());
+    const std::string tmpPath = path + ".tmp" + std::to_string(pid) + "_" + std::to_string(tid);
+    std::FILE* fp = std::fopen(tmpPath.c_str(), "wb");
+    if (nullptr == fp) {
+        Log::Warn("failed to write mesh cache entry '%s'\n", tmpPath.c_str());
+        return;
+    }
+    bool ok = std::fwrite(w.buf.data(), 1, w.buf.size(), fp) == w.buf.size();
+    ok = (0 == std::fclose(fp)) && ok;
+    #if defined(_WIN32)
+    ok = ok && MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+    #else
+    ok = ok && (0 == std::rename(tmpPath.c_str(), path.c_str()));
+    #endif
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        Log::Warn("failed to write mesh cache entry '%s'\n", path.c_str());
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshCache
+    @brief on-disk cache of processed meshes, keyed by geometry fingerprint
+
+    The key is a hash of the raw mesh source arrays (control points,
+    polygon vertices and layer elements) and the options which affect
+    mesh processing, for merged meshes of the source arrays, transforms
+    and material mappings of all parts. An entry holds the welded, optimized, material-sorted
+    and split MeshData and the properties added by MeshPipeline::Process(),
+    so that a hit only needs to pack the vertices and write them to the blob.
+
+    Load() and Save() may be called from several threads.
+*/
+#include <string>
+#include "MeshSource.h"
+#include "ProxyMesh.h"
+#include "ExportOptions.h"
+#include "MeshMerger.h"
+
+namespace FBXC {
+
+class MeshCache {
+public:
+    /// setup with cache directory (created if missing, the parent directory must exist)
+    void Setup(const std::string& dir);
+    /// return true if the cache has been setup
+    bool IsValid() const;
+
+    /// compute the cache key of a mesh
+    std::string Key(const MeshSource& src, const ExportOptions& options, bool generateTangents) const;
+    /// compute the cache key of a mesh merged from source mesh instances
+    std::string Key(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options) const;
+    /// load a cached mesh into mesh data, pieces and stats, return false on miss
+    bool Load(const std::string& key, ProxyMesh& mesh, PropertyMap& stats) const;
+    /// save a processed mesh and the properties added while processing it
+    void Save(const std::string& key, const ProxyMesh& mesh, const PropertyMap& stats) const;
+
+private:
+    bool isValid = false;
+    std::string dir;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+MeshCache::IsValid() const {
+    return this->isValid;
+}
+
+} // namespace FBXC
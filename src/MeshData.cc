@@ -0,0 +1,44 @@
+//------------------------------------------------------------------------------
+//  MeshData.cc
+//------------------------------------------------------------------------------
+#include "MeshData.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+const char*
+MeshData::ComponentName(Component comp) {
+    static const char* names[NumComponents] = {
+        "position",
+        "normal",
+        "tangent",
+        "binormal",
+        "color",
+        "texcoord0",
+        "texcoord1",
+        "texcoord2",
+        "texcoord3",
+        "joints0",
+        "weights0",
+        "joints1",
+        "weights1"
+    };
+    return names[comp];
+}
+
+//------------------------------------------------------------------------------
+void
+MeshData::Clear() {
+    this->NumVertices = 0;
+    for (auto& stream : this->Streams) {
+        stream.clear();
+    }
+    this->Indices.clear();
+    this->TriangleMaterials.clear();
+    this->PointIndices.clear();
+    this->Groups.clear();
+    this->WeldKeys.clear();
+    this->Shapes.clear();
+}
+
+} // namespace FBXC
@@ -0,0 +1,112 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshData
+    @brief extracted vertex and index data of a mesh
+
+    Vertex components are stored as planar float streams, one
+    std::vector per component (empty if the component doesn't exist).
+    Indices always describe a triangle list.
+*/
+#include <cstdint>
+#include <vector>
+
+namespace FBXC {
+
+class MeshData {
+public:
+    /// vertex components
+    enum Component {
+        Position = 0,
+        Normal,
+        Tangent,        // xyz + handedness in w
+        Binormal,
+        Color,
+        TexCoord0,
+        TexCoord1,
+        TexCoord2,
+        TexCoord3,
+        Joints0,        // skin joint indices (as floats)
+        Weights0,       // skin weights of Joints0
+        Joints1,        // influences 5..8
+        Weights1,
+
+        NumComponents,
+        NumTexCoords = 4,
+    };
+    /// a range of indices which share the same material
+    struct Group {
+        std::int32_t Material = 0;
+        int FirstIndex = 0;
+        int NumIndices = 0;
+    };
+    /// sparse deltas of a blend shape, for the vertices it moves
+    struct Shape {
+        /// vertex indices, ascending
+        std::vector<std::uint32_t> Vertices;
+        /// position deltas, 3 floats per vertex
+        std::vector<float> Positions;
+        /// normal deltas, 3 floats per vertex, or empty
+        std::vector<float> Normals;
+    };
+
+    /// number of floats per vertex of a component
+    static int ComponentSize(Component comp);
+    /// get component name (as used in JSON output)
+    static const char* ComponentName(Component comp);
+
+    /// return true if the mesh has a vertex component
+    bool Has(Component comp) const;
+    /// get number of triangles
+    int NumTriangles() const;
+    /// clear all data
+    void Clear();
+
+    int NumVertices = 0;
+    std::vector<float> Streams[NumComponents];
+    std::vector<std::uint32_t> Indices;
+    /// per-triangle material index
+    std::vector<std::int32_t> TriangleMaterials;
+    /// per-vertex index of the control point the vertex was created from
+    std::vector<std::int32_t> PointIndices;
+    /// material groups (after triangles have been sorted by material)
+    std::vector<Group> Groups;
+    /// optional per-vertex weld keys, vertices are only welded if their keys match
+    std::vector<std::uint32_t> WeldKeys;
+    /// blend shapes (added after the processing stages)
+    std::vector<Shape> Shapes;
+};
+
+//------------------------------------------------------------------------------
+inline int
+MeshData::ComponentSize(Component comp) {
+    switch (comp) {
+        case Position:
+        case Normal:
+        case Binormal:
+            return 3;
+        case Tangent:
+        case Color:
+        case Joints0:
+        case Weights0:
+        case Joints1:
+        case Weights1:
+            return 4;
+        default:
+            return 2;
+    }
+}
+
+//------------------------------------------------------------------------------
+inline bool
+MeshData::Has(Component comp) const {
+    return !this->Streams[comp].empty();
+}
+
+//------------------------------------------------------------------------------
+inline int
+MeshData::NumTriangles() const {
+    return (int) (this->Indices.size() / 3);
+}
+
+} // namespace FBXC
@@ -0,0 +1,142 @@
+//------------------------------------------------------------------------------
+//  MeshExtractor.cc
+//------------------------------------------------------------------------------
+#include "MeshExtractor.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+MeshExtractor::ExtractElement(const MeshSource& src, const MeshSource::Element& elm, int numComps, const float* defaults, std::vector<float>& out) {
+    if ((MeshSource::None == elm.Map) || (nullptr == elm.Direct)) {
+        return;
+    }
+    const int numVerts = src.NumPolygonVertices;
+    out.resize(numVerts * numComps);
+    float* dst = out.data();
+    const int copyComps = std::min(numComps, elm.Stride);
+    auto write = [&elm, dst, numComps, copyComps, defaults](int vertIndex, int elmIndex) {
+        if (elm.Index) {
+            elmIndex = (elmIndex < elm.NumIndex) ? elm.Index[elmIndex] : -1;
+        }
+        float* d = dst + vertIndex * numComps;
+        int c = 0;
+        if ((elmIndex >= 0) && (elmIndex < elm.NumDirect)) {
+            const double* s = elm.Direct + elmIndex * elm.Stride;
+            for (; c < copyComps; c++) {
+                d[c] = (float) s[c];
+            }
+        }
+        for (; c < numComps; c++) {
+            d[c] = defaults[c];
+        }
+    };
+    switch (elm.Map) {
+        case MeshSource::ByControlPoint:
+            for (int v = 0; v < numVerts; v++) {
+                const std::int32_t cp = src.PolygonVertices[v];
+                write(v, cp < 0 ? ~cp : cp);
+            }
+            break;
+        case MeshSource::ByPolygonVertex:
+            for (int v = 0; v < numVerts; v++) {
+                write(v, v);
+            }
+            break;
+        case MeshSource::ByPolygon:
+            for (int p = 0; p < src.NumPolygons(); p++) {
+                for (int v = src.PolygonStarts[p]; v < src.PolygonStarts[p + 1]; v++) {
+                    write(v, p);
+                }
+            }
+            break;
+        case MeshSource::AllSame:
+            for (int v = 0; v < numVerts; v++) {
+                write(v, 0);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshExtractor::Extract(const MeshSource& src, MeshData& out) {
+    out.Clear();
+    const int numPolys = src.NumPolygons();
+    const int numVerts = src.NumPolygonVertices;
+    if ((numVerts > 0) && (0 == src.NumPoints)) {
+        Log::Fatal("mesh has polygons but no control points\n");
+    }
+    out.NumVertices = numVerts;
+
+    // control point of each polygon vertex, and vertex positions
+    out.PointIndices.resize(numVerts);
+    out.Streams[MeshData::Position].resize(numVerts * 3);
+    float* pos = out.Streams[MeshData::Position].data();
+    for (int v = 0; v < numVerts; v++) {
+        std::int32_t cp = src.PolygonVertices[v];
+        if (cp < 0) {
+            cp = ~cp;
+        }
+        if (cp >= src.NumPoints) {
+            Log::Warn("polygon vertex %d references invalid control point %d\n", v, cp);
+            cp = 0;
+        }
+        out.PointIndices[v] = cp;
+        const double* p = src.Points + cp * src.PointStride;
+        pos[v * 3 + 0] = (float) p[0];
+        pos[v * 3 + 1] = (float) p[1];
+        pos[v * 3 + 2] = (float) p[2];
+    }
+
+    // layer elements
+    static const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    static const float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const float tangentDefaults[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    ExtractElement(src, src.Normals, 3, zero, out.Streams[MeshData::Normal]);
+    ExtractElement(src, src.Tangents, 4, tangentDefaults, out.Streams[MeshData::Tangent]);
+    ExtractElement(src, src.Binormals, 3, zero, out.Streams[MeshData::Binormal]);
+    ExtractElement(src, src.Colors, 4, one, out.Streams[MeshData::Color]);
+    for (int i = 0; (i < src.NumUVSets) && (i < MeshData::NumTexCoords); i++) {
+        ExtractElement(src, src.UVs[i], 2, zero, out.Streams[MeshData::TexCoord0 + i]);
+    }
+
+    // fan-triangulate polygons
+    int numTris = 0;
+    for (int p = 0; p < numPolys; p++) {
+        const int size = src.PolygonStarts[p + 1] - src.PolygonStarts[p];
+        if (size >= 3) {
+            numTris += size - 2;
+        }
+    }
+    out.Indices.resize(numTris * 3);
+    out.TriangleMaterials.resize(numTris);
+    const MeshSource::Element& mats = src.Materials;
+    std::uint32_t* idx = out.Indices.data();
+    std::int32_t* triMat = out.TriangleMaterials.data();
+    for (int p = 0; p < numPolys; p++) {
+        const int start = src.PolygonStarts[p];
+        const int end = src.PolygonStarts[p + 1];
+        std::int32_t mat = 0;
+        if (mats.Index && (mats.NumIndex > 0)) {
+            if (MeshSource::AllSame == mats.Map) {
+                mat = mats.Index[0];
+            }
+            else if ((MeshSource::ByPolygon == mats.Map) && (p < mats.NumIndex)) {
+                mat = mats.Index[p];
+            }
+        }
+        for (int v = start + 1; v < end - 1; v++) {
+            *idx++ = (std::uint32_t) start;
+            *idx++ = (std::uint32_t) v;
+            *idx++ = (std::uint32_t) (v + 1);
+            *triMat++ = mat;
+        }
+    }
+}
+
+} // namespace FBXC
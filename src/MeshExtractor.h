@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshExtractor
+    @brief turns a MeshSource into triangulated MeshData
+
+    Every polygon vertex becomes one output vertex, polygons are
+    fan-triangulated. Vertices are not shared between polygons,
+    this is the job of the MeshWelder stage. All loops work
+    on the raw MeshSource arrays.
+*/
+#include "MeshSource.h"
+#include "MeshData.h"
+
+namespace FBXC {
+
+class MeshExtractor {
+public:
+    /// extract triangulated vertex and index data from a mesh source
+    static void Extract(const MeshSource& src, MeshData& outData);
+
+private:
+    /// resolve a layer element into a planar float stream
+    static void ExtractElement(const MeshSource& src, const MeshSource::Element& elm, int numComps, const float* defaults, std::vector<float>& out);
+};
+
+} // namespace FBXC
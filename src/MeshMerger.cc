@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//  MeshMerger.cc
+//------------------------------------------------------------------------------
+#include "MeshMerger.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+MeshMerger::AddDefaults(MeshData::Component comp, int numVerts, std::vector<float>& stream) {
+    static const float zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    static const float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const float tangentDefaults[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const float* defaults = zero;
+    if (MeshData::Color == comp) {
+        defaults = one;
+    }
+    else if (MeshData::Tangent == comp) {
+        defaults = tangentDefaults;
+    }
+    const int size = MeshData::ComponentSize(comp);
+    for (int v = 0; v < numVerts; v++) {
+        stream.insert(stream.end(), defaults, defaults + size);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshMerger::Append(const MeshData& src, const std::vector<std::int32_t>& materialMap, int pointOffset, MeshData& dst) {
+    const int baseVertex = dst.NumVertices;
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        const MeshData::Component comp = (MeshData::Component) i;
+        std::vector<float>& stream = dst.Streams[i];
+        if (src.Has(comp)) {
+            if (!dst.Has(comp)) {
+                AddDefaults(comp, baseVertex, stream);
+            }
+            stream.insert(stream.end(), src.Streams[i].begin(), src.Streams[i].end());
+        }
+        else if (dst.Has(comp)) {
+            AddDefaults(comp, src.NumVertices, stream);
+        }
+    }
+    dst.NumVertices += src.NumVertices;
+
+    dst.Indices.reserve(dst.Indices.size() + src.Indices.size());
+    for (std::uint32_t index : src.Indices) {
+        dst.Indices.push_back(index + baseVertex);
+    }
+    // materials without a mapping end up in a group without material (-1)
+    dst.TriangleMaterials.reserve(dst.TriangleMaterials.size() + src.TriangleMaterials.size());
+    for (std::int32_t mat : src.TriangleMaterials) {
+        const bool mapped = (mat >= 0) && (mat < (std::int32_t) materialMap.size());
+        dst.TriangleMaterials.push_back(mapped ? materialMap[mat] : -1);
+    }
+    dst.PointIndices.reserve(dst.PointIndices.size() + src.PointIndices.size());
+    for (std::int32_t pointIndex : src.PointIndices) {
+        dst.PointIndices.push_back(pointIndex + pointOffset);
+    }
+}
+
+} // namespace FBXC
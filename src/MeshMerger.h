@@ -0,0 +1,40 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshMerger
+    @brief appends the MeshData of several meshes into one
+
+    Used by hierarchy flattening: each Part is a source mesh instance
+    with the transform to bake into its vertices and the mapping of
+    its material indices to the material list of the merged mesh.
+    Vertex components which only some parts have are filled with the
+    same defaults MeshExtractor uses for missing layer elements.
+*/
+#include "MeshData.h"
+#include "Matrix44.h"
+
+namespace FBXC {
+
+class MeshMerger {
+public:
+    /// a source mesh instance in a merged mesh
+    struct Part {
+        /// index of the source mesh
+        int Source = 0;
+        /// transform from the source mesh into the merged mesh
+        Matrix44 Transform;
+        /// merged material index by source material index
+        std::vector<std::int32_t> MaterialMap;
+        /// generate tangents for this instance before it's transformed
+        bool GenerateTangents = false;
+    };
+
+    /// append src to dst, src material indices are remapped, point indices offset by pointOffset
+    static void Append(const MeshData& src, const std::vector<std::int32_t>& materialMap, int pointOffset, MeshData& dst);
+
+private:
+    /// add numVerts default values to a component stream
+    static void AddDefaults(MeshData::Component comp, int numVerts, std::vector<float>& stream);
+};
+
+} // namespace FBXC
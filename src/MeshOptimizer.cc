@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+//  MeshOptimizer.cc
+//------------------------------------------------------------------------------
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+int
+MeshOptimizer::CacheMisses(const MeshData& data, int cacheSize) {
+    // a vertex is in the FIFO cache if it was inserted during the
+    // last cacheSize insertions
+    std::vector<int> stamp(data.NumVertices, -(cacheSize + 1));
+    int time = 0;
+    for (std::uint32_t index : data.Indices) {
+        if ((time - stamp[index]) > cacheSize) {
+            stamp[index] = time++;
+        }
+    }
+    return time;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::Tipsify(const MeshData& data, int cacheSize, std::vector<std::uint32_t>& outTriOrder, std::vector<int>& outClusters) {
+    const int numVerts = data.NumVertices;
+    const int numTris = data.NumTriangles();
+    const std::uint32_t* indices = data.Indices.data();
+
+    // vertex/triangle adjacency, live[] is the number of not yet emitted
+    // triangles of a vertex
+    std::vector<int> live(numVerts, 0);
+    for (int i = 0; i < numTris * 3; i++) {
+        live[indices[i]]++;
+    }
+    std::vector<int> adjStart(numVerts + 1, 0);
+    for (int v = 0; v < numVerts; v++) {
+        adjStart[v + 1] = adjStart[v] + live[v];
+    }
+    std::vector<std::uint32_t> adjTris(numTris * 3);
+    std::vector<int> adjFill(adjStart.begin(), adjStart.end() - 1);
+    for (int t = 0; t < numTris; t++) {
+        for (int c = 0; c < 3; c++) {
+            adjTris[adjFill[indices[t * 3 + c]]++] = t;
+        }
+    }
+
+    std::vector<int> cacheTime(numVerts, 0);
+    std::vector<bool> emitted(numTris, false);
+    std::vector<std::uint32_t> deadEnd;
+    std::vector<std::uint32_t> candidates;
+    outTriOrder.clear();
+    outTriOrder.reserve(numTris);
+    outClusters.clear();
+    outClusters.push_back(0);
+    int time = cacheSize + 1;
+    int cursor = 1;
+    int fanVertex = 0;
+    while (fanVertex >= 0) {
+        // emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for (int i = adjStart[fanVertex]; i < adjStart[fanVertex + 1]; i++) {
+            const std::uint32_t t = adjTris[i];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            outTriOrder.push_back(t);
+            for (int c = 0; c < 3; c++) {
+                const std::uint32_t v = indices[t * 3 + c];
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if ((time - cacheTime[v]) > cacheSize) {
+                    cacheTime[v] = time++;
+                }
+            }
+        }
+
+        // next fanning vertex: the oldest candidate which will still be
+        // in the cache after its remaining triangles have been emitted
+        int next = -1;
+        int bestPriority = -1;
+        for (std::uint32_t v : candidates) {
+            if (live[v] > 0) {
+                int priority = 0;
+                if ((time - cacheTime[v] + 2 * live[v]) <= cacheSize) {
+                    priority = time - cacheTime[v];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    next = v;
+                }
+            }
+        }
+        if (-1 == next) {
+            // dead end, first try recently used vertices, then scan for any
+            // vertex with remaining triangles
+            while (!deadEnd.empty() && (-1 == next)) {
+                const std::uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) {
+                    next = v;
+                }
+            }
+            while ((cursor < numVerts) && (-1 == next)) {
+                if (live[cursor] > 0) {
+                    next = cursor;
+                }
+                else {
+                    cursor++;
+                }
+            }
+            // if the new fanning vertex is no longer in the cache, the
+            // triangle sequence is broken and a new cluster starts
+            if ((-1 != next) && ((time - cacheTime[next]) > cacheSize) &&
+                ((int) outTriOrder.size() > outClusters.back())) {
+                outClusters.push_back((int) outTriOrder.size());
+            }
+        }
+        fanVertex = next;
+    }
+    assert((int) outTriOrder.size() == numTris);
+    outClusters.push_back(numTris);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::SortClusters(const MeshData& data, const std::vector<int>& clusters, std::vector<std::uint32_t>& triOrder) {
+    const int numClusters = (int) clusters.size() - 1;
+    if (numClusters < 2) {
+        return;
+    }
+    const float* pos = data.Streams[MeshData::Position].data();
+    const std::uint32_t* indices = data.Indices.data();
+
+    // area-weighted centroid and normal of each cluster and of the whole mesh
+    std::vector<double> centroids(numClusters * 3, 0.0);
+    std::vector<double> normals(numClusters * 3, 0.0);
+    std::vector<double> areas(numClusters, 0.0);
+    double meshCentroid[3] = { 0.0, 0.0, 0.0 };
+    double meshArea = 0.0;
+    for (int c = 0; c < numClusters; c++) {
+        for (int i = clusters[c]; i < clusters[c + 1]; i++) {
+            const std::uint32_t t = triOrder[i];
+            const float* p0 = pos + indices[t * 3 + 0] * 3;
+            const float* p1 = pos + indices[t * 3 + 1] * 3;
+            const float* p2 = pos + indices[t * 3 + 2] * 3;
+            const double e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            const double e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            const double n[3] = {
+                e0[1] * e1[2] - e0[2] * e1[1],
+                e0[2] * e1[0] - e0[0] * e1[2],
+                e0[0] * e1[1] - e0[1] * e1[0]
+            };
+            const double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int k = 0; k < 3; k++) {
+                const double center = (p0[k] + p1[k] + p2[k]) / 3.0;
+                centroids[c * 3 + k] += center * area;
+                normals[c * 3 + k] += n[k];
+                meshCentroid[k] += center * area;
+            }
+            areas[c] += area;
+            meshArea += area;
+        }
+    }
+    if (meshArea <= 0.0) {
+        return;
+    }
+
+    // occlusion potential: how far a cluster lies in front of the
+    // mesh center along its own normal direction
+    std::vector<double> potential(numClusters, 0.0);
+    for (int c = 0; c < numClusters; c++) {
+        const double* n = &normals[c * 3];
+        const double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if ((areas[c] > 0.0) && (len > 0.0)) {
+            double dot = 0.0;
+            for (int k = 0; k < 3; k++) {
+                dot += (centroids[c * 3 + k] / areas[c] - meshCentroid[k] / meshArea) * (n[k] / len);
+            }
+            potential[c] = dot;
+        }
+    }
+    std::vector<int> clusterOrder(numClusters);
+    for (int c = 0; c < numClusters; c++) {
+        clusterOrder[c] = c;
+    }
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&potential](int a, int b) {
+        return potential[a] > potential[b];
+    });
+    std::vector<std::uint32_t> sortedOrder;
+    sortedOrder.reserve(triOrder.size());
+    for (int c : clusterOrder) {
+        sortedOrder.insert(sortedOrder.end(), triOrder.begin() + clusters[c], triOrder.begin() + clusters[c + 1]);
+    }
+    triOrder.swap(sortedOrder);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::ReorderTriangles(MeshData& data, const std::vector<std::uint32_t>& triOrder) {
+    const int numTris = data.NumTriangles();
+    std::vector<std::uint32_t> indices(numTris * 3);
+    std::vector<std::int32_t> materials(numTris);
+    for (int i = 0; i < numTris; i++) {
+        const std::uint32_t t = triOrder[i];
+        indices[i * 3 + 0] = data.Indices[t * 3 + 0];
+        indices[i * 3 + 1] = data.Indices[t * 3 + 1];
+        indices[i * 3 + 2] = data.Indices[t * 3 + 2];
+        materials[i] = data.TriangleMaterials[t];
+    }
+    data.Indices.swap(indices);
+    data.TriangleMaterials.swap(materials);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::ReorderVertices(MeshData& data) {
+    const int numVerts = data.NumVertices;
+    const std::uint32_t unused = 0xFFFFFFFF;
+    std::vector<std::uint32_t> newIndex(numVerts, unused);
+    std::vector<std::uint32_t> oldIndex;
+    oldIndex.reserve(numVerts);
+    for (std::uint32_t& index : data.Indices) {
+        if (unused == newIndex[index]) {
+            newIndex[index] = (std::uint32_t) oldIndex.size();
+            oldIndex.push_back(index);
+        }
+        index = newIndex[index];
+    }
+    // vertices which are not referenced by any triangle go to the end
+    for (int v = 0; v < numVerts; v++) {
+        if (unused == newIndex[v]) {
+            newIndex[v] = (std::uint32_t) oldIndex.size();
+            oldIndex.push_back(v);
+        }
+    }
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        const MeshData::Component comp = (MeshData::Component) i;
+        if (!data.Has(comp)) {
+            continue;
+        }
+        const int size = MeshData::ComponentSize(comp);
+        const std::vector<float>& src = data.Streams[comp];
+        std::vector<float> dst(src.size());
+        for (int v = 0; v < numVerts; v++) {
+            std::copy(&src[oldIndex[v] * size], &src[oldIndex[v] * size] + size, &dst[v * size]);
+        }
+        data.Streams[comp].swap(dst);
+    }
+    std::vector<std::int32_t> pointIndices(numVerts);
+    for (int v = 0; v < numVerts; v++) {
+        pointIndices[v] = data.PointIndices[oldIndex[v]];
+    }
+    data.PointIndices.swap(pointIndices);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshOptimizer::Optimize(MeshData& data, int cacheSize) {
+    assert(cacheSize > 0);
+    if (0 == data.NumTriangles()) {
+        return;
+    }
+    std::vector<std::uint32_t> triOrder;
+    std::vector<int> clusters;
+    Tipsify(data, cacheSize, triOrder, clusters);
+    SortClusters(data, clusters, triOrder);
+    ReorderTriangles(data, triOrder);
+    ReorderVertices(data);
+}
+
+} // namespace FBXC
@@ -0,0 +1,37 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshOptimizer
+    @brief vertex cache, overdraw and vertex fetch optimization
+
+    Triangles are reordered for the post-transform vertex cache with
+    Tipsify (Sander, Nehab, Barczak: "Fast Triangle Reordering for
+    Vertex Locality and Reduced Overdraw"), which runs in linear time.
+    The resulting clusters are then sorted by their occlusion potential
+    (outward-facing clusters first) to reduce overdraw. Finally vertices
+    are renumbered in order of first use so that vertex fetches become
+    sequential. All stages keep the per-triangle material indices in sync.
+*/
+#include "MeshData.h"
+
+namespace FBXC {
+
+class MeshOptimizer {
+public:
+    /// reorder triangles and vertices in place
+    static void Optimize(MeshData& data, int cacheSize);
+    /// simulate a FIFO vertex cache, return number of cache misses
+    static int CacheMisses(const MeshData& data, int cacheSize);
+    /// renumber vertices in order of first use
+    static void ReorderVertices(MeshData& data);
+
+private:
+    /// Tipsify triangle order, returns new triangle order and cluster start indices
+    static void Tipsify(const MeshData& data, int cacheSize, std::vector<std::uint32_t>& outTriOrder, std::vector<int>& outClusters);
+    /// sort triangle clusters by occlusion potential
+    static void SortClusters(const MeshData& data, const std::vector<int>& clusters, std::vector<std::uint32_t>& triOrder);
+    /// reorder triangles by a new triangle order
+    static void ReorderTriangles(MeshData& data, const std::vector<std::uint32_t>& triOrder);
+};
+
+} // namespace FBXC
@@ -0,0 +1,430 @@
+//------------------------------------------------------------------------------
+//  MeshPipeline.cc
+//------------------------------------------------------------------------------
+#include "MeshPipeline.h"
+#include "MeshExtractor.h"
+#include "SkinExtractor.h"
+#include "ShapeExtractor.h"
+#include "TangentGenerator.h"
+#include "TransformBaker.h"
+#include "MeshWelder.h"
+#include "MeshOptimizer.h"
+#include "MaterialSorter.h"
+#include "MeshSplitter.h"
+#include "VertexPacker.h"
+#include "fbxc_scene.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+/// the has* flags describe the exported mesh, generated tangents count too
+static void
+addGeneratedTangentFlags(ProxyMesh& mesh) {
+    const MeshData& data = mesh.Pieces.empty() ? mesh.Data : mesh.Pieces[0].Data;
+    if (data.Has(MeshData::Tangent)) {
+        mesh.Properties.Set("hastangents", true);
+    }
+    if (data.Has(MeshData::Binormal)) {
+        mesh.Properties.Set("hasbinormals", true);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+MeshPipeline::Process(const MeshSource& src, const ExportOptions& options, const MeshCache* cache, ThreadPool* pool, ProxyMesh& mesh) {
+    PropertyMap stats;
+    std::string cacheKey;
+    bool cacheHit = false;
+    if (cache) {
+        cacheKey = cache->Key(src, options, mesh.GenerateTangents);
+        cacheHit = cache->Load(cacheKey, mesh, stats);
+    }
+    if (!cacheHit) {
+        ProcessData(src, options, pool, mesh, stats);
+        if (cache) {
+            cache->Save(cacheKey, mesh, stats);
+        }
+    }
+    AddStats(stats, mesh);
+    if (mesh.GenerateTangents) {
+        addGeneratedTangentFlags(mesh);
+    }
+    return cacheHit;
+}
+
+//------------------------------------------------------------------------------
+bool
+MeshPipeline::ProcessMerged(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options, const MeshCache* cache, ThreadPool* pool, ProxyMesh& mesh) {
+    PropertyMap stats;
+    std::string cacheKey;
+    bool cacheHit = false;
+    if (cache) {
+        cacheKey = cache->Key(parts, sources, options);
+        cacheHit = cache->Load(cacheKey, mesh, stats);
+    }
+    if (!cacheHit) {
+        ProcessMergedData(parts, sources, options, pool, mesh, stats);
+        if (cache) {
+            cache->Save(cacheKey, mesh, stats);
+        }
+    }
+    AddStats(stats, mesh);
+    for (const MeshMerger::Part& part : parts) {
+        if (part.GenerateTangents) {
+            addGeneratedTangentFlags(mesh);
+            break;
+        }
+    }
+    return cacheHit;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::AddStats(const PropertyMap& stats, ProxyMesh& mesh) {
+    for (const PropertyMap::Entry& entry : stats) {
+        mesh.Properties.Add(entry.Key, entry.Val);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::ProcessData(const MeshSource& src, const ExportOptions& options, ThreadPool* pool, ProxyMesh& mesh, PropertyMap& stats) {
+    MeshExtractor::Extract(src, mesh.Data);
+    if (mesh.GenerateTangents) {
+        TangentGenerator::Generate(mesh.Data, pool);
+    }
+    if (options.Skin) {
+        SkinExtractor::Extract(src, options.SkinInfluences, mesh.Data);
+    }
+    const bool hasShapes = options.BlendShapes && !src.Shapes.empty();
+    if (hasShapes && options.Weld) {
+        ShapeExtractor::SetupWeldKeys(src, options.BlendShapeEpsilon, mesh.Data);
+    }
+    ProcessStages(options, mesh, stats);
+    if (hasShapes) {
+        // shape deltas refer to the final vertex order of each piece
+        if (mesh.Pieces.empty()) {
+            ShapeExtractor::Extract(src, options.BlendShapeEpsilon, mesh.Data);
+        }
+        else {
+            for (ProxyMesh& piece : mesh.Pieces) {
+                ShapeExtractor::Extract(src, options.BlendShapeEpsilon, piece.Data);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::ProcessMergedData(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options, ThreadPool* pool, ProxyMesh& mesh, PropertyMap& stats) {
+    mesh.Data.Clear();
+    MeshData partData;
+    int pointOffset = 0;
+    for (const MeshMerger::Part& part : parts) {
+        const MeshSource& src = *sources[part.Source];
+        MeshExtractor::Extract(src, partData);
+        if (part.GenerateTangents) {
+            TangentGenerator::Generate(partData, pool);
+        }
+        TransformBaker::Bake(partData, part.Transform);
+        MeshMerger::Append(partData, part.MaterialMap, pointOffset, mesh.Data);
+        pointOffset += src.NumPoints;
+    }
+    ProcessStages(options, mesh, stats);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::ProcessStages(const ExportOptions& options, ProxyMesh& mesh, PropertyMap& stats) {
+    stats.Add("numrawvertices", (std::int32_t) mesh.Data.NumVertices);
+    stats.Add("numrawtriangles", (std::int32_t) mesh.Data.NumTriangles());
+    if (options.Weld) {
+        MeshWelder::Weld(mesh.Data, options.WeldEpsilon);
+    }
+    const double numTris = mesh.Data.NumTriangles();
+    const double numVerts = mesh.Data.NumVertices;
+    const bool optimize = options.OptimizeIndices && (numTris > 0);
+    const int rawMisses = optimize ? MeshOptimizer::CacheMisses(mesh.Data, options.VertexCacheSize) : 0;
+    if (optimize) {
+        MeshOptimizer::Optimize(mesh.Data, options.VertexCacheSize);
+    }
+    // sorting by material keeps the triangle order within a material,
+    // but vertex fetch order must be fixed up afterwards
+    MaterialSorter::Sort(mesh.Data);
+    if (optimize) {
+        if (mesh.Data.Groups.size() > 1) {
+            MeshOptimizer::ReorderVertices(mesh.Data);
+        }
+        const int misses = MeshOptimizer::CacheMisses(mesh.Data, options.VertexCacheSize);
+        stats.Add("rawacmr", rawMisses / numTris);
+        stats.Add("rawatvr", rawMisses / numVerts);
+        stats.Add("acmr", misses / numTris);
+        stats.Add("atvr", misses / numVerts);
+    }
+    if (options.SplitMeshes && (mesh.Data.NumVertices > MeshSplitter::MaxVertices)) {
+        std::vector<MeshData> pieces;
+        MeshSplitter::Split(mesh.Data, MeshSplitter::MaxVertices, pieces);
+        for (MeshData& pieceData : pieces) {
+            mesh.Pieces.emplace_back();
+            mesh.Pieces.back().Data = std::move(pieceData);
+        }
+        mesh.Data.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::WriteData(const ExportOptions& options, BlobWriter& blob, const MeshData& data, const std::vector<Value>& materialIds, PropertyMap& props) {
+    auto toValue = [](const char* str) {
+        Value val;
+        val.Set(str);
+        return val;
+    };
+    auto toIntValue = [](std::uint64_t i) {
+        Value val;
+        val.Set((std::int32_t) i);
+        return val;
+    };
+    // blob offsets are 64-bit, blobs may be larger than 2 GB
+    auto toOffsetValue = [](std::uint64_t offset) {
+        Value val;
+        val.Set(offset);
+        return val;
+    };
+
+    const int numVerts = data.NumVertices;
+    std::vector<Value> layout;
+    std::vector<Value> formats;
+    std::vector<Value> offsets;
+    std::vector<Value> strides;
+    if (options.PlanarVertices) {
+        // one tightly packed stream per component
+        std::vector<std::uint8_t> stream;
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            const MeshData::Component comp = (MeshData::Component) i;
+            if (data.Has(comp)) {
+                const VertexFormat::Code fmt = options.VertexFormats[comp];
+                const int byteSize = VertexFormat::ByteSize(fmt);
+                stream.resize(numVerts * byteSize);
+                VertexPacker::Pack(fmt, data.Streams[comp].data(), MeshData::ComponentSize(comp), numVerts, stream.data(), byteSize);
+                layout.push_back(toValue(MeshData::ComponentName(comp)));
+                formats.push_back(toValue(VertexFormat::ToString(fmt)));
+                offsets.push_back(toOffsetValue(blob.Write(stream.data(), stream.size())));
+                strides.push_back(toIntValue(byteSize));
+            }
+        }
+    }
+    else {
+        // interleave all components into a single vertex buffer
+        int vertexStride = 0;
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            const MeshData::Component comp = (MeshData::Component) i;
+            if (data.Has(comp)) {
+                vertexStride += VertexFormat::ByteSize(options.VertexFormats[comp]);
+            }
+        }
+        std::vector<std::uint8_t> vertices(numVerts * vertexStride);
+        std::vector<int> compOffsets;
+        int compOffset = 0;
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            const MeshData::Component comp = (MeshData::Component) i;
+            if (data.Has(comp)) {
+                const VertexFormat::Code fmt = options.VertexFormats[comp];
+                VertexPacker::Pack(fmt, data.Streams[comp].data(), MeshData::ComponentSize(comp), numVerts, vertices.data() + compOffset, vertexStride);
+                layout.push_back(toValue(MeshData::ComponentName(comp)));
+                formats.push_back(toValue(VertexFormat::ToString(fmt)));
+                compOffsets.push_back(compOffset);
+                compOffset += VertexFormat::ByteSize(fmt);
+            }
+        }
+        const std::uint64_t vertexOffset = blob.Write(vertices.data(), vertices.size());
+        for (int offset : compOffsets) {
+            offsets.push_back(toOffsetValue(vertexOffset + offset));
+            strides.push_back(toIntValue(vertexStride));
+        }
+    }
+    std::uint64_t indexOffset = 0;
+    if (options.SplitMeshes) {
+        std::vector<std::uint16_t> indices16(data.Indices.begin(), data.Indices.end());
+        indexOffset = blob.Write(indices16.data(), indices16.size() * sizeof(std::uint16_t));
+    }
+    else {
+        indexOffset = blob.Write(data.Indices.data(), data.Indices.size() * sizeof(std::uint32_t));
+    }
+
+    props.Add("vertexstreams", options.PlanarVertices ? "planar" : "interleaved");
+    props.Add("vertexlayout", std::move(layout));
+    props.Add("vertexformats", std::move(formats));
+    props.Add("vertexoffsets", std::move(offsets));
+    props.Add("vertexstrides", std::move(strides));
+    props.Add("numvertices", (std::int32_t) numVerts);
+    props.Add("numtriangles", (std::int32_t) data.NumTriangles());
+    props.Add("numindices", (std::int32_t) data.Indices.size());
+    props.Add("indextype", options.SplitMeshes ? "uint16" : "uint32");
+    props.Add("indexoffset", indexOffset);
+
+    // material groups, the material index is resolved to the material's id
+    std::vector<Value> groupMaterials;
+    std::vector<Value> groupFirstIndices;
+    std::vector<Value> groupNumIndices;
+    for (const MeshData::Group& group : data.Groups) {
+        Value matId;
+        if ((group.Material >= 0) && (group.Material < (int) materialIds.size())) {
+            matId = materialIds[group.Material];
+        }
+        else {
+            matId.Set((std::uint64_t) 0);
+        }
+        groupMaterials.push_back(matId);
+        groupFirstIndices.push_back(toIntValue(group.FirstIndex));
+        groupNumIndices.push_back(toIntValue(group.NumIndices));
+    }
+    props.Add("groupmaterials", std::move(groupMaterials));
+    props.Add("groupfirstindices", std::move(groupFirstIndices));
+    props.Add("groupnumindices", std::move(groupNumIndices));
+    if (!data.Shapes.empty()) {
+        WriteShapes(blob, data, props);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// quantize deltas to signed integers in [-maxQ, maxQ], returns the dequantization scale
+template<typename TYPE> static float
+quantizeDeltas(const std::vector<float>& deltas, int maxQ, std::vector<TYPE>& out) {
+    float maxAbs = 0.0f;
+    for (float d : deltas) {
+        maxAbs = std::max(maxAbs, std::fabs(d));
+    }
+    const float scale = maxAbs / maxQ;
+    const float invScale = (maxAbs > 0.0f) ? (maxQ / maxAbs) : 0.0f;
+    out.resize(deltas.size());
+    for (std::size_t i = 0; i < deltas.size(); i++) {
+        const long q = std::lround(deltas[i] * invScale);
+        out[i] = (TYPE) std::min(std::max(q, (long) -maxQ), (long) maxQ);
+    }
+    return scale;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::WriteShapes(BlobWriter& blob, const MeshData& data, PropertyMap& props) {
+    auto toIntValue = [](std::uint64_t i) {
+        Value val;
+        val.Set((std::int32_t) i);
+        return val;
+    };
+    // blob offsets are 64-bit, blobs may be larger than 2 GB
+    auto toOffsetValue = [](std::uint64_t offset) {
+        Value val;
+        val.Set(offset);
+        return val;
+    };
+    auto toFloatValue = [](float f) {
+        Value val;
+        val.Set((double) f);
+        return val;
+    };
+
+    // per shape: vertex indices, position deltas as 3 x int16 and normal
+    // deltas as 3 x int8, dequantized with a per-shape scale
+    const bool indices16 = data.NumVertices <= 0x10000;
+    std::vector<Value> numVertices;
+    std::vector<Value> indexOffsets;
+    std::vector<Value> positionOffsets;
+    std::vector<Value> positionScales;
+    std::vector<Value> normalOffsets;
+    std::vector<Value> normalScales;
+    std::vector<std::uint16_t> vertices16;
+    std::vector<std::int16_t> positions;
+    std::vector<std::int8_t> normals;
+    for (const MeshData::Shape& shape : data.Shapes) {
+        numVertices.push_back(toIntValue(shape.Vertices.size()));
+        if (indices16) {
+            vertices16.assign(shape.Vertices.begin(), shape.Vertices.end());
+            indexOffsets.push_back(toOffsetValue(blob.Write(vertices16.data(), vertices16.size() * sizeof(std::uint16_t))));
+        }
+        else {
+            indexOffsets.push_back(toOffsetValue(blob.Write(shape.Vertices.data(), shape.Vertices.size() * sizeof(std::uint32_t))));
+        }
+        positionScales.push_back(toFloatValue(quantizeDeltas(shape.Positions, 32767, positions)));
+        positionOffsets.push_back(toOffsetValue(blob.Write(positions.data(), positions.size() * sizeof(std::int16_t))));
+        if (shape.Normals.empty()) {
+            // no normal deltas
+            normalScales.push_back(toFloatValue(0.0f));
+            normalOffsets.push_back(toOffsetValue(FBXC_NO_OFFSET));
+        }
+        else {
+            normalScales.push_back(toFloatValue(quantizeDeltas(shape.Normals, 127, normals)));
+            normalOffsets.push_back(toOffsetValue(blob.Write(normals.data(), normals.size() * sizeof(std::int8_t))));
+        }
+    }
+    props.Add("blendshapeindextype", indices16 ? "uint16" : "uint32");
+    props.Add("blendshapenumvertices", std::move(numVertices));
+    props.Add("blendshapeindexoffsets", std::move(indexOffsets));
+    props.Add("blendshapepositionoffsets", std::move(positionOffsets));
+    props.Add("blendshapepositionscales", std::move(positionScales));
+    props.Add("blendshapenormaloffsets", std::move(normalOffsets));
+    props.Add("blendshapenormalscales", std::move(normalScales));
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::Write(const ExportOptions& options, BlobWriter& blob, ProxyMesh& mesh) {
+    // ubyte4 joint indices only reach joint 255, meshes with more joints get ushort4 joint indices
+    if ((mesh.Joints.size() > 256) && ((VertexFormat::UByte4 == options.VertexFormats[MeshData::Joints0]) ||
+                                       (VertexFormat::UByte4 == options.VertexFormats[MeshData::Joints1]))) {
+        ExportOptions jointOptions = options;
+        for (MeshData::Component comp : { MeshData::Joints0, MeshData::Joints1 }) {
+            if (VertexFormat::UByte4 == jointOptions.VertexFormats[comp]) {
+                jointOptions.VertexFormats[comp] = VertexFormat::UShort4;
+            }
+        }
+        Write(jointOptions, blob, mesh);
+        return;
+    }
+
+    std::vector<Value> materialIds;
+    if (mesh.Properties.Contains("materials")) {
+        materialIds = mesh.Properties["materials"].GetArray();
+    }
+    if (mesh.Pieces.empty()) {
+        WriteData(options, blob, mesh.Data, materialIds, mesh.Properties);
+    }
+    else {
+        mesh.Properties.Add("numpieces", (std::int32_t) mesh.Pieces.size());
+        for (std::size_t i = 0; i < mesh.Pieces.size(); i++) {
+            ProxyMesh& piece = mesh.Pieces[i];
+            piece.Properties.Add("piece", (std::int32_t) i);
+            WriteData(options, blob, piece.Data, materialIds, piece.Properties);
+        }
+    }
+    const bool hasShapes = mesh.Pieces.empty() ? !mesh.Data.Shapes.empty() : !mesh.Pieces[0].Data.Shapes.empty();
+    if (hasShapes) {
+        mesh.Properties.Add("blendshapes", mesh.ShapeNames);
+    }
+    const bool hasSkin = mesh.Pieces.empty() ? mesh.Data.Has(MeshData::Joints0) : mesh.Pieces[0].Data.Has(MeshData::Joints0);
+    if (hasSkin) {
+        WriteSkin(options, blob, mesh);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshPipeline::WriteSkin(const ExportOptions& options, BlobWriter& blob, ProxyMesh& mesh) {
+    const int numJoints = (int) mesh.Joints.size();
+    // inverse bind matrices as 16 column-major floats per joint
+    std::vector<float> matrices(numJoints * 16);
+    for (int i = 0; i < numJoints; i++) {
+        for (int j = 0; j < 16; j++) {
+            matrices[i * 16 + j] = (float) mesh.InverseBindMatrices[i].M[j];
+        }
+    }
+    const std::uint64_t offset = blob.Write(matrices.data(), matrices.size() * sizeof(float));
+    mesh.Properties.Add("skininfluences", (std::int32_t) options.SkinInfluences);
+    mesh.Properties.Add("joints", mesh.Joints);
+    mesh.Properties.Add("inversebindmatricesoffset", offset);
+}
+
+} // namespace FBXC
@@ -0,0 +1,66 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshPipeline
+    @brief runs the mesh processing stages and writes the result to a blob
+
+    Process() fills the MeshData of a ProxyMesh from a MeshSource (FBX SDK
+    mesh or BinaryFbx geometry record) and runs the processing
+    stages (extract, weld, optimize, material sort, split), or takes
+    the result from a MeshCache if the mesh source is unchanged.
+    ProcessMerged() does the same for a mesh merged from several source
+    mesh instances by hierarchy flattening, each instance is extracted
+    and transformed into the merged mesh's space before welding. Write()
+    appends vertex and index data to the blob and records the layout in
+    the mesh properties (or the properties of each piece if the mesh has
+    been split). With ExportOptions::Skin, the skin influences are
+    extracted right after the vertex data (not for merged meshes), and
+    Write() adds the joint node ids and the inverse bind matrices. Meshes
+    with more than 256 joints get ushort4 instead of ubyte4 joint indices.
+    With ExportOptions::BlendShapes, the sparse blend shape deltas are
+    extracted after the processing stages (see ShapeExtractor) and
+    written quantized next to the vertex data of each piece (shapes
+    without normal deltas have the normal offset FBXC_NO_OFFSET).
+    Meshes (or merged mesh instances) marked for tangent generation get
+    their tangents from TangentGenerator right after extraction, before
+    skin extraction and welding, its jobs run on the thread pool passed
+    in (serially if Process() is called from inside a pool job), and
+    their 'hastangents' (and 'hasbinormals') properties are set.
+*/
+#include "ProxyMesh.h"
+#include "MeshSource.h"
+#include "BlobWriter.h"
+#include "ExportOptions.h"
+#include "MeshCache.h"
+#include "MeshMerger.h"
+#include "ThreadPool.h"
+
+namespace FBXC {
+
+class MeshPipeline {
+public:
+    /// extract and process vertex and index data of a mesh (thread-safe for different meshes), optional cache, return true on cache hit
+    static bool Process(const MeshSource& src, const ExportOptions& options, const MeshCache* cache, ThreadPool* pool, ProxyMesh& mesh);
+    /// merge source mesh instances (sources indexed by MeshMerger::Part::Source) into a mesh and process it, like Process()
+    static bool ProcessMerged(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options, const MeshCache* cache, ThreadPool* pool, ProxyMesh& mesh);
+    /// write vertex and index data of a mesh to a blob
+    static void Write(const ExportOptions& options, BlobWriter& blob, ProxyMesh& mesh);
+
+private:
+    /// extract the mesh data and run the processing stages, statistics go into stats
+    static void ProcessData(const MeshSource& src, const ExportOptions& options, ThreadPool* pool, ProxyMesh& mesh, PropertyMap& stats);
+    /// extract, transform and merge the mesh data of source mesh instances, then run the processing stages
+    static void ProcessMergedData(const std::vector<MeshMerger::Part>& parts, const std::vector<const MeshSource*>& sources, const ExportOptions& options, ThreadPool* pool, ProxyMesh& mesh, PropertyMap& stats);
+    /// run the processing stages after extraction
+    static void ProcessStages(const ExportOptions& options, ProxyMesh& mesh, PropertyMap& stats);
+    /// add stats to the mesh properties
+    static void AddStats(const PropertyMap& stats, ProxyMesh& mesh);
+    /// write vertex and index data to a blob and record the layout in props
+    static void WriteData(const ExportOptions& options, BlobWriter& blob, const MeshData& data, const std::vector<Value>& materialIds, PropertyMap& props);
+    /// write the quantized blend shape deltas of mesh data to a blob and record their layout in props
+    static void WriteShapes(BlobWriter& blob, const MeshData& data, PropertyMap& props);
+    /// write the inverse bind matrices to a blob and record the skin joints in the mesh properties
+    static void WriteSkin(const ExportOptions& options, BlobWriter& blob, ProxyMesh& mesh);
+};
+
+} // namespace FBXC
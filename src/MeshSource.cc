@@ -0,0 +1,521 @@
+//------------------------------------------------------------------------------
+//  MeshSource.cc
+//------------------------------------------------------------------------------
+#include "MeshSource.h"
+#include "Log.h"
+#include <algorithm>
+
+namespace FBXC {
+
+/// layer element record names, array names and strides in binary FBX files
+enum {
+    NormalElement,
+    TangentElement,
+    BinormalElement,
+    ColorElement,
+    UVElement,
+    MaterialElement,
+    NumNativeElements
+};
+static const struct {
+    const char* element;
+    const char* direct;
+    const char* index;
+    int stride;
+} nativeElements[NumNativeElements] = {
+    { "LayerElementNormal", "Normals", "NormalsIndex", 3 },
+    { "LayerElementTangent", "Tangents", "TangentsIndex", 3 },
+    { "LayerElementBinormal", "Binormals", "BinormalsIndex", 3 },
+    { "LayerElementColor", "Colors", "ColorIndex", 4 },
+    { "LayerElementUV", "UV", "UVIndex", 2 },
+    { "LayerElementMaterial", nullptr, "Materials", 0 },
+};
+
+//------------------------------------------------------------------------------
+MeshSource::MeshSource() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+MeshSource::~MeshSource() {
+    for (auto& release : this->releasers) {
+        release();
+    }
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> void
+MeshSource::SetupElement(const FbxLayerElementTemplate<TYPE>* fbxElm, int stride, Element& elm) {
+    if (nullptr == fbxElm) {
+        return;
+    }
+    switch (fbxElm->GetMappingMode()) {
+        case FbxLayerElement::eByControlPoint:  elm.Map = ByControlPoint; break;
+        case FbxLayerElement::eByPolygonVertex: elm.Map = ByPolygonVertex; break;
+        case FbxLayerElement::eByPolygon:       elm.Map = ByPolygon; break;
+        case FbxLayerElement::eAllSame:         elm.Map = AllSame; break;
+        default:
+            // eByEdge and eNone are not supported
+            return;
+    }
+    if (stride > 0) {
+        FbxLayerElementArrayTemplate<TYPE>* direct = &fbxElm->GetDirectArray();
+        TYPE* directPtr = direct->GetLocked(FbxLayerElementArray::eReadLock);
+        this->releasers.push_back([direct, directPtr]() mutable {
+            direct->Release(&directPtr);
+        });
+        elm.Direct = (const double*) directPtr;
+        elm.NumDirect = direct->GetCount();
+        elm.Stride = stride;
+    }
+    if (fbxElm->GetReferenceMode() != FbxLayerElement::eDirect) {
+        FbxLayerElementArrayTemplate<int>* index = &fbxElm->GetIndexArray();
+        int* indexPtr = index->GetLocked(FbxLayerElementArray::eReadLock);
+        this->releasers.push_back([index, indexPtr]() mutable {
+            index->Release(&indexPtr);
+        });
+        elm.Index = indexPtr;
+        elm.NumIndex = index->GetCount();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::Setup(FbxMesh* fbxMesh) {
+    assert(fbxMesh);
+    assert(nullptr == this->Points);
+
+    // NOTE: FbxVector4 and FbxColor are 4 doubles, FbxVector2 is 2 doubles
+    this->Points = (const double*) fbxMesh->GetControlPoints();
+    this->NumPoints = fbxMesh->GetControlPointsCount();
+    this->PointStride = 4;
+    this->PolygonVertices = fbxMesh->GetPolygonVertices();
+    this->NumPolygonVertices = fbxMesh->GetPolygonVertexCount();
+    const int numPolygons = fbxMesh->GetPolygonCount();
+    this->PolygonStarts.resize(numPolygons + 1);
+    for (int polyIndex = 0; polyIndex < numPolygons; polyIndex++) {
+        this->PolygonStarts[polyIndex] = fbxMesh->GetPolygonVertexIndex(polyIndex);
+    }
+    this->PolygonStarts[numPolygons] = this->NumPolygonVertices;
+
+    this->SetupElement(fbxMesh->GetElementNormal(0), 4, this->Normals);
+    this->SetupElement(fbxMesh->GetElementTangent(0), 4, this->Tangents);
+    this->SetupElement(fbxMesh->GetElementBinormal(0), 4, this->Binormals);
+    this->SetupElement(fbxMesh->GetElementVertexColor(0), 4, this->Colors);
+    this->NumUVSets = CountUVSets(fbxMesh);
+    for (int i = 0; i < this->NumUVSets; i++) {
+        this->SetupElement(fbxMesh->GetElementUV(i), 2, this->UVs[i]);
+    }
+    this->SetupElement(fbxMesh->GetElementMaterial(0), 0, this->Materials);
+
+    if (fbxMesh->GetDeformerCount(FbxDeformer::eSkin) > 0) {
+        FbxSkin* fbxSkin = (FbxSkin*) fbxMesh->GetDeformer(0, FbxDeformer::eSkin);
+        const int numClusters = fbxSkin->GetClusterCount();
+        this->Clusters.resize(numClusters);
+        for (int i = 0; i < numClusters; i++) {
+            FbxCluster* fbxCluster = fbxSkin->GetCluster(i);
+            Cluster& cluster = this->Clusters[i];
+            cluster.Indices = fbxCluster->GetControlPointIndices();
+            cluster.Weights = fbxCluster->GetControlPointWeights();
+            cluster.Num = (cluster.Indices && cluster.Weights) ? fbxCluster->GetControlPointIndicesCount() : 0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+MeshSource::CountUVSets(FbxMesh* fbxMesh) {
+    return std::min(fbxMesh->GetElementUVCount(), (int) MaxUVSets);
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::SetupShapes(FbxMesh* fbxMesh) {
+    // the channels of all blend shape deformers, the last target shape of
+    // a channel is its full-weight shape, in-between shapes are ignored
+    const int numBlendShapes = fbxMesh->GetDeformerCount(FbxDeformer::eBlendShape);
+    for (int i = 0; i < numBlendShapes; i++) {
+        FbxBlendShape* fbxBlendShape = (FbxBlendShape*) fbxMesh->GetDeformer(i, FbxDeformer::eBlendShape);
+        const int numChannels = fbxBlendShape->GetBlendShapeChannelCount();
+        for (int c = 0; c < numChannels; c++) {
+            FbxBlendShapeChannel* fbxChannel = fbxBlendShape->GetBlendShapeChannel(c);
+            const int numTargets = fbxChannel->GetTargetShapeCount();
+            this->Shapes.emplace_back();
+            if (numTargets > 0) {
+                this->SetupShape(fbxChannel->GetTargetShape(numTargets - 1), this->Shapes.back());
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static const double*
+elementValue(const MeshSource::Element& elm, int i) {
+    if (elm.Index) {
+        i = (i < elm.NumIndex) ? elm.Index[i] : -1;
+    }
+    return ((i >= 0) && (i < elm.NumDirect)) ? elm.Direct + i * elm.Stride : nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::SetupShape(FbxShape* fbxShape, Shape& shape) {
+    // SDK shapes have absolute control points and normals, the deltas to
+    // the base mesh go into owned storage, normal deltas are only
+    // supported if both the shape and the mesh have normals by control point
+    const double* points = (const double*) fbxShape->GetControlPoints();
+    const int numPoints = points ? std::min(fbxShape->GetControlPointsCount(), this->NumPoints) : 0;
+    Element shapeNormals;
+    this->SetupElement(fbxShape->GetElementNormal(0), 4, shapeNormals);
+    const bool hasNormals = (ByControlPoint == shapeNormals.Map) && shapeNormals.Direct &&
+                            (ByControlPoint == this->Normals.Map) && this->Normals.Direct;
+    this->intArrays.emplace_back(new std::vector<std::int32_t>());
+    std::vector<std::int32_t>& indices = *this->intArrays.back();
+    this->doubleArrays.emplace_back(new std::vector<double>());
+    std::vector<double>& positions = *this->doubleArrays.back();
+    this->doubleArrays.emplace_back(new std::vector<double>());
+    std::vector<double>& normals = *this->doubleArrays.back();
+    for (int p = 0; p < numPoints; p++) {
+        const double* shapePoint = points + p * 4;
+        const double* basePoint = this->Points + p * this->PointStride;
+        double delta[6] = { };
+        for (int c = 0; c < 3; c++) {
+            delta[c] = shapePoint[c] - basePoint[c];
+        }
+        if (hasNormals) {
+            const double* shapeNormal = elementValue(shapeNormals, p);
+            const double* baseNormal = elementValue(this->Normals, p);
+            if (shapeNormal && baseNormal) {
+                for (int c = 0; c < 3; c++) {
+                    delta[3 + c] = shapeNormal[c] - baseNormal[c];
+                }
+            }
+        }
+        if ((delta[0] != 0.0) || (delta[1] != 0.0) || (delta[2] != 0.0) ||
+            (delta[3] != 0.0) || (delta[4] != 0.0) || (delta[5] != 0.0)) {
+            indices.push_back(p);
+            positions.insert(positions.end(), delta, delta + 3);
+            normals.insert(normals.end(), delta + 3, delta + 6);
+        }
+    }
+    shape.Indices = indices.data();
+    shape.Positions = positions.data();
+    shape.Normals = hasNormals ? normals.data() : nullptr;
+    shape.Num = (int) indices.size();
+}
+
+//------------------------------------------------------------------------------
+const double*
+MeshSource::Decode(ArrayCache& arrayCache, const BinaryFbx::Property& prop) {
+    this->doubleArrays.emplace_back(new std::vector<double>());
+    arrayCache.Read(prop, *this->doubleArrays.back());
+    return this->doubleArrays.back()->data();
+}
+
+//------------------------------------------------------------------------------
+const std::int32_t*
+MeshSource::DecodeIndices(ArrayCache& arrayCache, const BinaryFbx::Property& prop) {
+    this->intArrays.emplace_back(new std::vector<std::int32_t>());
+    arrayCache.Read(prop, *this->intArrays.back());
+    return this->intArrays.back()->data();
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::SetupElement(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node* elmNode,
+                         const char* directName, const char* indexName, int stride, Element& elm) {
+    if (nullptr == elmNode) {
+        return;
+    }
+    const BinaryFbx::Node* mappingNode = fbx.Find(*elmNode, "MappingInformationType");
+    const std::string mapping = (mappingNode && (mappingNode->NumProperties > 0)) ?
+        fbx.GetProperty(*mappingNode, 0).ToString() : std::string();
+    if ((mapping == "ByVertice") || (mapping == "ByVertex") || (mapping == "ByControlPoint")) {
+        elm.Map = ByControlPoint;
+    }
+    else if (mapping == "ByPolygonVertex") {
+        elm.Map = ByPolygonVertex;
+    }
+    else if (mapping == "ByPolygon") {
+        elm.Map = ByPolygon;
+    }
+    else if (mapping == "AllSame") {
+        elm.Map = AllSame;
+    }
+    else {
+        return;
+    }
+    const BinaryFbx::Node* refNode = fbx.Find(*elmNode, "ReferenceInformationType");
+    const std::string ref = (refNode && (refNode->NumProperties > 0)) ?
+        fbx.GetProperty(*refNode, 0).ToString() : std::string("Direct");
+    if (directName) {
+        const BinaryFbx::Node* directNode = fbx.Find(*elmNode, directName);
+        if (directNode && (directNode->NumProperties > 0)) {
+            const BinaryFbx::Property prop = fbx.GetProperty(*directNode, 0);
+            if (prop.IsArray()) {
+                elm.Direct = this->Decode(arrayCache, prop);
+                elm.NumDirect = (int) prop.ArrayLength / stride;
+                elm.Stride = stride;
+            }
+        }
+    }
+    // material indices are always stored as 'indices', regardless of reference mode
+    if ((ref != "Direct") || (nullptr == directName)) {
+        const BinaryFbx::Node* indexNode = fbx.Find(*elmNode, indexName);
+        if (indexNode && (indexNode->NumProperties > 0)) {
+            const BinaryFbx::Property prop = fbx.GetProperty(*indexNode, 0);
+            if (prop.IsArray()) {
+                elm.Index = this->DecodeIndices(arrayCache, prop);
+                elm.NumIndex = (int) prop.ArrayLength;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::Setup(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node& geomNode) {
+    assert(nullptr == this->Points);
+
+    const BinaryFbx::Node* verticesNode = fbx.Find(geomNode, "Vertices");
+    if (verticesNode && (verticesNode->NumProperties > 0)) {
+        const BinaryFbx::Property prop = fbx.GetProperty(*verticesNode, 0);
+        if (prop.IsArray()) {
+            this->Points = this->Decode(arrayCache, prop);
+            this->NumPoints = (int) prop.ArrayLength / 3;
+            this->PointStride = 3;
+        }
+    }
+    const BinaryFbx::Node* indicesNode = fbx.Find(geomNode, "PolygonVertexIndex");
+    if (indicesNode && (indicesNode->NumProperties > 0)) {
+        const BinaryFbx::Property prop = fbx.GetProperty(*indicesNode, 0);
+        if (prop.IsArray()) {
+            this->PolygonVertices = this->DecodeIndices(arrayCache, prop);
+            this->NumPolygonVertices = (int) prop.ArrayLength;
+        }
+    }
+    // the last vertex of each polygon is stored as (-index - 1)
+    this->PolygonStarts.clear();
+    this->PolygonStarts.push_back(0);
+    for (int i = 0; i < this->NumPolygonVertices; i++) {
+        if (this->PolygonVertices[i] < 0) {
+            this->PolygonStarts.push_back(i + 1);
+        }
+    }
+
+    // layer elements, only the first element of each type is used, except for UVs
+    const BinaryFbx::Node* elmNodes[NumNativeElements] = { };
+    for (const BinaryFbx::Node* child = fbx.Child(geomNode); child; child = fbx.Next(*child)) {
+        if (child->NumProperties == 0) {
+            continue;
+        }
+        for (int i = 0; i < NumNativeElements; i++) {
+            if ((UVElement != i) && child->Is(nativeElements[i].element)) {
+                if ((0 == fbx.GetProperty(*child, 0).ToInt()) && (nullptr == elmNodes[i])) {
+                    elmNodes[i] = child;
+                }
+            }
+        }
+    }
+    Element* elms[NumNativeElements] = {
+        &this->Normals, &this->Tangents, &this->Binormals, &this->Colors, nullptr, &this->Materials
+    };
+    for (int i = 0; i < NumNativeElements; i++) {
+        const auto& ne = nativeElements[i];
+        if (UVElement == i) {
+            const BinaryFbx::Node* uvNodes[MaxUVSets];
+            this->NumUVSets = FindUVSets(fbx, geomNode, uvNodes);
+            for (int uvSet = 0; uvSet < this->NumUVSets; uvSet++) {
+                this->SetupElement(fbx, arrayCache, uvNodes[uvSet], ne.direct, ne.index, ne.stride, this->UVs[uvSet]);
+            }
+        }
+        else {
+            this->SetupElement(fbx, arrayCache, elmNodes[i], ne.direct, ne.index, ne.stride, *elms[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+MeshSource::FindUVSets(const BinaryFbx& fbx, const BinaryFbx::Node& geomNode, const BinaryFbx::Node* outNodes[MaxUVSets]) {
+    // UV sets are used from typed index 0 up to the first missing one
+    for (int i = 0; i < MaxUVSets; i++) {
+        outNodes[i] = nullptr;
+    }
+    for (const BinaryFbx::Node* child = fbx.Child(geomNode); child; child = fbx.Next(*child)) {
+        if (child->Is(nativeElements[UVElement].element) && (child->NumProperties > 0)) {
+            const std::int64_t typedIndex = fbx.GetProperty(*child, 0).ToInt();
+            if ((typedIndex >= 0) && (typedIndex < MaxUVSets)) {
+                outNodes[typedIndex] = child;
+            }
+        }
+    }
+    int numUVSets = 0;
+    while ((numUVSets < MaxUVSets) && outNodes[numUVSets]) {
+        numUVSets++;
+    }
+    return numUVSets;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::SetupSkin(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::vector<const BinaryFbx::Node*>& clusterNodes) {
+    this->Clusters.resize(clusterNodes.size());
+    for (std::size_t i = 0; i < clusterNodes.size(); i++) {
+        // clusters without control points have no Indexes and Weights records
+        const BinaryFbx::Node* indexesNode = fbx.Find(*clusterNodes[i], "Indexes");
+        const BinaryFbx::Node* weightsNode = fbx.Find(*clusterNodes[i], "Weights");
+        if (indexesNode && weightsNode && (indexesNode->NumProperties > 0) && (weightsNode->NumProperties > 0)) {
+            const BinaryFbx::Property indexesProp = fbx.GetProperty(*indexesNode, 0);
+            const BinaryFbx::Property weightsProp = fbx.GetProperty(*weightsNode, 0);
+            if (indexesProp.IsArray() && weightsProp.IsArray()) {
+                Cluster& cluster = this->Clusters[i];
+                cluster.Indices = this->DecodeIndices(arrayCache, indexesProp);
+                cluster.Weights = this->Decode(arrayCache, weightsProp);
+                cluster.Num = (int) std::min(indexesProp.ArrayLength, weightsProp.ArrayLength);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::SetupShapes(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::vector<const BinaryFbx::Node*>& shapeNodes) {
+    // shape records store sparse deltas: control point indices, position
+    // deltas and optional normal deltas
+    this->Shapes.resize(shapeNodes.size());
+    for (std::size_t i = 0; i < shapeNodes.size(); i++) {
+        if (nullptr == shapeNodes[i]) {
+            continue;
+        }
+        const BinaryFbx::Node* indexesNode = fbx.Find(*shapeNodes[i], "Indexes");
+        const BinaryFbx::Node* verticesNode = fbx.Find(*shapeNodes[i], "Vertices");
+        const BinaryFbx::Node* normalsNode = fbx.Find(*shapeNodes[i], "Normals");
+        if (indexesNode && verticesNode && (indexesNode->NumProperties > 0) && (verticesNode->NumProperties > 0)) {
+            const BinaryFbx::Property indexesProp = fbx.GetProperty(*indexesNode, 0);
+            const BinaryFbx::Property verticesProp = fbx.GetProperty(*verticesNode, 0);
+            if (indexesProp.IsArray() && verticesProp.IsArray()) {
+                Shape& shape = this->Shapes[i];
+                shape.Indices = this->DecodeIndices(arrayCache, indexesProp);
+                shape.Positions = this->Decode(arrayCache, verticesProp);
+                shape.Num = (int) std::min(indexesProp.ArrayLength, verticesProp.ArrayLength / 3);
+                if (normalsNode && (normalsNode->NumProperties > 0)) {
+                    const BinaryFbx::Property normalsProp = fbx.GetProperty(*normalsNode, 0);
+                    if (normalsProp.IsArray() && ((int) (normalsProp.ArrayLength / 3) >= shape.Num)) {
+                        shape.Normals = this->Decode(arrayCache, normalsProp);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::CollectShapeArrays(const BinaryFbx& fbx, const BinaryFbx::Node& shapeNode, std::vector<BinaryFbx::Property>& outProps) {
+    for (const BinaryFbx::Node* child = fbx.Child(shapeNode); child; child = fbx.Next(*child)) {
+        if ((child->Is("Indexes") || child->Is("Vertices") || child->Is("Normals")) && (child->NumProperties > 0)) {
+            const BinaryFbx::Property prop = fbx.GetProperty(*child, 0);
+            if (prop.IsArray()) {
+                outProps.push_back(prop);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::CollectClusterArrays(const BinaryFbx& fbx, const BinaryFbx::Node& clusterNode, std::vector<BinaryFbx::Property>& outProps) {
+    for (const BinaryFbx::Node* child = fbx.Child(clusterNode); child; child = fbx.Next(*child)) {
+        if ((child->Is("Indexes") || child->Is("Weights")) && (child->NumProperties > 0)) {
+            const BinaryFbx::Property prop = fbx.GetProperty(*child, 0);
+            if (prop.IsArray()) {
+                outProps.push_back(prop);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::CollectArrays(const BinaryFbx& fbx, const BinaryFbx::Node& geomNode, std::vector<BinaryFbx::Property>& outProps) {
+    for (const BinaryFbx::Node* child = fbx.Child(geomNode); child; child = fbx.Next(*child)) {
+        if (child->Is("Vertices") || child->Is("PolygonVertexIndex")) {
+            if (child->NumProperties > 0) {
+                outProps.push_back(fbx.GetProperty(*child, 0));
+            }
+            continue;
+        }
+        for (const auto& elm : nativeElements) {
+            if (child->Is(elm.element)) {
+                for (const BinaryFbx::Node* arrayNode = fbx.Child(*child); arrayNode; arrayNode = fbx.Next(*arrayNode)) {
+                    if ((arrayNode->NumProperties > 0) &&
+                        ((elm.direct && arrayNode->Is(elm.direct)) || arrayNode->Is(elm.index))) {
+                        const BinaryFbx::Property prop = fbx.GetProperty(*arrayNode, 0);
+                        if (prop.IsArray()) {
+                            outProps.push_back(prop);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::FingerprintElement(const Element& elm, Hasher& hasher) {
+    hasher.AddValue((std::int32_t) elm.Map);
+    hasher.AddValue((std::int32_t) elm.Stride);
+    hasher.AddValue((std::int32_t) elm.NumDirect);
+    if (elm.Direct) {
+        hasher.Add(elm.Direct, elm.NumDirect * elm.Stride * sizeof(double));
+    }
+    hasher.AddValue((std::int32_t) elm.NumIndex);
+    if (elm.Index) {
+        hasher.Add(elm.Index, elm.NumIndex * sizeof(std::int32_t));
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+MeshSource::Fingerprint(Hasher& hasher) const {
+    hasher.AddValue((std::int32_t) this->NumPoints);
+    hasher.AddValue((std::int32_t) this->PointStride);
+    hasher.Add(this->Points, this->NumPoints * this->PointStride * sizeof(double));
+    hasher.AddValue((std::int32_t) this->NumPolygonVertices);
+    hasher.Add(this->PolygonVertices, this->NumPolygonVertices * sizeof(std::int32_t));
+    hasher.AddValue((std::int32_t) this->PolygonStarts.size());
+    hasher.Add(this->PolygonStarts.data(), this->PolygonStarts.size() * sizeof(std::int32_t));
+    FingerprintElement(this->Normals, hasher);
+    FingerprintElement(this->Tangents, hasher);
+    FingerprintElement(this->Binormals, hasher);
+    FingerprintElement(this->Colors, hasher);
+    hasher.AddValue((std::int32_t) this->NumUVSets);
+    for (int i = 0; i < this->NumUVSets; i++) {
+        FingerprintElement(this->UVs[i], hasher);
+    }
+    FingerprintElement(this->Materials, hasher);
+    hasher.AddValue((std::int32_t) this->Clusters.size());
+    for (const Cluster& cluster : this->Clusters) {
+        hasher.AddValue((std::int32_t) cluster.Num);
+        if (cluster.Num > 0) {
+            hasher.Add(cluster.Indices, cluster.Num * sizeof(std::int32_t));
+            hasher.Add(cluster.Weights, cluster.Num * sizeof(double));
+        }
+    }
+    hasher.AddValue((std::int32_t) this->Shapes.size());
+    for (const Shape& shape : this->Shapes) {
+        hasher.AddValue((std::int32_t) shape.Num);
+        hasher.AddValue(nullptr != shape.Normals);
+        if (shape.Num > 0) {
+            hasher.Add(shape.Indices, shape.Num * sizeof(std::int32_t));
+            hasher.Add(shape.Positions, shape.Num * 3 * sizeof(double));
+            if (shape.Normals) {
+                hasher.Add(shape.Normals, shape.Num * 3 * sizeof(double));
+            }
+        }
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,144 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshSource
+    @brief raw, contiguous source arrays of a mesh
+
+    Describes the control points, polygon vertex indices and layer
+    elements of a mesh as plain arrays, either pointing into the locked
+    FbxMesh arrays (SDK reader), or into arrays decoded from a BinaryFbx
+    geometry record (native reader). This is the input to MeshExtractor.
+*/
+#include "BinaryFbx.h"
+#include "ArrayCache.h"
+#include "Hasher.h"
+#include <fbxsdk.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace FBXC {
+
+class MeshSource {
+public:
+    /// how a layer element maps onto the mesh surface
+    enum Mapping {
+        None,
+        ByControlPoint,
+        ByPolygonVertex,
+        ByPolygon,
+        AllSame,
+    };
+    /// a layer element
+    struct Element {
+        Mapping Map = None;
+        /// direct array, Stride doubles per element
+        const double* Direct = nullptr;
+        int NumDirect = 0;
+        int Stride = 0;
+        /// optional index array into the direct array
+        const std::int32_t* Index = nullptr;
+        int NumIndex = 0;
+    };
+    /// a skin cluster, the control points influenced by one joint
+    struct Cluster {
+        const std::int32_t* Indices = nullptr;
+        const double* Weights = nullptr;
+        int Num = 0;
+    };
+    /// a blend shape target, sparse control point deltas
+    struct Shape {
+        const std::int32_t* Indices = nullptr;
+        /// position deltas, 3 doubles per index
+        const double* Positions = nullptr;
+        /// normal deltas, 3 doubles per index, or nullptr
+        const double* Normals = nullptr;
+        int Num = 0;
+    };
+    /// max number of UV sets
+    static const int MaxUVSets = 4;
+
+    /// constructor
+    MeshSource();
+    /// destructor, releases locked SDK arrays
+    ~MeshSource();
+
+    /// setup from an FbxMesh
+    void Setup(FbxMesh* fbxMesh);
+    /// setup the blend shapes of an FbxMesh (after Setup(), computes the shape deltas)
+    void SetupShapes(FbxMesh* fbxMesh);
+    /// setup from a BinaryFbx geometry record
+    void Setup(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node& geomNode);
+    /// setup the skin clusters from BinaryFbx cluster records (after Setup())
+    void SetupSkin(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::vector<const BinaryFbx::Node*>& clusterNodes);
+    /// setup the blend shapes from BinaryFbx shape geometry records (after Setup(), nullptr for channels without shape)
+    void SetupShapes(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::vector<const BinaryFbx::Node*>& shapeNodes);
+    /// get the number of UV sets Setup() uses of an FbxMesh (UV set i is GetElementUV(i))
+    static int CountUVSets(FbxMesh* fbxMesh);
+    /// find the UV set records Setup() uses of a BinaryFbx geometry record, returns their number
+    static int FindUVSets(const BinaryFbx& fbx, const BinaryFbx::Node& geomNode, const BinaryFbx::Node* outNodes[MaxUVSets]);
+    /// collect the array properties of a BinaryFbx geometry record (for prefetching)
+    static void CollectArrays(const BinaryFbx& fbx, const BinaryFbx::Node& geomNode, std::vector<BinaryFbx::Property>& outProps);
+    /// collect the array properties of a BinaryFbx cluster record (for prefetching)
+    static void CollectClusterArrays(const BinaryFbx& fbx, const BinaryFbx::Node& clusterNode, std::vector<BinaryFbx::Property>& outProps);
+    /// collect the array properties of a BinaryFbx shape geometry record (for prefetching)
+    static void CollectShapeArrays(const BinaryFbx& fbx, const BinaryFbx::Node& shapeNode, std::vector<BinaryFbx::Property>& outProps);
+
+    /// get number of polygons
+    int NumPolygons() const;
+    /// add everything that MeshExtractor reads to a hash
+    void Fingerprint(Hasher& hasher) const;
+
+    /// control points, PointStride doubles per point
+    const double* Points = nullptr;
+    int NumPoints = 0;
+    int PointStride = 0;
+    /// polygon vertices (control point indices), may contain (-index - 1) end markers
+    const std::int32_t* PolygonVertices = nullptr;
+    int NumPolygonVertices = 0;
+    /// start of each polygon in PolygonVertices, plus one end entry
+    std::vector<std::int32_t> PolygonStarts;
+    /// layer elements
+    Element Normals;
+    Element Tangents;
+    Element Binormals;
+    Element Colors;
+    Element UVs[MaxUVSets];
+    int NumUVSets = 0;
+    /// per-polygon material indices (only Index is used)
+    Element Materials;
+    /// clusters of the first skin deformer, joint i of the mesh is Clusters[i]
+    std::vector<Cluster> Clusters;
+    /// full-weight target shape of each blend shape channel, in channel order
+    std::vector<Shape> Shapes;
+
+private:
+    MeshSource(const MeshSource&) = delete;
+    MeshSource& operator=(const MeshSource&) = delete;
+
+    /// setup an element from an FBX SDK layer element
+    template<typename TYPE> void SetupElement(const FbxLayerElementTemplate<TYPE>* fbxElm, int stride, Element& elm);
+    /// setup an element from a BinaryFbx layer element record
+    void SetupElement(const BinaryFbx& fbx, ArrayCache& arrayCache, const BinaryFbx::Node* elmNode,
+                      const char* directName, const char* indexName, int stride, Element& elm);
+    /// setup a blend shape from an FBX SDK shape (absolute control points and normals)
+    void SetupShape(FbxShape* fbxShape, Shape& shape);
+    /// add a layer element to a hash
+    static void FingerprintElement(const Element& elm, Hasher& hasher);
+    /// decode an array property into owned storage
+    const double* Decode(ArrayCache& arrayCache, const BinaryFbx::Property& prop);
+    /// decode an array property into owned storage
+    const std::int32_t* DecodeIndices(ArrayCache& arrayCache, const BinaryFbx::Property& prop);
+
+    std::vector<std::function<void()>> releasers;
+    std::vector<std::unique_ptr<std::vector<double>>> doubleArrays;
+    std::vector<std::unique_ptr<std::vector<std::int32_t>>> intArrays;
+};
+
+//------------------------------------------------------------------------------
+inline int
+MeshSource::NumPolygons() const {
+    return this->PolygonStarts.empty() ? 0 : (int) this->PolygonStarts.size() - 1;
+}
+
+} // namespace FBXC
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+//  MeshSplitter.cc
+//------------------------------------------------------------------------------
+#include "MeshSplitter.h"
+#include <cassert>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+void
+MeshSplitter::Split(const MeshData& data, int maxVertices, std::vector<MeshData>& outPieces) {
+    assert(maxVertices >= 3);
+    outPieces.clear();
+    const std::uint32_t unused = 0xFFFFFFFF;
+
+    // local index of a vertex in the current piece, pieceOf[] tells
+    // whether localIndex[] is valid for the current piece
+    std::vector<std::uint32_t> localIndex(data.NumVertices, unused);
+    std::vector<int> pieceOf(data.NumVertices, -1);
+    std::vector<std::uint32_t> pieceVertices;
+
+    // copy the vertices of the current piece and close it
+    auto finishPiece = [&data, &outPieces, &pieceVertices]() {
+        MeshData& piece = outPieces.back();
+        piece.NumVertices = (int) pieceVertices.size();
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            const MeshData::Component comp = (MeshData::Component) i;
+            if (data.Has(comp)) {
+                const int size = MeshData::ComponentSize(comp);
+                const float* src = data.Streams[comp].data();
+                std::vector<float>& dst = piece.Streams[comp];
+                dst.resize(pieceVertices.size() * size);
+                for (std::size_t v = 0; v < pieceVertices.size(); v++) {
+                    for (int c = 0; c < size; c++) {
+                        dst[v * size + c] = src[pieceVertices[v] * size + c];
+                    }
+                }
+            }
+        }
+        piece.PointIndices.resize(pieceVertices.size());
+        for (std::size_t v = 0; v < pieceVertices.size(); v++) {
+            piece.PointIndices[v] = data.PointIndices[pieceVertices[v]];
+        }
+        pieceVertices.clear();
+    };
+
+    for (const MeshData::Group& group : data.Groups) {
+        bool groupStarted = false;
+        for (int i = group.FirstIndex; i < group.FirstIndex + group.NumIndices; i += 3) {
+            const int pieceIndex = (int) outPieces.size() - 1;
+            int numNewVerts = 0;
+            for (int c = 0; c < 3; c++) {
+                const std::uint32_t v = data.Indices[i + c];
+                bool isNew = (pieceIndex < 0) || (pieceOf[v] != pieceIndex);
+                // a triangle may reference the same vertex twice (without welding)
+                for (int k = 0; k < c; k++) {
+                    if (data.Indices[i + k] == v) {
+                        isNew = false;
+                    }
+                }
+                if (isNew) {
+                    numNewVerts++;
+                }
+            }
+            if ((pieceIndex < 0) || (((int) pieceVertices.size() + numNewVerts) > maxVertices)) {
+                if (pieceIndex >= 0) {
+                    finishPiece();
+                }
+                outPieces.emplace_back();
+                groupStarted = false;
+            }
+            MeshData& piece = outPieces.back();
+            const int curPiece = (int) outPieces.size() - 1;
+            if (!groupStarted) {
+                MeshData::Group pieceGroup;
+                pieceGroup.Material = group.Material;
+                pieceGroup.FirstIndex = (int) piece.Indices.size();
+                piece.Groups.push_back(pieceGroup);
+                groupStarted = true;
+            }
+            for (int c = 0; c < 3; c++) {
+                const std::uint32_t v = data.Indices[i + c];
+                if (pieceOf[v] != curPiece) {
+                    pieceOf[v] = curPiece;
+                    localIndex[v] = (std::uint32_t) pieceVertices.size();
+                    pieceVertices.push_back(v);
+                }
+                piece.Indices.push_back(localIndex[v]);
+            }
+            piece.TriangleMaterials.push_back(data.TriangleMaterials[i / 3]);
+            piece.Groups.back().NumIndices += 3;
+        }
+    }
+    if (!outPieces.empty()) {
+        finishPiece();
+    }
+}
+
+} // namespace FBXC
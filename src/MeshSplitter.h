@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshSplitter
+    @brief split meshes into pieces which can be rendered with 16-bit indices
+
+    Triangles are assigned to pieces in their current order (after
+    cache optimization and material sorting), a new piece is started
+    when the next triangle would push the current piece over the vertex
+    limit. This keeps neighbouring triangles together, so the vertex
+    cache order survives the split. Vertices on piece borders are
+    duplicated.
+*/
+#include "MeshData.h"
+
+namespace FBXC {
+
+class MeshSplitter {
+public:
+    /// max number of vertices in a piece (index 0xFFFF is reserved for primitive restart)
+    static const int MaxVertices = 0xFFFF;
+
+    /// split mesh data into pieces with at most maxVertices vertices each
+    static void Split(const MeshData& data, int maxVertices, std::vector<MeshData>& outPieces);
+};
+
+} // namespace FBXC
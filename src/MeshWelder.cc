@@ -0,0 +1,193 @@
+//------------------------------------------------------------------------------
+//  MeshWelder.cc
+//------------------------------------------------------------------------------
+#include "MeshWelder.h"
+#include <cmath>
+#include <cstring>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+int
+MeshWelder::BuildKeys(const MeshData& data, float epsilon, std::vector<std::uint32_t>& outKeys) {
+    // exact mode uses the float bits (1 word per float), epsilon
+    // mode uses the 64-bit grid cell index (2 words per float)
+    const bool snap = epsilon > 0.0f;
+    const int wordsPerFloat = snap ? 2 : 1;
+    int numFloats = 0;
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        if (data.Has((MeshData::Component) i)) {
+            numFloats += MeshData::ComponentSize((MeshData::Component) i);
+        }
+    }
+    const bool hasWeldKeys = !data.WeldKeys.empty();
+    const int numWords = numFloats * wordsPerFloat + (hasWeldKeys ? 1 : 0);
+    const int numVerts = data.NumVertices;
+    outKeys.resize(numVerts * numWords);
+    const double invEpsilon = snap ? 1.0 / epsilon : 0.0;
+    // grid cells are in [-2^62, 2^62), which converts to int64 without overflow
+    const double maxCell = 4611686018427387904.0;
+    int wordOffset = 0;
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        const MeshData::Component comp = (MeshData::Component) i;
+        if (!data.Has(comp)) {
+            continue;
+        }
+        const int size = MeshData::ComponentSize(comp);
+        const float* src = data.Streams[comp].data();
+        std::uint32_t* dst = outKeys.data() + wordOffset;
+        if (snap) {
+            for (int v = 0; v < numVerts; v++, src += size, dst += numWords) {
+                for (int c = 0; c < size; c++) {
+                    const double scaled = std::floor(src[c] * invEpsilon + 0.5);
+                    if (std::isfinite(scaled) && (scaled >= -maxCell) && (scaled < maxCell)) {
+                        const std::int64_t cell = (std::int64_t) scaled;
+                        dst[c * 2 + 0] = (std::uint32_t) cell;
+                        dst[c * 2 + 1] = (std::uint32_t) ((std::uint64_t) cell >> 32);
+                    }
+                    else {
+                        // NaN, Inf or outside the grid, weld by exact float bits,
+                        // the high word can't be the high word of a grid cell
+                        const float f = src[c] + 0.0f;
+                        std::memcpy(&dst[c * 2 + 0], &f, sizeof(f));
+                        dst[c * 2 + 1] = 0x80000000;
+                    }
+                }
+            }
+        }
+        else {
+            for (int v = 0; v < numVerts; v++, src += size, dst += numWords) {
+                for (int c = 0; c < size; c++) {
+                    // adding 0.0f turns -0.0f into +0.0f
+                    const float f = src[c] + 0.0f;
+                    std::memcpy(&dst[c], &f, sizeof(f));
+                }
+            }
+        }
+        wordOffset += size * wordsPerFloat;
+    }
+    if (hasWeldKeys) {
+        for (int v = 0; v < numVerts; v++) {
+            outKeys[v * numWords + wordOffset] = data.WeldKeys[v];
+        }
+    }
+    return numWords;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshWelder::Weld(MeshData& data, float epsilon) {
+    const int numVerts = data.NumVertices;
+    if (0 == numVerts) {
+        return;
+    }
+    std::vector<std::uint32_t> keys;
+    const int numWords = BuildKeys(data, epsilon, keys);
+
+    // map each vertex to the first vertex with the same key
+    std::uint32_t capacity = 16;
+    while (capacity < (std::uint32_t) numVerts * 2) {
+        capacity <<= 1;
+    }
+    const std::uint32_t mask = capacity - 1;
+    const std::uint32_t empty = 0xFFFFFFFF;
+    std::vector<std::uint32_t> slots(capacity, empty);
+    std::vector<std::uint32_t> remap(numVerts);
+    for (int v = 0; v < numVerts; v++) {
+        const std::uint32_t* key = keys.data() + v * numWords;
+        std::uint32_t h = 2166136261u;
+        for (int w = 0; w < numWords; w++) {
+            h = (h ^ key[w]) * 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        std::uint32_t slot = h & mask;
+        for (;;) {
+            const std::uint32_t other = slots[slot];
+            if (empty == other) {
+                slots[slot] = v;
+                remap[v] = v;
+                break;
+            }
+            if (0 == std::memcmp(key, keys.data() + other * numWords, numWords * sizeof(std::uint32_t))) {
+                remap[v] = other;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    // drop collapsed and zero-area triangles
+    const float* pos = data.Streams[MeshData::Position].data();
+    const int numTris = data.NumTriangles();
+    int numKeptTris = 0;
+    for (int t = 0; t < numTris; t++) {
+        const std::uint32_t i0 = remap[data.Indices[t * 3 + 0]];
+        const std::uint32_t i1 = remap[data.Indices[t * 3 + 1]];
+        const std::uint32_t i2 = remap[data.Indices[t * 3 + 2]];
+        if ((i0 == i1) || (i1 == i2) || (i0 == i2)) {
+            continue;
+        }
+        const float* p0 = pos + i0 * 3;
+        const float* p1 = pos + i1 * 3;
+        const float* p2 = pos + i2 * 3;
+        const float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        const float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        const float cx = e0[1] * e1[2] - e0[2] * e1[1];
+        const float cy = e0[2] * e1[0] - e0[0] * e1[2];
+        const float cz = e0[0] * e1[1] - e0[1] * e1[0];
+        if ((cx * cx + cy * cy + cz * cz) <= 0.0f) {
+            continue;
+        }
+        data.Indices[numKeptTris * 3 + 0] = i0;
+        data.Indices[numKeptTris * 3 + 1] = i1;
+        data.Indices[numKeptTris * 3 + 2] = i2;
+        data.TriangleMaterials[numKeptTris] = data.TriangleMaterials[t];
+        numKeptTris++;
+    }
+    data.Indices.resize(numKeptTris * 3);
+    data.TriangleMaterials.resize(numKeptTris);
+
+    // compact the referenced vertices, keeping their original order
+    std::vector<std::uint32_t> newIndex(numVerts, empty);
+    for (std::uint32_t index : data.Indices) {
+        newIndex[index] = 0;
+    }
+    int numKeptVerts = 0;
+    for (int v = 0; v < numVerts; v++) {
+        if (empty != newIndex[v]) {
+            newIndex[v] = numKeptVerts++;
+        }
+    }
+    for (int i = 0; i < MeshData::NumComponents; i++) {
+        const MeshData::Component comp = (MeshData::Component) i;
+        if (!data.Has(comp)) {
+            continue;
+        }
+        const int size = MeshData::ComponentSize(comp);
+        float* stream = data.Streams[comp].data();
+        for (int v = 0; v < numVerts; v++) {
+            if (empty != newIndex[v]) {
+                // newIndex[v] <= v, so this can be done in place
+                std::memmove(stream + newIndex[v] * size, stream + v * size, size * sizeof(float));
+            }
+        }
+        data.Streams[comp].resize(numKeptVerts * size);
+    }
+    for (int v = 0; v < numVerts; v++) {
+        if (empty != newIndex[v]) {
+            data.PointIndices[newIndex[v]] = data.PointIndices[v];
+        }
+    }
+    data.PointIndices.resize(numKeptVerts);
+    data.WeldKeys.clear();
+    for (std::uint32_t& index : data.Indices) {
+        index = newIndex[index];
+    }
+    data.NumVertices = numKeptVerts;
+}
+
+} // namespace FBXC
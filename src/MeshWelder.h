@@ -0,0 +1,31 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::MeshWelder
+    @brief merge identical vertices and remove degenerate triangles
+
+    Vertices are compared by their raw component bytes (with -0.0 and
+    +0.0 treated as equal) through an open-addressing hash table. With
+    an epsilon > 0, components are snapped to an epsilon grid before
+    comparison, vertices in the same grid cell are merged (components
+    which are not finite or fall outside the grid are compared by their
+    bytes instead). If the mesh has weld keys, only vertices with the
+    same key are merged (the keys are cleared afterwards). Triangles
+    which collapse after welding or have zero area are dropped, and
+    vertices no longer referenced are removed.
+*/
+#include "MeshData.h"
+
+namespace FBXC {
+
+class MeshWelder {
+public:
+    /// weld vertices and remove degenerate triangles in place
+    static void Weld(MeshData& data, float epsilon);
+
+private:
+    /// build per-vertex comparison keys, returns number of 32-bit words per vertex
+    static int BuildKeys(const MeshData& data, float epsilon, std::vector<std::uint32_t>& outKeys);
+};
+
+} // namespace FBXC
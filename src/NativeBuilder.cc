@@ -0,0 +1,993 @@
+//------------------------------------------------------------------------------
+//  NativeBuilder.cc
+//------------------------------------------------------------------------------
+#include "NativeBuilder.h"
+#include "Log.h"
+#include "RuleMatcher.h"
+#include "MeshSource.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+/**
+    Lookup an enum string in a table indexed by the enum value, the tables
+    below are in the same order as the FBX SDK enums.
+*/
+template<int NUM> static const char*
+EnumToStr(const char* const (&table)[NUM], std::int32_t val) {
+    return ((val >= 0) && (val < NUM)) ? table[val] : "invalid";
+}
+
+static const char* const alphaSourceStrs[] = { "none", "rgbintensity", "black" };
+static const char* const mappingTypeStrs[] = { "null", "planar", "spherical", "cylindrical", "box", "face", "uv", "environment" };
+static const char* const pmnStrs[] = { "x", "y", "z" };
+static const char* const texUseStrs[] = { "standard", "shadowmap", "lightmap", "sphericalreflectionmap", "spherereflectionmap", "bumpnormalmap" };
+static const char* const wrapModeStrs[] = { "repeat", "clamp" };
+static const char* const blendModeStrs[] = { "translucent", "additive", "modulate", "modulate2", "over" };
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::Build(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::string& fbxPath, const Rules& rules, ProxyScene& outProxyScene) {
+    assert(fbx.IsOpen());
+    if (fbx.Version() < 7000) {
+        Log::Fatal("native reader requires FBX 7.x files (file version is %d)\n", fbx.Version());
+    }
+    NativeBuilder builder(fbx, arrayCache);
+    builder.Setup();
+    outProxyScene.Properties.Add("file", fbxPath);
+    builder.BuildMetaData(outProxyScene);
+
+    // resolve the nodes first, with rules only the objects reachable
+    // from included nodes are built
+    builder.BuildNodes(rules, outProxyScene);
+    if (!rules.Empty()) {
+        builder.CollectUsedObjects(outProxyScene);
+    }
+    builder.BuildTextures(outProxyScene);
+    builder.BuildMaterials(outProxyScene);
+    builder.BuildMeshes(outProxyScene);
+    builder.BuildAnimations(outProxyScene);
+}
+
+//------------------------------------------------------------------------------
+NativeBuilder::NativeBuilder(const BinaryFbx& fbx_, ArrayCache& arrayCache_) :
+    fbx(fbx_),
+    arrayCache(arrayCache_) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::Setup() {
+    const BinaryFbx::Node& root = this->fbx.Root();
+
+    // property templates, by object type
+    const BinaryFbx::Node* defs = this->fbx.Find(root, "Definitions");
+    if (defs) {
+        for (const BinaryFbx::Node* objType = this->fbx.Child(*defs); objType; objType = this->fbx.Next(*objType)) {
+            if (objType->Is("ObjectType") && (objType->NumProperties > 0)) {
+                const BinaryFbx::Node* tmpl = this->fbx.Find(*objType, "PropertyTemplate");
+                if (tmpl) {
+                    const BinaryFbx::Node* props70 = this->fbx.Find(*tmpl, "Properties70");
+                    if (props70) {
+                        this->templates[this->fbx.GetProperty(*objType, 0).ToString()] = props70;
+                    }
+                }
+            }
+        }
+    }
+
+    // objects, names are stored as 'name\x00\x01class'
+    const BinaryFbx::Node* objs = this->fbx.Find(root, "Objects");
+    if (objs) {
+        for (const BinaryFbx::Node* node = this->fbx.Child(*objs); node; node = this->fbx.Next(*node)) {
+            if (node->NumProperties < 3) {
+                continue;
+            }
+            Object obj;
+            obj.Node = node;
+            obj.Id = this->fbx.GetProperty(*node, 0).ToInt();
+            const BinaryFbx::Property nameProp = this->fbx.GetProperty(*node, 1);
+            const char* nameStr = (const char*) nameProp.Data;
+            obj.Name.assign(nameStr, std::find(nameStr, nameStr + nameProp.Size, '\0'));
+            obj.SubClass = this->fbx.GetProperty(*node, 2).ToString();
+            this->objectIndexById[obj.Id] = (int) this->objects.size();
+            this->objects.push_back(obj);
+        }
+    }
+
+    // connections, in file order
+    const BinaryFbx::Node* conns = this->fbx.Find(root, "Connections");
+    if (conns) {
+        for (const BinaryFbx::Node* node = this->fbx.Child(*conns); node; node = this->fbx.Next(*node)) {
+            if (!node->Is("C") || (node->NumProperties < 3)) {
+                continue;
+            }
+            Connection conn;
+            conn.Src = this->fbx.GetProperty(*node, 1).ToInt();
+            conn.Dst = this->fbx.GetProperty(*node, 2).ToInt();
+            if (node->NumProperties > 3) {
+                conn.Prop = this->fbx.GetProperty(*node, 3);
+            }
+            this->connectionsByDst[conn.Dst].push_back(conn);
+            if (0 == conn.Prop.Size) {
+                // only inserts the first connection of an object
+                this->firstDstBySrc.insert(std::make_pair(conn.Src, conn.Dst));
+            }
+            else {
+                this->propConnectionsBySrc[conn.Src].push_back(conn);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+const NativeBuilder::Object*
+NativeBuilder::LookupObject(std::int64_t id) const {
+    auto it = this->objectIndexById.find(id);
+    return it != this->objectIndexById.end() ? &this->objects[it->second] : nullptr;
+}
+
+//------------------------------------------------------------------------------
+const std::vector<NativeBuilder::Connection>*
+NativeBuilder::GetSrcConnections(std::int64_t id) const {
+    auto it = this->connectionsByDst.find(id);
+    return it != this->connectionsByDst.end() ? &it->second : nullptr;
+}
+
+//------------------------------------------------------------------------------
+const BinaryFbx::Node*
+NativeBuilder::FindProperty(const Object& obj, const char* name) const {
+    const std::size_t nameLen = std::strlen(name);
+    auto findIn = [this, name, nameLen](const BinaryFbx::Node* props70) -> const BinaryFbx::Node* {
+        for (const BinaryFbx::Node* p = this->fbx.Child(*props70); p; p = this->fbx.Next(*p)) {
+            if (p->Is("P") && (p->NumProperties >= 4)) {
+                const BinaryFbx::Property pName = this->fbx.GetProperty(*p, 0);
+                if ((pName.Size == nameLen) && (0 == std::memcmp(pName.Data, name, nameLen))) {
+                    return p;
+                }
+            }
+        }
+        return nullptr;
+    };
+    const BinaryFbx::Node* props70 = this->fbx.Find(*obj.Node, "Properties70");
+    const BinaryFbx::Node* p = props70 ? findIn(props70) : nullptr;
+    if (nullptr == p) {
+        std::string objType(obj.Node->Name, obj.Node->NameLength);
+        auto it = this->templates.find(objType);
+        if (it != this->templates.end()) {
+            p = findIn(it->second);
+        }
+    }
+    return p;
+}
+
+//------------------------------------------------------------------------------
+bool
+NativeBuilder::GetBool(const Object& obj, const char* name, bool defVal) const {
+    const BinaryFbx::Node* p = this->FindProperty(obj, name);
+    return (p && (p->NumProperties > 4)) ? this->fbx.GetProperty(*p, 4).ToInt() != 0 : defVal;
+}
+
+//------------------------------------------------------------------------------
+std::int32_t
+NativeBuilder::GetInt(const Object& obj, const char* name, std::int32_t defVal) const {
+    const BinaryFbx::Node* p = this->FindProperty(obj, name);
+    return (p && (p->NumProperties > 4)) ? (std::int32_t) this->fbx.GetProperty(*p, 4).ToInt() : defVal;
+}
+
+//------------------------------------------------------------------------------
+double
+NativeBuilder::GetDouble(const Object& obj, const char* name, double defVal) const {
+    const BinaryFbx::Node* p = this->FindProperty(obj, name);
+    return (p && (p->NumProperties > 4)) ? this->fbx.GetProperty(*p, 4).ToDouble() : defVal;
+}
+
+//------------------------------------------------------------------------------
+FbxDouble3
+NativeBuilder::GetDouble3(const Object& obj, const char* name, const FbxDouble3& defVal) const {
+    const BinaryFbx::Node* p = this->FindProperty(obj, name);
+    if (p && (p->NumProperties > 6)) {
+        return FbxDouble3(this->fbx.GetProperty(*p, 4).ToDouble(),
+                          this->fbx.GetProperty(*p, 5).ToDouble(),
+                          this->fbx.GetProperty(*p, 6).ToDouble());
+    }
+    return defVal;
+}
+
+//------------------------------------------------------------------------------
+std::string
+NativeBuilder::GetString(const Object& obj, const char* name, const char* defVal) const {
+    const BinaryFbx::Node* p = this->FindProperty(obj, name);
+    return (p && (p->NumProperties > 4)) ? this->fbx.GetProperty(*p, 4).ToString() : std::string(defVal);
+}
+
+//------------------------------------------------------------------------------
+std::string
+NativeBuilder::GetChildString(const BinaryFbx::Node& node, const char* name) const {
+    const BinaryFbx::Node* child = this->fbx.Find(node, name);
+    return (child && (child->NumProperties > 0)) ? this->fbx.GetProperty(*child, 0).ToString() : std::string();
+}
+
+//------------------------------------------------------------------------------
+bool
+NativeBuilder::GetChildArray(const BinaryFbx::Node& node, const char* name, BinaryFbx::Property& outProp) const {
+    const BinaryFbx::Node* child = this->fbx.Find(node, name);
+    if (child && (child->NumProperties > 0)) {
+        outProp = this->fbx.GetProperty(*child, 0);
+        return outProp.IsArray();
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+NativeBuilder::GetChildMatrix(const BinaryFbx::Node& node, const char* name) const {
+    BinaryFbx::Property prop;
+    if (this->GetChildArray(node, name, prop) && (prop.ArrayLength == 16)) {
+        std::vector<double> values;
+        this->arrayCache.Read(prop, values);
+        return Matrix44(values.data());
+    }
+    return Matrix44();
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildMetaData(ProxyScene& scene) const {
+    const BinaryFbx::Node* metaData = nullptr;
+    const BinaryFbx::Node* headerExt = this->fbx.Find(this->fbx.Root(), "FBXHeaderExtension");
+    if (headerExt) {
+        const BinaryFbx::Node* sceneInfo = this->fbx.Find(*headerExt, "SceneInfo");
+        if (sceneInfo) {
+            metaData = this->fbx.Find(*sceneInfo, "MetaData");
+        }
+    }
+    if (!metaData) {
+        Log::Fatal("failed to get scene info from FBX file\n");
+    }
+    scene.Properties.Add("title", this->GetChildString(*metaData, "Title"));
+    scene.Properties.Add("subject", this->GetChildString(*metaData, "Subject"));
+    scene.Properties.Add("author", this->GetChildString(*metaData, "Author"));
+    scene.Properties.Add("keywords", this->GetChildString(*metaData, "Keywords"));
+    scene.Properties.Add("revision", this->GetChildString(*metaData, "Revision"));
+    scene.Properties.Add("comment", this->GetChildString(*metaData, "Comment"));
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildUserProperties(const Object& obj, ProxyObject& proxyObj) const {
+    const BinaryFbx::Node* props70 = this->fbx.Find(*obj.Node, "Properties70");
+    if (!props70) {
+        return;
+    }
+    for (const BinaryFbx::Node* p = this->fbx.Child(*props70); p; p = this->fbx.Next(*p)) {
+        if (!p->Is("P") || (p->NumProperties < 5)) {
+            continue;
+        }
+        const std::string flags = this->fbx.GetProperty(*p, 3).ToString();
+        if (flags.find('U') == std::string::npos) {
+            continue;
+        }
+        const std::string name = this->fbx.GetProperty(*p, 0).ToString();
+        const std::string type = this->fbx.GetProperty(*p, 1).ToString();
+        const std::uint32_t numVals = p->NumProperties - 4;
+        if ((type == "int") || (type == "Integer") || (type == "enum") || (type == "short") ||
+            (type == "ushort") || (type == "uint") || (type == "char") || (type == "uchar")) {
+            proxyObj.UserProperties.Add(name, (std::int32_t) this->fbx.GetProperty(*p, 4).ToInt());
+        }
+        else if ((type == "bool") || (type == "Bool")) {
+            proxyObj.UserProperties.Add(name, this->fbx.GetProperty(*p, 4).ToInt() != 0);
+        }
+        else if ((type == "double") || (type == "Number") || (type == "float") ||
+                 (type == "Float") || (type == "HalfFloat")) {
+            proxyObj.UserProperties.Add(name, this->fbx.GetProperty(*p, 4).ToDouble());
+        }
+        else if (((type == "Vector2D") || (type == "Vector2")) && (numVals >= 2)) {
+            proxyObj.UserProperties.Add(name, FbxDouble2(this->fbx.GetProperty(*p, 4).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 5).ToDouble()));
+        }
+        else if (((type == "Vector") || (type == "Vector3D") || (type == "Color") || (type == "ColorRGB")) && (numVals >= 3)) {
+            proxyObj.UserProperties.Add(name, FbxDouble3(this->fbx.GetProperty(*p, 4).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 5).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 6).ToDouble()));
+        }
+        else if (((type == "Vector4D") || (type == "ColorAndAlpha")) && (numVals >= 4)) {
+            proxyObj.UserProperties.Add(name, FbxDouble4(this->fbx.GetProperty(*p, 4).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 5).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 6).ToDouble(),
+                                                         this->fbx.GetProperty(*p, 7).ToDouble()));
+        }
+        else if ((type == "KString") || (type == "String")) {
+            proxyObj.UserProperties.Add(name, this->fbx.GetProperty(*p, 4).ToString());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::GetMeshMaterials(const Object& meshObj, std::vector<const Object*>& outMaterials) const {
+    auto ownerIt = this->firstDstBySrc.find(meshObj.Id);
+    const Object* modelObj = (ownerIt != this->firstDstBySrc.end()) ? this->LookupObject(ownerIt->second) : nullptr;
+    const std::vector<Connection>* modelConns = modelObj ? this->GetSrcConnections(modelObj->Id) : nullptr;
+    if (modelConns && modelObj->Node->Is("Model")) {
+        for (const Connection& conn : *modelConns) {
+            const Object* srcObj = this->LookupObject(conn.Src);
+            if ((0 == conn.Prop.Size) && srcObj && srcObj->Node->Is("Material")) {
+                outMaterials.push_back(srcObj);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::CollectUsedObjects(const ProxyScene& scene) {
+    this->filterUsed = true;
+    this->usedIds.clear();
+    std::vector<const Object*> materialObjs;
+    for (const ProxyNode& node : scene.Nodes) {
+        if (!node.Properties.Contains("meshes")) {
+            continue;
+        }
+        for (const Value& meshId : node.Properties["meshes"].GetArray()) {
+            const Object* meshObj = this->LookupObject((std::int64_t) meshId.Get<std::uint64_t>());
+            if (!meshObj || !this->usedIds.insert(meshObj->Id).second) {
+                continue;
+            }
+            materialObjs.clear();
+            this->GetMeshMaterials(*meshObj, materialObjs);
+            for (const Object* materialObj : materialObjs) {
+                if (!this->usedIds.insert(materialObj->Id).second) {
+                    continue;
+                }
+                // textures connected to any material property, including
+                // the textures inside layered textures
+                const std::vector<Connection>* matConns = this->GetSrcConnections(materialObj->Id);
+                if (!matConns) {
+                    continue;
+                }
+                for (const Connection& conn : *matConns) {
+                    const Object* texObj = this->LookupObject(conn.Src);
+                    if ((0 == conn.Prop.Size) || !texObj) {
+                        continue;
+                    }
+                    if (texObj->Node->Is("Texture")) {
+                        this->usedIds.insert(texObj->Id);
+                    }
+                    else if (texObj->Node->Is("LayeredTexture")) {
+                        this->usedIds.insert(texObj->Id);
+                        const std::vector<Connection>* layerConns = this->GetSrcConnections(texObj->Id);
+                        if (layerConns) {
+                            for (const Connection& layerConn : *layerConns) {
+                                const Object* layerObj = this->LookupObject(layerConn.Src);
+                                if (layerObj && layerObj->Node->Is("Texture")) {
+                                    this->usedIds.insert(layerObj->Id);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+NativeBuilder::IsUsed(const Object& obj) const {
+    return !this->filterUsed || (0 != this->usedIds.count(obj.Id));
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildTextures(ProxyScene& scene) const {
+    for (const Object& obj : this->objects) {
+        if (!obj.Node->Is("Texture") || !this->IsUsed(obj)) {
+            continue;
+        }
+        scene.Textures.emplace_back();
+        ProxyObject& tex = scene.Textures.back();
+        tex.Properties.Add("name", obj.Name);
+        tex.Properties.Add("id", (std::uint64_t) obj.Id);
+
+        if (this->fbx.Find(*obj.Node, "RelativeFilename") || this->fbx.Find(*obj.Node, "FileName")) {
+            tex.Properties.Add("type", "file");
+            const bool useMaterial = this->GetBool(obj, "UseMaterial", false);
+            tex.Properties.Add("usematerial", useMaterial);
+            tex.Properties.Add("usemipmap", this->GetBool(obj, "UseMipMap", false));
+            tex.Properties.Add("filename", this->GetChildString(*obj.Node, "RelativeFilename"));
+            tex.Properties.Add("materialuse", useMaterial ? "default" : "model");
+        }
+        else {
+            tex.Properties.Add("type", "procedural");
+        }
+        tex.Properties.Add("swapuv", this->GetBool(obj, "UVSwap", false));
+        tex.Properties.Add("premultiplyalpha", this->GetBool(obj, "PremultiplyAlpha", true));
+        const std::string alphaSource = this->GetChildString(*obj.Node, "Texture_Alpha_Source");
+        std::int32_t alphaSourceVal = 0;
+        if (alphaSource == "RGB_Intensity") {
+            alphaSourceVal = 1;
+        }
+        else if (alphaSource == "Alpha_Black") {
+            alphaSourceVal = 2;
+        }
+        tex.Properties.Add("alphasource", EnumToStr(alphaSourceStrs, alphaSourceVal));
+        std::int32_t cropping[4] = { 0, 0, 0, 0 };
+        const BinaryFbx::Node* croppingNode = this->fbx.Find(*obj.Node, "Cropping");
+        if (croppingNode) {
+            for (std::uint32_t i = 0; (i < 4) && (i < croppingNode->NumProperties); i++) {
+                cropping[i] = (std::int32_t) this->fbx.GetProperty(*croppingNode, i).ToInt();
+            }
+        }
+        tex.Properties.Add("croppingleft", cropping[0]);
+        tex.Properties.Add("croppingtop", cropping[1]);
+        tex.Properties.Add("croppingright", cropping[2]);
+        tex.Properties.Add("croppingbottom", cropping[3]);
+        tex.Properties.Add("mappingtype", EnumToStr(mappingTypeStrs, this->GetInt(obj, "CurrentMappingType", 0)));
+        tex.Properties.Add("planarmappingnormal", EnumToStr(pmnStrs, this->GetInt(obj, "PlanarMappingNormal", 0)));
+        tex.Properties.Add("textureuse", EnumToStr(texUseStrs, this->GetInt(obj, "TextureTypeUse", 0)));
+        tex.Properties.Add("wrapmodeu", EnumToStr(wrapModeStrs, this->GetInt(obj, "WrapModeU", 0)));
+        tex.Properties.Add("wrapmodev", EnumToStr(wrapModeStrs, this->GetInt(obj, "WrapModeV", 0)));
+        tex.Properties.Add("blendmode", EnumToStr(blendModeStrs, this->GetInt(obj, "CurrentTextureBlendMode", 1)));
+        tex.Properties.Add("alpha", this->GetDouble(obj, "Texture alpha", 1.0));
+        tex.Properties.Add("translation", this->GetDouble3(obj, "Translation", FbxDouble3(0.0, 0.0, 0.0)));
+        tex.Properties.Add("rotation", this->GetDouble3(obj, "Rotation", FbxDouble3(0.0, 0.0, 0.0)));
+        tex.Properties.Add("scaling", this->GetDouble3(obj, "Scaling", FbxDouble3(1.0, 1.0, 1.0)));
+        tex.Properties.Add("rotationpivot", this->GetDouble3(obj, "TextureRotationPivot", FbxDouble3(0.0, 0.0, 0.0)));
+        tex.Properties.Add("scalingpivot", this->GetDouble3(obj, "TextureScalingPivot", FbxDouble3(0.0, 0.0, 0.0)));
+        tex.Properties.Add("uvset", this->GetString(obj, "UVSet", "default"));
+
+        this->BuildUserProperties(obj, tex);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+NativeBuilder::BuildPropertyConnection(const Object& obj, const char* fbxPropName, const char* name, PropertyMap& props) const {
+    const std::vector<Connection>* conns = this->GetSrcConnections(obj.Id);
+    if (conns) {
+        const std::size_t propNameLen = std::strlen(fbxPropName);
+        for (const Connection& conn : *conns) {
+            if ((conn.Prop.Size == propNameLen) && (0 == std::memcmp(conn.Prop.Data, fbxPropName, propNameLen))) {
+                const Object* srcObj = this->LookupObject(conn.Src);
+                if (srcObj && (srcObj->Node->Is("Texture") || srcObj->Node->Is("LayeredTexture"))) {
+                    props.Add(name, srcObj->Name);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildMaterials(ProxyScene& scene) const {
+    const FbxDouble3 black(0.0, 0.0, 0.0);
+    for (const Object& obj : this->objects) {
+        if (!obj.Node->Is("Material") || !this->IsUsed(obj)) {
+            continue;
+        }
+        scene.Materials.emplace_back();
+        ProxyObject& mat = scene.Materials.back();
+        mat.Properties.Add("name", obj.Name);
+        mat.Properties.Add("id", (std::uint64_t) obj.Id);
+        std::string shadingModel = this->GetChildString(*obj.Node, "ShadingModel");
+        if (shadingModel.empty()) {
+            shadingModel = this->GetString(obj, "ShadingModel", "lambert");
+        }
+        std::transform(shadingModel.begin(), shadingModel.end(), shadingModel.begin(), ::tolower);
+        mat.Properties.Add("shadingmodel", shadingModel);
+        const BinaryFbx::Node* multiLayer = this->fbx.Find(*obj.Node, "MultiLayer");
+        if (multiLayer && (multiLayer->NumProperties > 0)) {
+            mat.Properties.Add("multilayer", this->fbx.GetProperty(*multiLayer, 0).ToInt() != 0);
+        }
+        else {
+            mat.Properties.Add("multilayer", this->GetBool(obj, "MultiLayer", false));
+        }
+
+        // NOTE: hardware shader implementations are not detected by the native reader
+        const bool isPhong = shadingModel == "phong";
+        const bool isLambert = isPhong || (shadingModel == "lambert");
+        if (isLambert) {
+            mat.Properties.Add("emissive", this->GetDouble3(obj, "EmissiveColor", black));
+            mat.Properties.Add("emissivefactor", this->GetDouble(obj, "EmissiveFactor", 1.0));
+            mat.Properties.Add("ambient", this->GetDouble3(obj, "AmbientColor", FbxDouble3(0.2, 0.2, 0.2)));
+            mat.Properties.Add("ambientfactor", this->GetDouble(obj, "AmbientFactor", 1.0));
+            mat.Properties.Add("diffuse", this->GetDouble3(obj, "DiffuseColor", FbxDouble3(0.8, 0.8, 0.8)));
+            mat.Properties.Add("diffusefactor", this->GetDouble(obj, "DiffuseFactor", 1.0));
+            mat.Properties.Add("normalmap", this->GetDouble3(obj, "NormalMap", black));
+            mat.Properties.Add("bump", this->GetDouble3(obj, "Bump", black));
+            mat.Properties.Add("bumpfactor", this->GetDouble(obj, "BumpFactor", 1.0));
+            mat.Properties.Add("transparentcolor", this->GetDouble3(obj, "TransparentColor", black));
+            mat.Properties.Add("transparencyfactor", this->GetDouble(obj, "TransparencyFactor", 0.0));
+            mat.Properties.Add("displacementcolor", this->GetDouble3(obj, "DisplacementColor", black));
+            mat.Properties.Add("displacementfactor", this->GetDouble(obj, "DisplacementFactor", 1.0));
+            mat.Properties.Add("vectordisplacementcolor", this->GetDouble3(obj, "VectorDisplacementColor", black));
+            mat.Properties.Add("vectordisplacementfactor", this->GetDouble(obj, "VectorDisplacementFactor", 1.0));
+
+            // texture connections
+            this->BuildPropertyConnection(obj, "EmissiveColor", "emissive_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "AmbientColor", "ambient_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "DiffuseColor", "diffuse_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "NormalMap", "normalmap_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "Bump", "bump_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "TransparentColor", "transparentcolor_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "DisplacementColor", "displacementcolor_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "VectorDisplacementColor", "vectordisplacementcolor_texture", mat.Properties);
+        }
+        if (isPhong) {
+            mat.Properties.Add("specular", this->GetDouble3(obj, "SpecularColor", FbxDouble3(0.2, 0.2, 0.2)));
+            mat.Properties.Add("specularfactor", this->GetDouble(obj, "SpecularFactor", 1.0));
+            mat.Properties.Add("shininess", this->GetDouble(obj, "ShininessExponent", 20.0));
+            mat.Properties.Add("reflection", this->GetDouble3(obj, "ReflectionColor", black));
+            mat.Properties.Add("reflectionfactor", this->GetDouble(obj, "ReflectionFactor", 1.0));
+
+            // texture connections
+            this->BuildPropertyConnection(obj, "SpecularColor", "specular_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "ShininessExponent", "shininess_texture", mat.Properties);
+            this->BuildPropertyConnection(obj, "ReflectionColor", "reflection_texture", mat.Properties);
+        }
+        this->BuildUserProperties(obj, mat);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildMeshes(ProxyScene& scene) const {
+
+    // polygon counts need the index arrays, inflate those up front in
+    // parallel, vertex payload arrays are left untouched
+    std::vector<const Object*> meshObjs;
+    std::vector<BinaryFbx::Property> indexArrays;
+    for (const Object& obj : this->objects) {
+        if (obj.Node->Is("Geometry") && (obj.SubClass == "Mesh") && this->IsUsed(obj)) {
+            meshObjs.push_back(&obj);
+            BinaryFbx::Property prop;
+            if (this->GetChildArray(*obj.Node, "PolygonVertexIndex", prop)) {
+                indexArrays.push_back(prop);
+            }
+        }
+    }
+    this->arrayCache.Prefetch(indexArrays);
+
+    std::vector<const Object*> materialObjs;
+    for (const Object* meshObj : meshObjs) {
+        const Object& obj = *meshObj;
+        scene.Meshes.emplace_back();
+        ProxyMesh& mesh = scene.Meshes.back();
+        mesh.GeomNode = obj.Node;
+
+        // NOTE: meshes don't have names, so use unique id as identifier
+        mesh.Properties.Add("id", (std::uint64_t) obj.Id);
+        BinaryFbx::Property prop;
+        std::int32_t numPoints = 0;
+        if (this->GetChildArray(*obj.Node, "Vertices", prop)) {
+            numPoints = (std::int32_t) (prop.ArrayLength / 3);
+        }
+        mesh.Properties.Add("numpoints", numPoints);
+        std::int32_t numPolygons = 0;
+        if (this->GetChildArray(*obj.Node, "PolygonVertexIndex", prop)) {
+            // the last index of each polygon is stored as (-index - 1)
+            std::vector<std::int32_t> indices;
+            this->arrayCache.Read(prop, indices);
+            numPolygons = (std::int32_t) std::count_if(indices.begin(), indices.end(),
+                                                       [](std::int32_t i) { return i < 0; });
+        }
+        mesh.Properties.Add("numpolygons", numPolygons);
+
+        // layer elements referenced by layer 0
+        std::vector<std::string> layerElements;
+        for (const BinaryFbx::Node* layer = this->fbx.Child(*obj.Node); layer; layer = this->fbx.Next(*layer)) {
+            if (layer->Is("Layer") && (layer->NumProperties > 0) && (0 == this->fbx.GetProperty(*layer, 0).ToInt())) {
+                for (const BinaryFbx::Node* elm = this->fbx.Child(*layer); elm; elm = this->fbx.Next(*elm)) {
+                    if (elm->Is("LayerElement")) {
+                        layerElements.push_back(this->GetChildString(*elm, "Type"));
+                    }
+                }
+                break;
+            }
+        }
+        auto hasElement = [&layerElements](const char* type) {
+            for (const std::string& elm : layerElements) {
+                if (elm == type) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        mesh.Properties.Add("hasnormals", hasElement("LayerElementNormal"));
+        mesh.Properties.Add("hastangents", hasElement("LayerElementTangent"));
+        mesh.Properties.Add("hasbinormals", hasElement("LayerElementBinormal"));
+        mesh.Properties.Add("hasmaterials", hasElement("LayerElementMaterial"));
+        mesh.Properties.Add("haspolygongroups", hasElement("LayerElementPolygonGroup"));
+        mesh.Properties.Add("hasvertexcolor", hasElement("LayerElementColor"));
+        mesh.Properties.Add("hasuserdata", hasElement("LayerElementUserData"));
+        mesh.Properties.Add("hasvisibility", hasElement("LayerElementVisibility"));
+        // the UV sets which MeshSource extracts into the texcoord streams
+        const BinaryFbx::Node* uvNodes[MeshSource::MaxUVSets];
+        const int numUVSets = MeshSource::FindUVSets(this->fbx, *obj.Node, uvNodes);
+        std::vector<Value> uvSets;
+        for (int i = 0; i < numUVSets; i++) {
+            Value val;
+            val.Set(this->GetChildString(*uvNodes[i], "Name"));
+            uvSets.push_back(std::move(val));
+        }
+        if (uvSets.size() > 0) {
+            mesh.Properties.Add("uvsets", std::move(uvSets));
+        }
+
+        // materials of the first node using the mesh, the per-polygon
+        // material indices of the mesh index into this list
+        materialObjs.clear();
+        this->GetMeshMaterials(obj, materialObjs);
+        if (materialObjs.size() > 0) {
+            std::vector<Value> materialIds;
+            for (const Object* materialObj : materialObjs) {
+                Value val;
+                val.Set((std::uint64_t) materialObj->Id);
+                materialIds.push_back(std::move(val));
+            }
+            mesh.Properties.Add("materials", std::move(materialIds));
+        }
+        this->BuildUserProperties(obj, mesh);
+        this->BuildSkin(obj, mesh);
+        this->BuildShapes(obj, mesh);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildSkin(const Object& meshObj, ProxyMesh& mesh) const {
+    // the first Skin deformer connected to the geometry, its clusters in
+    // connection order are the joints (same order as the FBX SDK)
+    const std::vector<Connection>* meshConns = this->GetSrcConnections(meshObj.Id);
+    if (!meshConns) {
+        return;
+    }
+    const Object* skinObj = nullptr;
+    for (const Connection& conn : *meshConns) {
+        const Object* obj = this->LookupObject(conn.Src);
+        if (obj && obj->Node->Is("Deformer") && (obj->SubClass == "Skin")) {
+            skinObj = obj;
+            break;
+        }
+    }
+    const std::vector<Connection>* skinConns = skinObj ? this->GetSrcConnections(skinObj->Id) : nullptr;
+    if (!skinConns) {
+        return;
+    }
+    for (const Connection& conn : *skinConns) {
+        const Object* clusterObj = this->LookupObject(conn.Src);
+        if (!clusterObj || !clusterObj->Node->Is("Deformer") || (clusterObj->SubClass != "Cluster")) {
+            continue;
+        }
+        std::int64_t linkId = 0;
+        const std::vector<Connection>* clusterConns = this->GetSrcConnections(clusterObj->Id);
+        if (clusterConns) {
+            for (const Connection& linkConn : *clusterConns) {
+                const Object* linkObj = this->LookupObject(linkConn.Src);
+                if (linkObj && linkObj->Node->Is("Model")) {
+                    linkId = linkObj->Id;
+                    break;
+                }
+            }
+        }
+        mesh.ClusterNodes.push_back(clusterObj->Node);
+        Value jointId;
+        jointId.Set((std::uint64_t) linkId);
+        mesh.Joints.push_back(jointId);
+        const Matrix44 meshBind = this->GetChildMatrix(*clusterObj->Node, "Transform");
+        const Matrix44 jointBind = this->GetChildMatrix(*clusterObj->Node, "TransformLink");
+        mesh.InverseBindMatrices.push_back(jointBind.Inverse() * meshBind);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildShapes(const Object& meshObj, ProxyMesh& mesh) const {
+    // BlendShape deformers of the geometry, their BlendShapeChannel sub
+    // deformers and the Shape geometries of each channel, in connection
+    // order, the last shape of a channel is the full-weight shape
+    const std::vector<Connection>* meshConns = this->GetSrcConnections(meshObj.Id);
+    if (!meshConns) {
+        return;
+    }
+    for (const Connection& conn : *meshConns) {
+        const Object* blendShapeObj = this->LookupObject(conn.Src);
+        if (!blendShapeObj || !blendShapeObj->Node->Is("Deformer") || (blendShapeObj->SubClass != "BlendShape")) {
+            continue;
+        }
+        const std::vector<Connection>* blendShapeConns = this->GetSrcConnections(blendShapeObj->Id);
+        if (!blendShapeConns) {
+            continue;
+        }
+        for (const Connection& channelConn : *blendShapeConns) {
+            const Object* channelObj = this->LookupObject(channelConn.Src);
+            if (!channelObj || !channelObj->Node->Is("Deformer") || (channelObj->SubClass != "BlendShapeChannel")) {
+                continue;
+            }
+            const BinaryFbx::Node* shapeNode = nullptr;
+            const std::vector<Connection>* channelConns = this->GetSrcConnections(channelObj->Id);
+            if (channelConns) {
+                for (const Connection& shapeConn : *channelConns) {
+                    const Object* shapeObj = this->LookupObject(shapeConn.Src);
+                    if (shapeObj && shapeObj->Node->Is("Geometry") && (shapeObj->SubClass == "Shape")) {
+                        shapeNode = shapeObj->Node;
+                    }
+                }
+            }
+            mesh.ShapeNodes.push_back(shapeNode);
+            Value name;
+            name.Set(channelObj->Name);
+            mesh.ShapeNames.push_back(std::move(name));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static Matrix44
+translation(const FbxDouble3& t) {
+    return Matrix44::Translation(t[0], t[1], t[2]);
+}
+
+//------------------------------------------------------------------------------
+NodeTransform
+NativeBuilder::GetNodeTransform(const Object& obj) const {
+    const FbxDouble3 zero(0.0, 0.0, 0.0);
+    NodeTransform transform;
+    transform.Setup(this->GetDouble3(obj, "RotationOffset", zero),
+                    this->GetDouble3(obj, "RotationPivot", zero),
+                    this->GetDouble3(obj, "PreRotation", zero),
+                    this->GetDouble3(obj, "PostRotation", zero),
+                    this->GetDouble3(obj, "ScalingOffset", zero),
+                    this->GetDouble3(obj, "ScalingPivot", zero),
+                    this->GetBool(obj, "RotationActive", false),
+                    this->GetInt(obj, "RotationOrder", 0));
+    transform.Translation = this->GetDouble3(obj, "Lcl Translation", zero);
+    transform.Rotation = this->GetDouble3(obj, "Lcl Rotation", zero);
+    transform.Scaling = this->GetDouble3(obj, "Lcl Scaling", FbxDouble3(1.0, 1.0, 1.0));
+    return transform;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+NativeBuilder::GetGeometricTransform(const Object& obj) const {
+    const FbxDouble3 zero(0.0, 0.0, 0.0);
+    const FbxDouble3 t = this->GetDouble3(obj, "GeometricTranslation", zero);
+    const FbxDouble3 r = this->GetDouble3(obj, "GeometricRotation", zero);
+    const FbxDouble3 s = this->GetDouble3(obj, "GeometricScaling", FbxDouble3(1.0, 1.0, 1.0));
+    return translation(t) * Matrix44::Rotation(r[0], r[1], r[2], Matrix44::EulerXYZ) * Matrix44::Scaling(s[0], s[1], s[2]);
+}
+
+//------------------------------------------------------------------------------
+std::string
+NativeBuilder::GetNodeTypeName(const Object& obj) {
+    // same names as ProxyBuilder, which uses the FBX SDK node attribute types
+    if ((obj.SubClass == "LimbNode") || (obj.SubClass == "Limb") || (obj.SubClass == "Root")) {
+        return "skeleton";
+    }
+    std::string name = obj.SubClass;
+    for (char& c : name) {
+        c = (char) std::tolower((unsigned char) c);
+    }
+    return name;
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildNodes(const Rules& rules, ProxyScene& scene) const {
+
+    // depth-first walk, each entry carries the proxy node the Model object
+    // attaches to (its nearest included ancestor), its rule matcher
+    // state and the world transform of its parent object, excluded nodes
+    // only get their user properties and transform extracted (for the
+    // rule predicates and their descendants), the root node (no object)
+    // is always included
+    struct Visit {
+        const Object* Obj;
+        int Parent;
+        RuleMatcher::State State;
+        int ParentWorld;
+    };
+    std::size_t numModels = 1;
+    for (const Object& obj : this->objects) {
+        if (obj.Node->Is("Model")) {
+            numModels++;
+        }
+    }
+    RuleMatcher matcher(rules);
+    scene.Nodes.reserve(numModels);
+    std::vector<int> lastChild;
+    std::vector<Matrix44> worlds;
+    std::vector<Visit> stack;
+    stack.push_back(Visit{ nullptr, ProxyNode::InvalidIndex, matcher.Root(), -1 });
+    std::vector<const Object*> children;
+    std::vector<Value> meshUniqueIds;
+    while (!stack.empty()) {
+        const Visit visit = stack.back();
+        stack.pop_back();
+        const Object* obj = visit.Obj;
+
+        // meshes and child nodes connected to this node
+        std::int64_t id = obj ? obj->Id : 0;
+        children.clear();
+        meshUniqueIds.clear();
+        const std::vector<Connection>* conns = this->GetSrcConnections(id);
+        if (conns) {
+            for (const Connection& conn : *conns) {
+                if (0 != conn.Prop.Size) {
+                    continue;
+                }
+                const Object* srcObj = this->LookupObject(conn.Src);
+                if (srcObj) {
+                    if (srcObj->Node->Is("Model")) {
+                        children.push_back(srcObj);
+                    }
+                    else if (obj && srcObj->Node->Is("Geometry") && (srcObj->SubClass == "Mesh")) {
+                        Value val;
+                        val.Set((std::uint64_t) srcObj->Id);
+                        meshUniqueIds.push_back(std::move(val));
+                    }
+                }
+            }
+        }
+
+        ProxyObject userProps;
+        const int world = (int) worlds.size();
+        if (obj) {
+            this->BuildUserProperties(*obj, userProps);
+            worlds.push_back(worlds[visit.ParentWorld] * this->GetNodeTransform(*obj).Evaluate());
+        }
+        else {
+            worlds.push_back(Matrix44());
+        }
+        int childParent = visit.Parent;
+        const std::string typeName = obj ? GetNodeTypeName(*obj) : std::string();
+        const Rules::Action action = obj ? matcher.Evaluate(visit.State, typeName.c_str(), userProps.UserProperties) : Rules::Include;
+        if (Rules::Exclude != action) {
+            const int index = scene.AddNode(visit.Parent, obj ? lastChild[visit.Parent] : ProxyNode::InvalidIndex);
+            if (obj) {
+                lastChild[visit.Parent] = index;
+            }
+            lastChild.resize(index + 1);
+            lastChild[index] = ProxyNode::InvalidIndex;
+            childParent = index;
+
+            ProxyNode& node = scene.Nodes[index];
+            node.Keep = Rules::Keep == action;
+            const Rules::TangentMode tangents = obj ? matcher.EvaluateTangents(visit.State, typeName.c_str(), userProps.UserProperties) : rules.DefaultTangents();
+            node.RegenerateTangents = Rules::RegenerateTangents == tangents;
+            node.World = worlds[world];
+            if (nullptr == obj) {
+                node.Properties.Add("name", "RootNode");
+                node.Properties.Add("id", (std::uint64_t) 0);
+                node.Properties.Add("visible", true);
+            }
+            else {
+                node.Properties.Add("name", obj->Name);
+                node.Properties.Add("id", (std::uint64_t) id);
+                node.Properties.Add("visible", this->GetDouble(*obj, "Visibility", 1.0) > 0.0);
+                node.Geometric = this->GetGeometricTransform(*obj);
+            }
+            if (meshUniqueIds.size() > 0) {
+                node.Properties.Add("meshes", std::move(meshUniqueIds));
+            }
+            node.UserProperties = std::move(userProps.UserProperties);
+        }
+
+        // push children in reverse, so they are visited in order
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            stack.push_back(Visit{ *it, childParent, matcher.Step(visit.State, (*it)->Name.c_str()), world });
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+NativeBuilder::BuildAnimations(ProxyScene& scene) const {
+    static const char* const channelProps[AnimTrack::NumChannels] = { "Lcl Translation", "Lcl Rotation", "Lcl Scaling" };
+    static const char* const axisProps[3] = { "d|X", "d|Y", "d|Z" };
+    std::unordered_map<std::int64_t, int> nodeIndexById;
+    for (std::size_t i = 1; i < scene.Nodes.size(); i++) {
+        nodeIndexById[(std::int64_t) scene.Nodes[i].Properties["id"].Get<std::uint64_t>()] = (int) i;
+    }
+    for (const Object& stackObj : this->objects) {
+        if (!stackObj.Node->Is("AnimationStack")) {
+            continue;
+        }
+        // only the first (base) layer of a stack is exported
+        const Object* layerObj = nullptr;
+        const std::vector<Connection>* stackConns = this->GetSrcConnections(stackObj.Id);
+        if (stackConns) {
+            for (const Connection& conn : *stackConns) {
+                const Object* srcObj = this->LookupObject(conn.Src);
+                if (srcObj && srcObj->Node->Is("AnimationLayer")) {
+                    layerObj = srcObj;
+                    break;
+                }
+            }
+        }
+        if (nullptr == layerObj) {
+            continue;
+        }
+        scene.Animations.emplace_back();
+        ProxyAnimation& anim = scene.Animations.back();
+        anim.Properties.Add("name", stackObj.Name);
+        anim.Properties.Add("id", (std::uint64_t) stackObj.Id);
+        anim.Properties.Add("start", this->GetDouble(stackObj, "LocalStart", 0.0) / AnimCurve::TicksPerSecond);
+        anim.Properties.Add("stop", this->GetDouble(stackObj, "LocalStop", 0.0) / AnimCurve::TicksPerSecond);
+        this->BuildUserProperties(stackObj, anim);
+
+        // curve nodes of the layer which drive a transform property of an included node
+        std::unordered_map<int, ProxyAnimation::Target> targets;
+        const std::vector<Connection>* layerConns = this->GetSrcConnections(layerObj->Id);
+        if (layerConns) {
+            for (const Connection& layerConn : *layerConns) {
+                const Object* curveNodeObj = this->LookupObject(layerConn.Src);
+                if (!curveNodeObj || !curveNodeObj->Node->Is("AnimationCurveNode")) {
+                    continue;
+                }
+                auto propIt = this->propConnectionsBySrc.find(curveNodeObj->Id);
+                if (propIt == this->propConnectionsBySrc.end()) {
+                    continue;
+                }
+                for (const Connection& propConn : propIt->second) {
+                    auto nodeIt = nodeIndexById.find(propConn.Dst);
+                    if (nodeIt == nodeIndexById.end()) {
+                        continue;
+                    }
+                    const std::string propName = propConn.Prop.ToString();
+                    int chn = 0;
+                    while ((chn < AnimTrack::NumChannels) && (propName != channelProps[chn])) {
+                        chn++;
+                    }
+                    const std::vector<Connection>* curveConns = this->GetSrcConnections(curveNodeObj->Id);
+                    if ((chn == AnimTrack::NumChannels) || !curveConns) {
+                        continue;
+                    }
+                    auto targetIt = targets.find(nodeIt->second);
+                    if (targetIt == targets.end()) {
+                        const Object* modelObj = this->LookupObject(propConn.Dst);
+                        ProxyAnimation::Target target;
+                        target.Node = nodeIt->second;
+                        target.Transform = this->GetNodeTransform(*modelObj);
+                        for (int c = 0; c < AnimTrack::NumChannels; c++) {
+                            for (int axis = 0; axis < 3; axis++) {
+                                target.Curves[c][axis] = -1;
+                            }
+                        }
+                        targetIt = targets.insert(std::make_pair(nodeIt->second, target)).first;
+                    }
+                    for (const Connection& curveConn : *curveConns) {
+                        const Object* curveObj = this->LookupObject(curveConn.Src);
+                        if (!curveObj || !curveObj->Node->Is("AnimationCurve")) {
+                            continue;
+                        }
+                        const std::string axisName = curveConn.Prop.ToString();
+                        for (int axis = 0; axis < 3; axis++) {
+                            if (axisName == axisProps[axis]) {
+                                targetIt->second.Curves[chn][axis] = (int) anim.Curves.size();
+                                anim.Curves.emplace_back();
+                                anim.Curves.back().CurveNode = curveObj->Node;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        // targets in node order, like the SDK builder produces them
+        for (const auto& entry : targets) {
+            anim.Targets.push_back(entry.second);
+        }
+        std::sort(anim.Targets.begin(), anim.Targets.end(), [](const ProxyAnimation::Target& a, const ProxyAnimation::Target& b) {
+            return a.Node < b.Node;
+        });
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,121 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::NativeBuilder
+    @brief populates a ProxyScene object directly from a BinaryFbx file
+
+    This is the counterpart to ProxyBuilder for the native reader, it
+    produces the same properties without going through the FBX SDK object
+    graph. Property values missing in an object fall back to the
+    property templates in the file's Definitions section. Object ids are
+    the ids stored in the file. Node transforms are evaluated from the
+    Lcl/pivot/offset/pre- and post-rotation properties like the FBX SDK
+    does, but always with the default inherit type (RSrs).
+*/
+#include "ProxyScene.h"
+#include "NodeTransform.h"
+#include "BinaryFbx.h"
+#include "ArrayCache.h"
+#include "Rules.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace FBXC {
+
+class NativeBuilder {
+public:
+    /// populate ProxyScene object from a BinaryFbx file, with the nodes selected by rules
+    static void Build(const BinaryFbx& fbx, ArrayCache& arrayCache, const std::string& fbxPath, const Rules& rules, ProxyScene& outProxyScene);
+
+private:
+    /// an entry in the Objects section
+    struct Object {
+        const BinaryFbx::Node* Node = nullptr;
+        std::int64_t Id = 0;
+        std::string Name;
+        std::string SubClass;
+    };
+    /// an entry in the Connections section
+    struct Connection {
+        std::int64_t Src = 0;
+        std::int64_t Dst = 0;
+        BinaryFbx::Property Prop;
+    };
+
+    /// constructor
+    NativeBuilder(const BinaryFbx& fbx, ArrayCache& arrayCache);
+    /// index objects, connections and property templates
+    void Setup();
+    /// get object by id, or nullptr
+    const Object* LookupObject(std::int64_t id) const;
+    /// get the connections where an object is the destination
+    const std::vector<Connection>* GetSrcConnections(std::int64_t id) const;
+    /// find a property node (P) of an object, falling back to the property template
+    const BinaryFbx::Node* FindProperty(const Object& obj, const char* name) const;
+    /// get a bool property value
+    bool GetBool(const Object& obj, const char* name, bool defVal) const;
+    /// get an integer property value
+    std::int32_t GetInt(const Object& obj, const char* name, std::int32_t defVal) const;
+    /// get a double property value
+    double GetDouble(const Object& obj, const char* name, double defVal) const;
+    /// get a double3 property value
+    FbxDouble3 GetDouble3(const Object& obj, const char* name, const FbxDouble3& defVal) const;
+    /// get a string property value
+    std::string GetString(const Object& obj, const char* name, const char* defVal) const;
+    /// get string value of a child node, or empty string
+    std::string GetChildString(const BinaryFbx::Node& node, const char* name) const;
+    /// get the array property of a child node, returns false if not found
+    bool GetChildArray(const BinaryFbx::Node& node, const char* name, BinaryFbx::Property& outProp) const;
+    /// get a 4x4 matrix stored as 16 doubles in a child node, or identity
+    Matrix44 GetChildMatrix(const BinaryFbx::Node& node, const char* name) const;
+
+    /// build a property connection (e.g. when a texture is attached to a material property)
+    bool BuildPropertyConnection(const Object& obj, const char* fbxPropName, const char* name, PropertyMap& props) const;
+    /// build user properties
+    void BuildUserProperties(const Object& obj, ProxyObject& proxyObj) const;
+    /// build metadata information
+    void BuildMetaData(ProxyScene& scene) const;
+    /// get the materials of the first node using a mesh
+    void GetMeshMaterials(const Object& meshObj, std::vector<const Object*>& outMaterials) const;
+    /// collect the meshes, materials and textures reachable from the scene's nodes
+    void CollectUsedObjects(const ProxyScene& scene);
+    /// return true if an object should be built
+    bool IsUsed(const Object& obj) const;
+    /// build texture array
+    void BuildTextures(ProxyScene& scene) const;
+    /// build material array
+    void BuildMaterials(ProxyScene& scene) const;
+    /// build mesh array
+    void BuildMeshes(ProxyScene& scene) const;
+    /// build the skin clusters, joints and inverse bind matrices of a mesh
+    void BuildSkin(const Object& meshObj, ProxyMesh& mesh) const;
+    /// build the blend shape records and channel names of a mesh
+    void BuildShapes(const Object& meshObj, ProxyMesh& mesh) const;
+    /// get the local transform setup of a Model object
+    NodeTransform GetNodeTransform(const Object& obj) const;
+    /// get the geometric transform of a Model object
+    Matrix44 GetGeometricTransform(const Object& obj) const;
+    /// get the rules type name of a Model object (e.g. 'mesh')
+    static std::string GetNodeTypeName(const Object& obj);
+    /// build node hierarchy
+    void BuildNodes(const Rules& rules, ProxyScene& scene) const;
+    /// build animation stacks with the curves of the included nodes
+    void BuildAnimations(ProxyScene& scene) const;
+
+    const BinaryFbx& fbx;
+    ArrayCache& arrayCache;
+    std::vector<Object> objects;
+    std::unordered_map<std::int64_t, int> objectIndexById;
+    std::unordered_map<std::int64_t, std::vector<Connection>> connectionsByDst;
+    std::unordered_map<std::int64_t, std::int64_t> firstDstBySrc;
+    /// connections to object properties (e.g. animation curve nodes), by source object
+    std::unordered_map<std::int64_t, std::vector<Connection>> propConnectionsBySrc;
+    std::unordered_map<std::string, const BinaryFbx::Node*> templates;
+    /// ids of objects reachable from included nodes (if filterUsed is true)
+    std::unordered_set<std::int64_t> usedIds;
+    bool filterUsed = false;
+};
+
+} // namespace FBXC
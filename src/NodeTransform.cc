@@ -0,0 +1,54 @@
+//------------------------------------------------------------------------------
+//  NodeTransform.cc
+//------------------------------------------------------------------------------
+#include "NodeTransform.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+static Matrix44
+translation(const FbxDouble3& t) {
+    return Matrix44::Translation(t[0], t[1], t[2]);
+}
+
+//------------------------------------------------------------------------------
+void
+NodeTransform::Setup(const FbxDouble3& rotationOffset, const FbxDouble3& rotationPivot,
+                     const FbxDouble3& preRotation_, const FbxDouble3& postRotation_,
+                     const FbxDouble3& scalingOffset, const FbxDouble3& scalingPivot,
+                     bool rotationActive, int rotationOrder) {
+    Matrix44 pre, postInv;
+    this->order = Matrix44::EulerXYZ;
+    if (rotationActive) {
+        if ((rotationOrder >= Matrix44::EulerXYZ) && (rotationOrder <= Matrix44::EulerZYX)) {
+            this->order = (Matrix44::RotationOrder) rotationOrder;
+        }
+        pre = Matrix44::Rotation(preRotation_[0], preRotation_[1], preRotation_[2], Matrix44::EulerXYZ);
+        postInv = Matrix44::Rotation(postRotation_[0], postRotation_[1], postRotation_[2], Matrix44::EulerXYZ).Inverse();
+    }
+    this->preRotation = translation(rotationOffset) * translation(rotationPivot) * pre;
+    this->postRotation = postInv *
+        Matrix44::Translation(-rotationPivot[0], -rotationPivot[1], -rotationPivot[2]) *
+        translation(scalingOffset) *
+        translation(scalingPivot);
+    this->postScaling = Matrix44::Translation(-scalingPivot[0], -scalingPivot[1], -scalingPivot[2]);
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+NodeTransform::Evaluate(const FbxDouble3& t, const FbxDouble3& r, const FbxDouble3& s) const {
+    return translation(t) *
+        this->preRotation *
+        Matrix44::Rotation(r[0], r[1], r[2], this->order) *
+        this->postRotation *
+        Matrix44::Scaling(s[0], s[1], s[2]) *
+        this->postScaling;
+}
+
+//------------------------------------------------------------------------------
+Matrix44
+NodeTransform::Evaluate() const {
+    return this->Evaluate(this->Translation, this->Rotation, this->Scaling);
+}
+
+} // namespace FBXC
@@ -0,0 +1,46 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::NodeTransform
+    @brief the local transform setup of an FBX node
+
+    Holds the static parts of the FBX local transform (offsets, pivots,
+    pre- and post-rotation and the rotation order) so that the local
+    matrix can be evaluated for any translation, rotation and scaling,
+    which is what animation sampling does for every sample:
+
+    T * Roff * Rp * Rpre * R * Rpost^-1 * Rp^-1 * Soff * Sp * S * Sp^-1
+*/
+#include "Matrix44.h"
+#include <fbxsdk.h>
+
+namespace FBXC {
+
+class NodeTransform {
+public:
+    /// setup the static parts, the rotation order and pre/post rotation only apply if rotationActive is set
+    void Setup(const FbxDouble3& rotationOffset, const FbxDouble3& rotationPivot,
+               const FbxDouble3& preRotation, const FbxDouble3& postRotation,
+               const FbxDouble3& scalingOffset, const FbxDouble3& scalingPivot,
+               bool rotationActive, int rotationOrder);
+    /// evaluate the local transform (euler rotation in degrees)
+    Matrix44 Evaluate(const FbxDouble3& t, const FbxDouble3& r, const FbxDouble3& s) const;
+    /// evaluate the local transform with the static translation, rotation and scaling
+    Matrix44 Evaluate() const;
+
+    /// the static (not animated) local translation, rotation and scaling
+    FbxDouble3 Translation = FbxDouble3(0.0, 0.0, 0.0);
+    FbxDouble3 Rotation = FbxDouble3(0.0, 0.0, 0.0);
+    FbxDouble3 Scaling = FbxDouble3(1.0, 1.0, 1.0);
+
+private:
+    /// Roff * Rp * Rpre
+    Matrix44 preRotation;
+    /// Rpost^-1 * Rp^-1 * Soff * Sp
+    Matrix44 postRotation;
+    /// Sp^-1
+    Matrix44 postScaling;
+    Matrix44::RotationOrder order = Matrix44::EulerXYZ;
+};
+
+} // namespace FBXC
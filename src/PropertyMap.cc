@@ -2,25 +2,71 @@
 //  PropertyMap.cc
 //------------------------------------------------------------------------------
 #include "PropertyMap.h"
+#include "StringPool.h"
+#include <cstring>
 
 namespace FBXC {
 
 //------------------------------------------------------------------------------
-bool
-PropertyMap::Contains(const std::string& key) const {
-    return this->content.find(key) != this->content.end();
+std::size_t
+PropertyMap::LowerBound(const char* key) const {
+    std::size_t lo = 0;
+    std::size_t hi = this->entries.size();
+    while (lo < hi) {
+        const std::size_t mid = (lo + hi) / 2;
+        if (std::strcmp(this->entries[mid].Key, key) < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
 }
 
 //------------------------------------------------------------------------------
-const Value&
-PropertyMap::operator[](const std::string& key) const {
-    return this->content.at(key);
+void
+PropertyMap::Add(const char* key, Value&& value) {
+    assert(key);
+    const std::size_t index = this->LowerBound(key);
+    assert((index == this->entries.size()) || (0 != std::strcmp(this->entries[index].Key, key)));
+    // most objects have a handful to a few dozen properties, start with
+    // room for a few instead of growing from a single entry
+    if (this->entries.empty()) {
+        this->entries.reserve(8);
+    }
+    Entry entry;
+    entry.Key = StringPool::Intern(key);
+    entry.Val = std::move(value);
+    this->entries.insert(this->entries.begin() + index, std::move(entry));
+}
+
+//------------------------------------------------------------------------------
+void
+PropertyMap::Set(const char* key, Value&& value) {
+    assert(key);
+    const std::size_t index = this->LowerBound(key);
+    if ((index < this->entries.size()) && (0 == std::strcmp(this->entries[index].Key, key))) {
+        this->entries[index].Val = std::move(value);
+    }
+    else {
+        this->Add(key, std::move(value));
+    }
 }
 
 //------------------------------------------------------------------------------
-const std::map<std::string, Value>&
-PropertyMap::Content() const {
-    return this->content;
+bool
+PropertyMap::Contains(const char* key) const {
+    assert(key);
+    const std::size_t index = this->LowerBound(key);
+    return (index < this->entries.size()) && (0 == std::strcmp(this->entries[index].Key, key));
+}
+
+//------------------------------------------------------------------------------
+const Value&
+PropertyMap::operator[](const char* key) const {
+    assert(this->Contains(key));
+    return this->entries[this->LowerBound(key)].Val;
 }
 
-} // namespace FBXC
\ No newline at end of file
+} // namespace FBXC
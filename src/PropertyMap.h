@@ -3,36 +3,137 @@
 /**
     @class FBXC::PropertyMap
     @brief a dictionary of key/value properties
+
+    Keys are interned in the StringPool, the entries live in a single
+    vector sorted by key name, so iteration is in key order (as with
+    the std::map this replaces) and a map costs one allocation instead
+    of one tree node and key string per property.
 */
 #include <cassert>
-#include <map>
+#include <string>
+#include <vector>
 #include "Value.h"
 
 namespace FBXC {
 
 class PropertyMap {
 public:
+    /// a key/value entry
+    struct Entry {
+        /// interned key string
+        const char* Key;
+        Value Val;
+    };
+
+    /// add a value to the property map
+    template<typename TYPE> void Add(const char* key, const TYPE& value);
     /// add a value to the property map
-    template<typename TYPE> void Add(const std::string& key, TYPE value);
+    template<typename TYPE> void Add(const std::string& key, const TYPE& value);
+    /// add an array value to the property map, takes over the elements
+    void Add(const char* key, std::vector<Value>&& values);
+    /// add an existing value to the property map
+    void Add(const char* key, const Value& value);
+    /// add an existing value to the property map, takes over the value
+    void Add(const char* key, Value&& value);
+    /// add a value, or replace the value of an existing key
+    template<typename TYPE> void Set(const char* key, const TYPE& value);
+    /// add a value, or replace the value of an existing key, takes over the value
+    void Set(const char* key, Value&& value);
+    /// return true if property map contains key
+    bool Contains(const char* key) const;
     /// return true if property map contains key
     bool Contains(const std::string& key) const;
     /// return value by key (must be contained)
+    const Value& operator[](const char* key) const;
+    /// return value by key (must be contained)
     const Value& operator[](const std::string& key) const;
-    /// get content map
-    const std::map<std::string, Value>& Content() const;
+
+    /// number of entries
+    int Size() const;
+    /// return true if the map has no entries
+    bool Empty() const;
+    /// first entry (in key order)
+    std::vector<Entry>::const_iterator begin() const;
+    /// end of entries
+    std::vector<Entry>::const_iterator end() const;
 
 private:
-    std::map<std::string, Value> content;
+    /// return index of the first entry with key >= key
+    std::size_t LowerBound(const char* key) const;
+
+    std::vector<Entry> entries;
 };
 
 //------------------------------------------------------------------------------
 template<typename TYPE> void
-PropertyMap::Add(const std::string& key, TYPE value) {
-    assert(!this->Contains(key));
+PropertyMap::Add(const char* key, const TYPE& value) {
     Value val;
     val.Set(value);
-    this->content[key] = val;
+    this->Add(key, std::move(val));
 }
 
-} // namespace FBXC
+//------------------------------------------------------------------------------
+template<typename TYPE> void
+PropertyMap::Add(const std::string& key, const TYPE& value) {
+    this->Add(key.c_str(), value);
+}
 
+//------------------------------------------------------------------------------
+inline void
+PropertyMap::Add(const char* key, std::vector<Value>&& values) {
+    Value val;
+    val.Set(std::move(values));
+    this->Add(key, std::move(val));
+}
+
+//------------------------------------------------------------------------------
+inline void
+PropertyMap::Add(const char* key, const Value& value) {
+    this->Add(key, Value(value));
+}
+
+//------------------------------------------------------------------------------
+template<typename TYPE> void
+PropertyMap::Set(const char* key, const TYPE& value) {
+    Value val;
+    val.Set(value);
+    this->Set(key, std::move(val));
+}
+
+//------------------------------------------------------------------------------
+inline bool
+PropertyMap::Contains(const std::string& key) const {
+    return this->Contains(key.c_str());
+}
+
+//------------------------------------------------------------------------------
+inline const Value&
+PropertyMap::operator[](const std::string& key) const {
+    return (*this)[key.c_str()];
+}
+
+//------------------------------------------------------------------------------
+inline int
+PropertyMap::Size() const {
+    return (int) this->entries.size();
+}
+
+//------------------------------------------------------------------------------
+inline bool
+PropertyMap::Empty() const {
+    return this->entries.empty();
+}
+
+//------------------------------------------------------------------------------
+inline std::vector<PropertyMap::Entry>::const_iterator
+PropertyMap::begin() const {
+    return this->entries.begin();
+}
+
+//------------------------------------------------------------------------------
+inline std::vector<PropertyMap::Entry>::const_iterator
+PropertyMap::end() const {
+    return this->entries.end();
+}
+
+} // namespace FBXC
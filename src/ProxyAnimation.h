@@ -0,0 +1,54 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ProxyAnimation
+    @brief proxy for an FbxAnimStack, with sampled keyframe tracks
+
+    Only the base layer of an animation stack is exported. Each node
+    with animated local translation, rotation or scaling is a Target,
+    the animation pipeline samples the local transform of the targets
+    and decomposes it into 3 tracks (translation, rotation, scaling),
+    Tracks[i * 3 + channel] belongs to Targets[i].
+*/
+#include "ProxyObject.h"
+#include "BinaryFbx.h"
+#include "AnimCurve.h"
+#include "AnimTrack.h"
+#include "NodeTransform.h"
+#include <vector>
+
+namespace FBXC {
+
+class ProxyTrack : public ProxyObject {
+public:
+    /// samples and keys, filled by the animation pipeline
+    AnimTrack Data;
+};
+
+class ProxyAnimation : public ProxyObject {
+public:
+    /// an animation curve of a node property component
+    struct Curve {
+        /// FBX SDK curve (SDK reader only)
+        FbxAnimCurve* FbxCurve = nullptr;
+        /// AnimationCurve record (native reader only)
+        const BinaryFbx::Node* CurveNode = nullptr;
+        /// keys, set up before sampling
+        AnimCurve Data;
+    };
+    /// an animated node
+    struct Target {
+        /// index of the node in ProxyScene::Nodes
+        int Node = 0;
+        /// local transform setup and static values of the node
+        NodeTransform Transform;
+        /// index into Curves by channel and axis, or -1 if not animated
+        int Curves[AnimTrack::NumChannels][3];
+    };
+
+    std::vector<Curve> Curves;
+    std::vector<Target> Targets;
+    std::vector<ProxyTrack> Tracks;
+};
+
+} // namespace FBXC
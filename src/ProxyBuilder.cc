@@ -3,21 +3,74 @@
 //------------------------------------------------------------------------------
 #include "ProxyBuilder.h"
 #include "Log.h"
+#include "RuleMatcher.h"
+#include "MeshSource.h"
+#include <map>
 
 namespace FBXC {
 
 //------------------------------------------------------------------------------
 void
-ProxyBuilder::Build(FbxScene* fbxScene, const std::string& fbxPath, ProxyScene& outProxyScene) {
+ProxyBuilder::Build(FbxScene* fbxScene, const std::string& fbxPath, const Rules& rules, ProxyScene& outProxyScene) {
     assert(fbxScene);
     
     outProxyScene.Object = fbxScene;
     outProxyScene.Properties.Add("file", fbxPath);
     BuildMetaData(fbxScene, outProxyScene);
-    BuildTextures(fbxScene, outProxyScene);
-    BuildMaterials(fbxScene, outProxyScene);
-    BuildMeshes(fbxScene, outProxyScene);
-    BuildNodes(fbxScene, outProxyScene, nullptr, nullptr);
+
+    // resolve the nodes first, with rules only the objects reachable
+    // from included nodes are built
+    BuildNodes(fbxScene, rules, outProxyScene);
+    std::unordered_set<FbxObject*> used;
+    const std::unordered_set<FbxObject*>* usedPtr = nullptr;
+    if (!rules.Empty()) {
+        CollectUsedObjects(outProxyScene, used);
+        usedPtr = &used;
+    }
+    BuildTextures(fbxScene, usedPtr, outProxyScene);
+    BuildMaterials(fbxScene, usedPtr, outProxyScene);
+    BuildMeshes(fbxScene, usedPtr, outProxyScene);
+    BuildAnimations(fbxScene, outProxyScene);
+}
+
+//------------------------------------------------------------------------------
+void
+ProxyBuilder::CollectUsedObjects(const ProxyScene& scene, std::unordered_set<FbxObject*>& outUsed) {
+    FbxCriteria texCriteria = FbxCriteria::ObjectType(FbxTexture::ClassId);
+    for (const ProxyNode& node : scene.Nodes) {
+        FbxNode* fbxNode = (FbxNode*) node.Object;
+        const int numNodeAttrs = fbxNode->GetNodeAttributeCount();
+        for (int attrIndex = 0; attrIndex < numNodeAttrs; attrIndex++) {
+            FbxNodeAttribute* fbxNodeAttr = fbxNode->GetNodeAttributeByIndex(attrIndex);
+            if ((fbxNodeAttr->GetAttributeType() != FbxNodeAttribute::eMesh) || !outUsed.insert(fbxNodeAttr).second) {
+                continue;
+            }
+            // same materials as in BuildMeshes (those of the first node using the mesh)
+            FbxNode* fbxMeshNode = ((FbxMesh*) fbxNodeAttr)->GetNode();
+            const int numMaterials = fbxMeshNode ? fbxMeshNode->GetMaterialCount() : 0;
+            for (int matIndex = 0; matIndex < numMaterials; matIndex++) {
+                FbxSurfaceMaterial* fbxMat = fbxMeshNode->GetMaterial(matIndex);
+                if (!outUsed.insert(fbxMat).second) {
+                    continue;
+                }
+                // textures connected to any material property, including
+                // the textures inside layered textures
+                FbxProperty fbxProp = fbxMat->GetFirstProperty();
+                while (fbxProp.IsValid()) {
+                    const int numTextures = fbxProp.GetSrcObjectCount(texCriteria);
+                    for (int texIndex = 0; texIndex < numTextures; texIndex++) {
+                        FbxObject* fbxTex = fbxProp.GetSrcObject(texCriteria, texIndex);
+                        outUsed.insert(fbxTex);
+                        const int numLayers = fbxTex->GetSrcObjectCount<FbxTexture>();
+                        for (int layerIndex = 0; layerIndex < numLayers; layerIndex++) {
+                            outUsed.insert(fbxTex->GetSrcObject<FbxTexture>(layerIndex));
+                        }
+                    }
+                    fbxProp = fbxMat->GetNextProperty(fbxProp);
+                }
+            }
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -81,10 +134,13 @@ ProxyBuilder::BuildUserProperties(FbxObject* fbxObject, ProxyObject& obj) {
 
 //------------------------------------------------------------------------------
 void
-ProxyBuilder::BuildTextures(FbxScene* fbxScene, ProxyScene& scene) {
+ProxyBuilder::BuildTextures(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene) {
     const int numTextures = fbxScene->GetTextureCount();
     for (int texIndex = 0; texIndex < numTextures; texIndex++) {
         FbxTexture* fbxTex = fbxScene->GetTexture(texIndex);
+        if (used && (0 == used->count(fbxTex))) {
+            continue;
+        }
     
         scene.Textures.emplace_back();
         ProxyObject& tex = scene.Textures.back();
@@ -226,7 +282,7 @@ ProxyBuilder::BuildPropertyConnection(const FbxPropertyT<FbxDouble3>& prop, cons
 
 //------------------------------------------------------------------------------
 void
-ProxyBuilder::BuildMaterials(FbxScene* fbxScene, ProxyScene& scene) {
+ProxyBuilder::BuildMaterials(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene) {
 
     // property connection search criteria for connected textures
     FbxCriteria texCriteria = FbxCriteria::ObjectType(FbxTexture::ClassId);
@@ -234,6 +290,9 @@ ProxyBuilder::BuildMaterials(FbxScene* fbxScene, ProxyScene& scene) {
     const int numMaterials = fbxScene->GetMaterialCount();
     for (int matIndex = 0; matIndex < numMaterials; matIndex++) {
         FbxSurfaceMaterial* fbxMat = fbxScene->GetMaterial(matIndex);
+        if (used && (0 == used->count(fbxMat))) {
+            continue;
+        }
 
         scene.Materials.emplace_back();
         ProxyObject& mat = scene.Materials.back();
@@ -310,18 +369,18 @@ ProxyBuilder::BuildMaterials(FbxScene* fbxScene, ProxyScene& scene) {
 
 //------------------------------------------------------------------------------
 void
-ProxyBuilder::BuildMeshes(FbxScene* fbxScene, ProxyScene& scene) {
+ProxyBuilder::BuildMeshes(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene) {
 
     const int numGeoms = fbxScene->GetGeometryCount();
     for (int geomIndex = 0; geomIndex < numGeoms; geomIndex++) {
         FbxGeometry* fbxGeom = fbxScene->GetGeometry(geomIndex);
         
         // only look at meshes
-        if (fbxGeom->GetClassId().Is(FbxMesh::ClassId)) {
+        if (fbxGeom->GetClassId().Is(FbxMesh::ClassId) && (!used || used->count(fbxGeom))) {
             FbxMesh* fbxMesh = (FbxMesh*) fbxGeom;
             
             scene.Meshes.emplace_back();
-            ProxyObject& mesh = scene.Meshes.back();
+            ProxyMesh& mesh = scene.Meshes.back();
             mesh.Object = fbxMesh;
             
             // NOTE: meshes don't have names, so use unique id as identifier
@@ -339,17 +398,84 @@ ProxyBuilder::BuildMeshes(FbxScene* fbxScene, ProxyScene& scene) {
             mesh.Properties.Add("hasvertexcolor", fbxLayer->GetVertexColors() != nullptr);
             mesh.Properties.Add("hasuserdata", fbxLayer->GetUserData() != nullptr);
             mesh.Properties.Add("hasvisibility", fbxLayer->GetVisibility() != nullptr);
-            if (fbxLayer->GetUVSetCount() > 0) {
+            // the UV sets which MeshSource extracts into the texcoord streams
+            const int numUVSets = MeshSource::CountUVSets(fbxMesh);
+            if (numUVSets > 0) {
                 std::vector<Value> uvSets;
-                FbxArray<const FbxLayerElementUV*> fbxUvSets = fbxLayer->GetUVSets();
-                for (int i = 0; i < fbxUvSets.Size(); i++) {
+                for (int i = 0; i < numUVSets; i++) {
                     Value val;
-                    val.Set(fbxUvSets[i]->GetName());
-                    uvSets.push_back(val);
+                    val.Set(fbxMesh->GetElementUV(i)->GetName());
+                    uvSets.push_back(std::move(val));
                 }
-                mesh.Properties.Add("uvsets", uvSets);
+                mesh.Properties.Add("uvsets", std::move(uvSets));
+            }
+            
+            // materials of the first node using the mesh, the per-polygon
+            // material indices of the mesh index into this list
+            FbxNode* fbxNode = fbxMesh->GetNode();
+            if (fbxNode && (fbxNode->GetMaterialCount() > 0)) {
+                std::vector<Value> materialIds;
+                for (int i = 0; i < fbxNode->GetMaterialCount(); i++) {
+                    Value val;
+                    val.Set(fbxNode->GetMaterial(i)->GetUniqueID());
+                    materialIds.push_back(std::move(val));
+                }
+                mesh.Properties.Add("materials", std::move(materialIds));
             }
             BuildUserProperties(fbxMesh, mesh);
+            BuildSkin(fbxMesh, mesh);
+            BuildShapes(fbxMesh, mesh);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static Matrix44
+toMatrix44(const FbxAMatrix& fbxMatrix) {
+    // FbxAMatrix rows are our columns (the translation is in row 3)
+    Matrix44 m;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            m.Set(row, col, fbxMatrix.Get(col, row));
+        }
+    }
+    return m;
+}
+
+//------------------------------------------------------------------------------
+void
+ProxyBuilder::BuildSkin(FbxMesh* fbxMesh, ProxyMesh& mesh) {
+    if (0 == fbxMesh->GetDeformerCount(FbxDeformer::eSkin)) {
+        return;
+    }
+    // same cluster order as MeshSource, cluster i is joint i
+    FbxSkin* fbxSkin = (FbxSkin*) fbxMesh->GetDeformer(0, FbxDeformer::eSkin);
+    for (int i = 0; i < fbxSkin->GetClusterCount(); i++) {
+        FbxCluster* fbxCluster = fbxSkin->GetCluster(i);
+        FbxNode* fbxLink = fbxCluster->GetLink();
+        Value jointId;
+        jointId.Set((std::uint64_t) (fbxLink ? fbxLink->GetUniqueID() : 0));
+        mesh.Joints.push_back(jointId);
+        FbxAMatrix meshBind;
+        FbxAMatrix jointBind;
+        fbxCluster->GetTransformMatrix(meshBind);
+        fbxCluster->GetTransformLinkMatrix(jointBind);
+        mesh.InverseBindMatrices.push_back(toMatrix44(jointBind).Inverse() * toMatrix44(meshBind));
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ProxyBuilder::BuildShapes(FbxMesh* fbxMesh, ProxyMesh& mesh) {
+    // same channel order as MeshSource
+    const int numBlendShapes = fbxMesh->GetDeformerCount(FbxDeformer::eBlendShape);
+    for (int i = 0; i < numBlendShapes; i++) {
+        FbxBlendShape* fbxBlendShape = (FbxBlendShape*) fbxMesh->GetDeformer(i, FbxDeformer::eBlendShape);
+        const int numChannels = fbxBlendShape->GetBlendShapeChannelCount();
+        for (int c = 0; c < numChannels; c++) {
+            Value name;
+            name.Set(std::string(fbxBlendShape->GetBlendShapeChannel(c)->GetName()));
+            mesh.ShapeNames.push_back(std::move(name));
         }
     }
 }
@@ -364,42 +490,180 @@ ProxyBuilder::GetNodeAttributeUniqueIds(FbxNode* fbxNode, FbxNodeAttribute::ETyp
         if (fbxNodeAttr->GetAttributeType() == type) {
             Value val;
             val.Set(fbxNodeAttr->GetUniqueID());
-            result.push_back(val);
+            result.push_back(std::move(val));
         }
     }
     return result;
 }
 
 //------------------------------------------------------------------------------
-void
-ProxyBuilder::BuildNodes(FbxScene* fbxScene, ProxyScene& scene, FbxNode* fbxNode, ProxyNode* node) {
-    
-    // root node?
-    if (nullptr == fbxNode) {
-        fbxNode = fbxScene->GetRootNode();
-        node = &scene.Nodes;
+const char*
+ProxyBuilder::GetNodeTypeName(FbxNode* fbxNode) {
+    const FbxNodeAttribute* fbxNodeAttr = fbxNode->GetNodeAttribute();
+    if (nullptr == fbxNodeAttr) {
+        return "null";
     }
-    
-    node->Properties.Add("name", fbxNode->GetName());
-    node->Properties.Add("id", fbxNode->GetUniqueID());
-    node->Properties.Add("visible", fbxNode->GetVisibility());
-    
-    // meshes connected to this node
-    std::vector<Value> meshUniqueIds = GetNodeAttributeUniqueIds(fbxNode, FbxNodeAttribute::eMesh);
-    if (meshUniqueIds.size() > 0) {
-        node->Properties.Add("meshes", meshUniqueIds);
+    switch (fbxNodeAttr->GetAttributeType()) {
+        case FbxNodeAttribute::eNull:               return "null";
+        case FbxNodeAttribute::eMarker:             return "marker";
+        case FbxNodeAttribute::eSkeleton:           return "skeleton";
+        case FbxNodeAttribute::eMesh:               return "mesh";
+        case FbxNodeAttribute::eNurbs:              return "nurbs";
+        case FbxNodeAttribute::ePatch:              return "patch";
+        case FbxNodeAttribute::eCamera:             return "camera";
+        case FbxNodeAttribute::eCameraStereo:       return "camerastereo";
+        case FbxNodeAttribute::eCameraSwitcher:     return "cameraswitcher";
+        case FbxNodeAttribute::eLight:              return "light";
+        case FbxNodeAttribute::eOpticalReference:   return "opticalreference";
+        case FbxNodeAttribute::eOpticalMarker:      return "opticalmarker";
+        case FbxNodeAttribute::eNurbsCurve:         return "nurbscurve";
+        case FbxNodeAttribute::eTrimNurbsSurface:   return "trimnurbssurface";
+        case FbxNodeAttribute::eBoundary:           return "boundary";
+        case FbxNodeAttribute::eNurbsSurface:       return "nurbssurface";
+        case FbxNodeAttribute::eShape:              return "shape";
+        case FbxNodeAttribute::eLODGroup:           return "lodgroup";
+        case FbxNodeAttribute::eSubDiv:             return "subdiv";
+        case FbxNodeAttribute::eCachedEffect:       return "cachedeffect";
+        case FbxNodeAttribute::eLine:               return "line";
+        default:                                    return "unknown";
     }
-    BuildUserProperties(fbxNode, *node);
+}
+
+//------------------------------------------------------------------------------
+void
+ProxyBuilder::BuildNodes(FbxScene* fbxScene, const Rules& rules, ProxyScene& scene) {
     
-    // recurse into children
-    if (fbxNode->GetChildCount() > 0) {
-        for (int i = 0; i < fbxNode->GetChildCount(); i++) {
+    // depth-first walk, each entry carries the proxy node the FbxNode
+    // attaches to (its nearest included ancestor) and its rule matcher
+    // state, excluded nodes only get their user properties extracted
+    // (for the rule predicates), the root node is always included
+    struct Visit {
+        FbxNode* Node;
+        int Parent;
+        RuleMatcher::State State;
+    };
+    RuleMatcher matcher(rules);
+    scene.Nodes.reserve(fbxScene->GetNodeCount());
+    std::vector<int> lastChild;
+    std::vector<Visit> stack;
+    stack.push_back(Visit{ fbxScene->GetRootNode(), ProxyNode::InvalidIndex, matcher.Root() });
+    while (!stack.empty()) {
+        const Visit visit = stack.back();
+        stack.pop_back();
+        FbxNode* fbxNode = visit.Node;
+        
+        ProxyObject userProps;
+        BuildUserProperties(fbxNode, userProps);
+        int childParent = visit.Parent;
+        const bool isRoot = ProxyNode::InvalidIndex == visit.Parent;
+        const Rules::Action action = isRoot ? Rules::Include : matcher.Evaluate(visit.State, GetNodeTypeName(fbxNode), userProps.UserProperties);
+        if (Rules::Exclude != action) {
+            const int index = scene.AddNode(visit.Parent, isRoot ? ProxyNode::InvalidIndex : lastChild[visit.Parent]);
+            if (!isRoot) {
+                lastChild[visit.Parent] = index;
+            }
+            lastChild.resize(index + 1);
+            lastChild[index] = ProxyNode::InvalidIndex;
+            childParent = index;
+            
+            ProxyNode& node = scene.Nodes[index];
+            node.Object = fbxNode;
+            node.Keep = Rules::Keep == action;
+            const Rules::TangentMode tangents = isRoot ? rules.DefaultTangents() : matcher.EvaluateTangents(visit.State, GetNodeTypeName(fbxNode), userProps.UserProperties);
+            node.RegenerateTangents = Rules::RegenerateTangents == tangents;
+            node.World = toMatrix44(fbxNode->EvaluateGlobalTransform());
+            node.Geometric = toMatrix44(FbxAMatrix(fbxNode->GetGeometricTranslation(FbxNode::eSourcePivot),
+                                                   fbxNode->GetGeometricRotation(FbxNode::eSourcePivot),
+                                                   fbxNode->GetGeometricScaling(FbxNode::eSourcePivot)));
+            node.Properties.Add("name", fbxNode->GetName());
+            node.Properties.Add("id", fbxNode->GetUniqueID());
+            node.Properties.Add("visible", fbxNode->GetVisibility());
+            
+            // meshes connected to this node
+            std::vector<Value> meshUniqueIds = GetNodeAttributeUniqueIds(fbxNode, FbxNodeAttribute::eMesh);
+            if (meshUniqueIds.size() > 0) {
+                node.Properties.Add("meshes", std::move(meshUniqueIds));
+            }
+            node.UserProperties = std::move(userProps.UserProperties);
+        }
+        
+        // push children in reverse, so they are visited in order
+        for (int i = fbxNode->GetChildCount() - 1; i >= 0; i--) {
             FbxNode* fbxChildNode = fbxNode->GetChild(i);
-            node->Children.emplace_back();
-            ProxyNode* childNode = &node->Children.back();
-            BuildNodes(fbxScene, scene, fbxChildNode, childNode);
+            stack.push_back(Visit{ fbxChildNode, childParent, matcher.Step(visit.State, fbxChildNode->GetName()) });
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+static FbxDouble3
+toDouble3(const FbxVector4& v) {
+    return FbxDouble3(v[0], v[1], v[2]);
+}
+
+//------------------------------------------------------------------------------
+void
+ProxyBuilder::BuildAnimations(FbxScene* fbxScene, ProxyScene& scene) {
+    static const char* components[3] = {
+        FBXSDK_CURVENODE_COMPONENT_X, FBXSDK_CURVENODE_COMPONENT_Y, FBXSDK_CURVENODE_COMPONENT_Z
+    };
+    const int numStacks = fbxScene->GetSrcObjectCount<FbxAnimStack>();
+    for (int stackIndex = 0; stackIndex < numStacks; stackIndex++) {
+        FbxAnimStack* fbxStack = fbxScene->GetSrcObject<FbxAnimStack>(stackIndex);
+        FbxAnimLayer* fbxLayer = fbxStack->GetMember<FbxAnimLayer>(0);
+        if (nullptr == fbxLayer) {
+            continue;
+        }
+        scene.Animations.emplace_back();
+        ProxyAnimation& anim = scene.Animations.back();
+        anim.Object = fbxStack;
+        anim.Properties.Add("name", fbxStack->GetName());
+        anim.Properties.Add("id", fbxStack->GetUniqueID());
+        const FbxTimeSpan timeSpan = fbxStack->GetLocalTimeSpan();
+        anim.Properties.Add("start", timeSpan.GetStart().GetSecondDouble());
+        anim.Properties.Add("stop", timeSpan.GetStop().GetSecondDouble());
+        BuildUserProperties(fbxStack, anim);
+
+        // the curves are only recorded here, their keys are read by the animation pipeline
+        for (std::size_t nodeIndex = 1; nodeIndex < scene.Nodes.size(); nodeIndex++) {
+            FbxNode* fbxNode = (FbxNode*) scene.Nodes[nodeIndex].Object;
+            const FbxPropertyT<FbxDouble3>* fbxProps[AnimTrack::NumChannels] = {
+                &fbxNode->LclTranslation, &fbxNode->LclRotation, &fbxNode->LclScaling
+            };
+            ProxyAnimation::Target target;
+            target.Node = (int) nodeIndex;
+            bool animated = false;
+            for (int chn = 0; chn < AnimTrack::NumChannels; chn++) {
+                for (int axis = 0; axis < 3; axis++) {
+                    FbxAnimCurve* fbxCurve = fbxProps[chn]->GetCurve(fbxLayer, components[axis]);
+                    target.Curves[chn][axis] = -1;
+                    if (fbxCurve && (fbxCurve->KeyGetCount() > 0)) {
+                        target.Curves[chn][axis] = (int) anim.Curves.size();
+                        anim.Curves.emplace_back();
+                        anim.Curves.back().FbxCurve = fbxCurve;
+                        animated = true;
+                    }
+                }
+            }
+            if (!animated) {
+                continue;
+            }
+            EFbxRotationOrder rotationOrder = eEulerXYZ;
+            fbxNode->GetRotationOrder(FbxNode::eSourcePivot, rotationOrder);
+            target.Transform.Setup(toDouble3(fbxNode->GetRotationOffset(FbxNode::eSourcePivot)),
+                                   toDouble3(fbxNode->GetRotationPivot(FbxNode::eSourcePivot)),
+                                   toDouble3(fbxNode->GetPreRotation(FbxNode::eSourcePivot)),
+                                   toDouble3(fbxNode->GetPostRotation(FbxNode::eSourcePivot)),
+                                   toDouble3(fbxNode->GetScalingOffset(FbxNode::eSourcePivot)),
+                                   toDouble3(fbxNode->GetScalingPivot(FbxNode::eSourcePivot)),
+                                   fbxNode->GetRotationActive(),
+                                   (int) rotationOrder);
+            target.Transform.Translation = fbxNode->LclTranslation.Get();
+            target.Transform.Rotation = fbxNode->LclRotation.Get();
+            target.Transform.Scaling = fbxNode->LclScaling.Get();
+            anim.Targets.push_back(target);
         }
     }
 }
 
-} // namespace FBXC
\ No newline at end of file
+} // namespace FBXC
@@ -5,17 +5,21 @@
     @brief populates a ProxyScene object from an FbxScene object
 */
 #include "ProxyScene.h"
+#include "Rules.h"
 #include <fbxsdk.h>
 #include <string>
+#include <unordered_set>
 
 namespace FBXC {
 
 class ProxyBuilder {
 public:
-    /// populate ProxyScene object from FbxScene
-    static void Build(FbxScene* fbxScene, const std::string& fbxPath, ProxyScene& outProxyScene);
+    /// populate ProxyScene object from FbxScene, with the nodes selected by rules
+    static void Build(FbxScene* fbxScene, const std::string& fbxPath, const Rules& rules, ProxyScene& outProxyScene);
     
 private:
+    /// get the rules type name of an FbxNode (e.g. 'mesh')
+    static const char* GetNodeTypeName(FbxNode* fbxNode);
     /// get unique ids of an FbxNode's node attribute by type
     static std::vector<Value> GetNodeAttributeUniqueIds(FbxNode* fbxNode, FbxNodeAttribute::EType type);
     /// build a property connection (e.g. when a texture is attached to a material property)
@@ -24,14 +28,22 @@ private:
     static void BuildUserProperties(FbxObject* fbxObject, ProxyObject& obj);
     /// build metadata information
     static void BuildMetaData(FbxScene* fbxScene, ProxyScene& scene);
-    /// build texture array
-    static void BuildTextures(FbxScene* fbxScene, ProxyScene& scene);
-    /// build material array
-    static void BuildMaterials(FbxScene* fbxScene, ProxyScene& scene);
-    /// build mesh array
-    static void BuildMeshes(FbxScene* fbxScene, ProxyScene& scene);
+    /// collect the meshes, materials and textures reachable from the scene's nodes
+    static void CollectUsedObjects(const ProxyScene& scene, std::unordered_set<FbxObject*>& outUsed);
+    /// build texture array (only used textures if used is not nullptr)
+    static void BuildTextures(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene);
+    /// build material array (only used materials if used is not nullptr)
+    static void BuildMaterials(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene);
+    /// build mesh array (only used meshes if used is not nullptr)
+    static void BuildMeshes(FbxScene* fbxScene, const std::unordered_set<FbxObject*>* used, ProxyScene& scene);
+    /// build the skin joints and inverse bind matrices of a mesh
+    static void BuildSkin(FbxMesh* fbxMesh, ProxyMesh& mesh);
+    /// build the blend shape channel names of a mesh
+    static void BuildShapes(FbxMesh* fbxMesh, ProxyMesh& mesh);
     /// build node hierarchy
-    static void BuildNodes(FbxScene* fbxScene, ProxyScene& scene, FbxNode* fbxNode, ProxyNode* node);
+    static void BuildNodes(FbxScene* fbxScene, const Rules& rules, ProxyScene& scene);
+    /// build animation stacks with the curves of the included nodes
+    static void BuildAnimations(FbxScene* fbxScene, ProxyScene& scene);
 };
 
 } // namespace FBXC
\ No newline at end of file
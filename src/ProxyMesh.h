@@ -0,0 +1,37 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ProxyMesh
+    @brief proxy for an FbxMesh, with extracted vertex and index data
+*/
+#include "ProxyObject.h"
+#include "BinaryFbx.h"
+#include "MeshData.h"
+#include "Matrix44.h"
+#include <vector>
+
+namespace FBXC {
+
+class ProxyMesh : public ProxyObject {
+public:
+    /// geometry record (native reader only, Object is nullptr then)
+    const BinaryFbx::Node* GeomNode = nullptr;
+    /// skin cluster records, in joint order (native reader only)
+    std::vector<const BinaryFbx::Node*> ClusterNodes;
+    /// node ids of the skin joints (the nodes linked to the skin clusters)
+    std::vector<Value> Joints;
+    /// inverse bind matrix of each joint (mesh space into joint space at bind time)
+    std::vector<Matrix44> InverseBindMatrices;
+    /// full-weight shape records of the blend shape channels, nullptr if a channel has none (native reader only)
+    std::vector<const BinaryFbx::Node*> ShapeNodes;
+    /// names of the blend shape channels
+    std::vector<Value> ShapeNames;
+    /// generate tangents instead of exporting the source tangents (merged meshes: for some parts, see MeshMerger::Part)
+    bool GenerateTangents = false;
+    /// vertex and index data, filled by the mesh pipeline
+    MeshData Data;
+    /// pieces with 16-bit indices if the mesh has been split (Data is empty then)
+    std::vector<ProxyMesh> Pieces;
+};
+
+} // namespace FBXC
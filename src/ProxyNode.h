@@ -3,15 +3,36 @@
 /**
     @class ProxyNode
     @brief proxy for an FBX scene hierarchy node
+
+    Nodes don't own their children, all nodes of a scene live in
+    ProxyScene::Nodes and are linked by index (InvalidIndex if there
+    is no such node).
 */
 #include "ProxyObject.h"
-#include <vector>
+#include "Matrix44.h"
 
 namespace FBXC {
 
 class ProxyNode : public ProxyObject {
 public:
-    std::vector<ProxyNode> Children;
+    /// marks a missing parent, child or sibling
+    static const int InvalidIndex = -1;
+
+    /// index of parent node
+    int Parent = InvalidIndex;
+    /// index of first child node
+    int FirstChild = InvalidIndex;
+    /// index of next node with the same parent
+    int NextSibling = InvalidIndex;
+
+    /// world transform
+    Matrix44 World;
+    /// geometric transform, applies to the node's meshes but not to its children
+    Matrix44 Geometric;
+    /// marked with the 'keep' rule action, not merged into the parent by hierarchy flattening
+    bool Keep = false;
+    /// marked with the 'regenerate' tangent mode, its meshes get generated tangents
+    bool RegenerateTangents = false;
 };
 
-} // namespace FBXC
\ No newline at end of file
+} // namespace FBXC
@@ -3,8 +3,13 @@
 /**
     @class FBXC::ProxyScene
     @brief proxy object for an FbxScene
+
+    The node hierarchy is stored flat in Nodes in depth-first order,
+    the root node is Nodes[0] and each node is followed by its subtree.
 */
 #include "ProxyNode.h"
+#include "ProxyMesh.h"
+#include "ProxyAnimation.h"
 #include <vector>
 
 namespace FBXC {
@@ -13,9 +18,30 @@ class ProxyScene : public ProxyObject {
 public:
     std::vector<ProxyObject> Textures;
     std::vector<ProxyObject> Materials;
-    std::vector<ProxyObject> Meshes;
+    std::vector<ProxyMesh> Meshes;
+    std::vector<ProxyAnimation> Animations;
     
-    ProxyNode Nodes;
+    std::vector<ProxyNode> Nodes;
+
+    /// allocate a node (the root if parent is InvalidIndex), return its index
+    int AddNode(int parent, int prevSibling);
 };
 
-} // namespace FBXC
\ No newline at end of file
+//------------------------------------------------------------------------------
+inline int
+ProxyScene::AddNode(int parent, int prevSibling) {
+    assert((parent == ProxyNode::InvalidIndex) == this->Nodes.empty());
+    const int index = (int) this->Nodes.size();
+    this->Nodes.emplace_back();
+    this->Nodes[index].Parent = parent;
+    if (prevSibling != ProxyNode::InvalidIndex) {
+        assert(this->Nodes[prevSibling].Parent == parent);
+        this->Nodes[prevSibling].NextSibling = index;
+    }
+    else if (parent != ProxyNode::InvalidIndex) {
+        this->Nodes[parent].FirstChild = index;
+    }
+    return index;
+}
+
+} // namespace FBXC
@@ -0,0 +1,169 @@
+//------------------------------------------------------------------------------
+//  RuleMatcher.cc
+//------------------------------------------------------------------------------
+#include "RuleMatcher.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+RuleMatcher::RuleMatcher(const Rules& rules_) :
+    rules(rules_) {
+    std::vector<int> rootNodes;
+    if (!this->rules.trie.empty()) {
+        rootNodes.push_back(0);
+    }
+    this->Lookup(rootNodes);
+}
+
+//------------------------------------------------------------------------------
+RuleMatcher::State
+RuleMatcher::Lookup(std::vector<int>& trieNodes) {
+    // a '**' segment may also match no segment at all
+    for (std::size_t i = 0; i < trieNodes.size(); i++) {
+        const int anySegments = this->rules.trie[trieNodes[i]].AnySegments;
+        if (anySegments >= 0) {
+            trieNodes.push_back(anySegments);
+        }
+    }
+    std::sort(trieNodes.begin(), trieNodes.end());
+    trieNodes.erase(std::unique(trieNodes.begin(), trieNodes.end()), trieNodes.end());
+    auto it = this->stateIndex.find(trieNodes);
+    if (it != this->stateIndex.end()) {
+        return it->second;
+    }
+
+    const State state = (State) this->states.size();
+    this->states.emplace_back();
+    DfaState& dfaState = this->states.back();
+    dfaState.TrieNodes = trieNodes;
+    dfaState.LoopsOnAll = !trieNodes.empty();
+    for (int trieIndex : trieNodes) {
+        const Rules::TrieNode& trieNode = this->rules.trie[trieIndex];
+        dfaState.Accept.insert(dfaState.Accept.end(), trieNode.Accept.begin(), trieNode.Accept.end());
+        if (!trieNode.IsAnySegments || !trieNode.Literals.empty() || !trieNode.Globs.empty()) {
+            dfaState.LoopsOnAll = false;
+        }
+    }
+    std::sort(dfaState.Accept.begin(), dfaState.Accept.end());
+    dfaState.Accept.erase(std::unique(dfaState.Accept.begin(), dfaState.Accept.end()), dfaState.Accept.end());
+    this->stateIndex.emplace(trieNodes, state);
+    return state;
+}
+
+//------------------------------------------------------------------------------
+RuleMatcher::State
+RuleMatcher::Step(State parent, const char* name) {
+    assert(name);
+    if (Dead == parent) {
+        return Dead;
+    }
+    if (this->states[parent].LoopsOnAll) {
+        return parent;
+    }
+    auto it = this->states[parent].Next.find(name);
+    if (it != this->states[parent].Next.end()) {
+        return it->second;
+    }
+
+    std::vector<int> trieNodes;
+    for (int trieIndex : this->states[parent].TrieNodes) {
+        const Rules::TrieNode& trieNode = this->rules.trie[trieIndex];
+        auto literal = trieNode.Literals.find(name);
+        if (literal != trieNode.Literals.end()) {
+            trieNodes.push_back(literal->second);
+        }
+        for (const auto& glob : trieNode.Globs) {
+            if (Rules::Match(glob.first.c_str(), name)) {
+                trieNodes.push_back(glob.second);
+            }
+        }
+        if (trieNode.IsAnySegments) {
+            trieNodes.push_back(trieIndex);
+        }
+    }
+    // Lookup() may add states, so don't hold on to a reference across it
+    const State next = trieNodes.empty() ? Dead : this->Lookup(trieNodes);
+    this->states[parent].Next.emplace(name, next);
+    return next;
+}
+
+//------------------------------------------------------------------------------
+static std::string
+valueToString(const Value& value) {
+    char buf[64];
+    switch (value.GetType()) {
+        case Value::Bool:
+            return value.Get<bool>() ? "true" : "false";
+        case Value::Id:
+            std::snprintf(buf, sizeof(buf), "%" PRIu64, value.Get<std::uint64_t>());
+            return buf;
+        case Value::Int:
+            std::snprintf(buf, sizeof(buf), "%d", (int) value.Get<std::int32_t>());
+            return buf;
+        case Value::Float:
+            std::snprintf(buf, sizeof(buf), "%g", value.Get<double>());
+            return buf;
+        case Value::String:
+            return value.GetString();
+        default:
+            return std::string();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+RuleMatcher::Check(const Rules::Rule& rule, const char* type, const PropertyMap& userProps) {
+    if (!rule.Type.empty() && (0 != std::strcmp(rule.Type.c_str(), type))) {
+        return false;
+    }
+    for (const Rules::Attribute& attr : rule.Attributes) {
+        if (!userProps.Contains(attr.Name)) {
+            return false;
+        }
+        if (attr.HasValue && !Rules::Match(attr.Value.c_str(), valueToString(userProps[attr.Name]).c_str())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+const Rules::Rule*
+RuleMatcher::Match(State state, const char* type, const PropertyMap& userProps, bool tangents) const {
+    assert(type);
+    if (Dead == state) {
+        return nullptr;
+    }
+    // the last matching rule wins
+    const std::vector<int>& accept = this->states[state].Accept;
+    for (auto it = accept.rbegin(); it != accept.rend(); ++it) {
+        const Rules::Rule& rule = this->rules.GetRule(*it);
+        if ((tangents ? rule.HasTangents : rule.HasAction) && Check(rule, type, userProps)) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+Rules::Action
+RuleMatcher::Evaluate(State state, const char* type, const PropertyMap& userProps) const {
+    if (this->rules.Empty()) {
+        return Rules::Include;
+    }
+    const Rules::Rule* rule = this->Match(state, type, userProps, false);
+    return rule ? rule->NodeAction : this->rules.DefaultAction();
+}
+
+//------------------------------------------------------------------------------
+Rules::TangentMode
+RuleMatcher::EvaluateTangents(State state, const char* type, const PropertyMap& userProps) const {
+    const Rules::Rule* rule = this->Match(state, type, userProps, true);
+    return rule ? rule->Tangents : this->rules.DefaultTangents();
+}
+
+} // namespace FBXC
@@ -0,0 +1,72 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::RuleMatcher
+    @brief evaluates compiled Rules against the nodes of a scene
+
+    Runs the path trie of a Rules object as an automaton over node names:
+    a State stands for the set of trie nodes the path of a node has
+    reached, the state of a child is Step(parent state, child name).
+    States and their transitions are built on demand and cached, so a
+    node costs one hash lookup no matter how many rules there are,
+    only the rules whose path pattern ends in the node's state check
+    their type and attribute predicates.
+
+    Use one matcher per scene build, it's not thread-safe.
+*/
+#include "Rules.h"
+#include "PropertyMap.h"
+#include <map>
+
+namespace FBXC {
+
+class RuleMatcher {
+public:
+    /// a matcher state
+    typedef int State;
+
+    /// constructor
+    RuleMatcher(const Rules& rules);
+    /// state of the root node
+    State Root() const;
+    /// state of a child node
+    State Step(State parent, const char* name);
+    /// return the last rule matching a node which has an action, or a 'tangents' key if tangents is true (or nullptr)
+    const Rules::Rule* Match(State state, const char* type, const PropertyMap& userProps, bool tangents) const;
+    /// return the action for a node (Include if there are no rules)
+    Rules::Action Evaluate(State state, const char* type, const PropertyMap& userProps) const;
+    /// return the tangent mode for a node (the rules file default if no rule matches)
+    Rules::TangentMode EvaluateTangents(State state, const char* type, const PropertyMap& userProps) const;
+
+private:
+    /// a set of trie nodes
+    struct DfaState {
+        /// trie nodes, sorted
+        std::vector<int> TrieNodes;
+        /// rules whose pattern ends in one of the trie nodes, sorted
+        std::vector<int> Accept;
+        /// true if every name leads back to this state
+        bool LoopsOnAll = false;
+        /// cached transitions by node name
+        std::unordered_map<std::string, State> Next;
+    };
+    /// the state for a set of trie nodes (adds '**' nodes reachable without a segment)
+    State Lookup(std::vector<int>& trieNodes);
+    /// return true if a rule's type and attribute predicates hold
+    static bool Check(const Rules::Rule& rule, const char* type, const PropertyMap& userProps);
+
+    /// the dead state (no pattern can match anymore)
+    static const State Dead = -1;
+
+    const Rules& rules;
+    std::vector<DfaState> states;
+    std::map<std::vector<int>, State> stateIndex;
+};
+
+//------------------------------------------------------------------------------
+inline RuleMatcher::State
+RuleMatcher::Root() const {
+    return 0;
+}
+
+} // namespace FBXC
@@ -0,0 +1,206 @@
+//------------------------------------------------------------------------------
+//  Rules.cc
+//------------------------------------------------------------------------------
+#include "Rules.h"
+#include "Log.h"
+#include "cpptoml.h"
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+bool
+Rules::Match(const char* pattern, const char* str) {
+    // iterative wildcard match, backtracks to the last '*'
+    const char* starPattern = nullptr;
+    const char* starStr = nullptr;
+    while (*str) {
+        if ((*pattern == '?') || (*pattern == *str)) {
+            pattern++;
+            str++;
+        }
+        else if (*pattern == '*') {
+            starPattern = pattern++;
+            starStr = str;
+        }
+        else if (starPattern) {
+            pattern = starPattern + 1;
+            str = ++starStr;
+        }
+        else {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return 0 == *pattern;
+}
+
+//------------------------------------------------------------------------------
+static Rules::Action
+parseAction(const std::string& str, const std::string& path) {
+    if (str == "include") {
+        return Rules::Include;
+    }
+    else if (str == "exclude") {
+        return Rules::Exclude;
+    }
+    else if (str == "keep") {
+        return Rules::Keep;
+    }
+    Log::Fatal("unknown action '%s' in rules file '%s', expected 'include', 'exclude' or 'keep'\n", str.c_str(), path.c_str());
+    return Rules::Include;
+}
+
+//------------------------------------------------------------------------------
+static Rules::TangentMode
+parseTangents(const std::string& str, const std::string& path) {
+    if (str == "keep") {
+        return Rules::KeepTangents;
+    }
+    else if (str == "regenerate") {
+        return Rules::RegenerateTangents;
+    }
+    Log::Fatal("unknown tangent mode '%s' in rules file '%s', expected 'keep' or 'regenerate'\n", str.c_str(), path.c_str());
+    return Rules::KeepTangents;
+}
+
+//------------------------------------------------------------------------------
+void
+Rules::Load(const std::string& path) {
+    this->rules.clear();
+    this->trie.clear();
+    this->trie.emplace_back();
+
+    std::shared_ptr<cpptoml::table> root;
+    try {
+        root = cpptoml::parse_file(path);
+    }
+    catch (const cpptoml::parse_exception& e) {
+        Log::Fatal("failed to parse rules file '%s': %s\n", path.c_str(), e.what());
+    }
+    for (const auto& keyValue : *root) {
+        if ((keyValue.first != "default") && (keyValue.first != "tangents") && (keyValue.first != "rule")) {
+            Log::Fatal("unknown key '%s' in rules file '%s'\n", keyValue.first.c_str(), path.c_str());
+        }
+    }
+
+    // for nodes which no rule with a 'tangents' key matches
+    auto tangentsValue = root->get_as<std::string>("tangents");
+    this->defaultTangents = tangentsValue ? parseTangents(*tangentsValue, path) : KeepTangents;
+
+    bool hasIncludes = false;
+    auto ruleTables = root->get_table_array("rule");
+    if (ruleTables) {
+        for (const auto& ruleTable : *ruleTables) {
+            for (const auto& keyValue : *ruleTable) {
+                const std::string& key = keyValue.first;
+                if ((key != "path") && (key != "type") && (key != "attributes") && (key != "action") && (key != "tangents")) {
+                    Log::Fatal("unknown key '%s' in rule %d of rules file '%s'\n", key.c_str(), (int) this->rules.size() + 1, path.c_str());
+                }
+            }
+            Rule rule;
+            auto action = ruleTable->get_as<std::string>("action");
+            auto tangents = ruleTable->get_as<std::string>("tangents");
+            // a rule with only a 'tangents' key leaves the node action alone
+            rule.HasAction = action || !tangents;
+            if (action) {
+                rule.NodeAction = parseAction(*action, path);
+            }
+            if (tangents) {
+                rule.HasTangents = true;
+                rule.Tangents = parseTangents(*tangents, path);
+            }
+            auto pathPattern = ruleTable->get_as<std::string>("path");
+            rule.Path = pathPattern ? *pathPattern : "**";
+            auto type = ruleTable->get_as<std::string>("type");
+            if (type) {
+                rule.Type = *type;
+            }
+            auto attrs = ruleTable->get_array_of<std::string>("attributes");
+            if (attrs) {
+                for (const std::string& attrStr : *attrs) {
+                    Attribute attr;
+                    const std::string::size_type sep = attrStr.find('=');
+                    attr.Name = attrStr.substr(0, sep);
+                    if (sep != std::string::npos) {
+                        attr.Value = attrStr.substr(sep + 1);
+                        attr.HasValue = true;
+                    }
+                    if (attr.Name.empty()) {
+                        Log::Fatal("empty attribute name in rule %d of rules file '%s'\n", (int) this->rules.size() + 1, path.c_str());
+                    }
+                    rule.Attributes.push_back(attr);
+                }
+            }
+            hasIncludes |= rule.HasAction && (Include == rule.NodeAction);
+            this->AddPattern(rule.Path, (int) this->rules.size());
+            this->rules.push_back(rule);
+        }
+    }
+    auto defaultValue = root->get_as<std::string>("default");
+    if (defaultValue) {
+        this->defaultAction = parseAction(*defaultValue, path);
+    }
+    else {
+        this->defaultAction = hasIncludes ? Exclude : Include;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Rules::AddPattern(const std::string& pattern, int ruleIndex) {
+    int cur = 0;
+    std::string::size_type start = 0;
+    while (start <= pattern.size()) {
+        std::string::size_type end = pattern.find('/', start);
+        if (end == std::string::npos) {
+            end = pattern.size();
+        }
+        const std::string segment = pattern.substr(start, end - start);
+        start = end + 1;
+        if (segment.empty()) {
+            continue;
+        }
+        // find or add the child for this segment, trie nodes are accessed by
+        // index since emplace_back() may reallocate
+        int next = -1;
+        if (segment == "**") {
+            next = this->trie[cur].AnySegments;
+            if (next < 0) {
+                next = (int) this->trie.size();
+                this->trie.emplace_back();
+                this->trie[next].IsAnySegments = true;
+                this->trie[cur].AnySegments = next;
+            }
+        }
+        else if (segment.find_first_of("*?") != std::string::npos) {
+            for (const auto& glob : this->trie[cur].Globs) {
+                if (glob.first == segment) {
+                    next = glob.second;
+                    break;
+                }
+            }
+            if (next < 0) {
+                next = (int) this->trie.size();
+                this->trie.emplace_back();
+                this->trie[cur].Globs.emplace_back(segment, next);
+            }
+        }
+        else {
+            auto it = this->trie[cur].Literals.find(segment);
+            if (it != this->trie[cur].Literals.end()) {
+                next = it->second;
+            }
+            else {
+                next = (int) this->trie.size();
+                this->trie.emplace_back();
+                this->trie[cur].Literals.emplace(segment, next);
+            }
+        }
+        cur = next;
+    }
+    this->trie[cur].Accept.push_back(ruleIndex);
+}
+
+} // namespace FBXC
@@ -0,0 +1,161 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::Rules
+    @brief node filter rules loaded from the --rules TOML file
+
+    Each [[rule]] table selects nodes by path, type and user properties
+    and includes or excludes them:
+
+        default = "exclude"             # action for nodes no rule matches
+        [[rule]]
+        path = "/collide/col_*"         # node names from the root, '/'-separated
+        type = "mesh"                   # optional node type
+        attributes = ["lod=0", "solid"] # optional user properties (name or name=glob)
+        action = "include"              # "exclude" or "keep", default is "include"
+        tangents = "regenerate"         # optional, "keep" or "regenerate"
+
+    Path segments may contain '*' and '?' wildcards, a '**' segment
+    matches any number of segments, a rule without path matches all
+    nodes. If several rules match a node, the last one wins. Without a
+    'default' key, unmatched nodes are excluded if there are include
+    rules, and included otherwise. An empty rules file includes all
+    nodes. Excluded nodes are dropped from the hierarchy, their
+    included descendants move up to the nearest included ancestor.
+    Meshes, materials and textures which no included node uses are
+    not built at all. "keep" includes a node and keeps it as a separate
+    node when the hierarchy is flattened (--flatten), e.g. the turret
+    of a tank which must rotate.
+
+    The 'tangents' key selects whether the meshes of a node export the
+    tangents of the FBX file ("keep") or get MikkTSpace tangents
+    generated from their normals and first UV set ("regenerate", see
+    TangentGenerator). The node action and the tangent mode are matched
+    separately: the action comes from the last matching rule with an
+    action, the tangent mode from the last matching rule with a
+    'tangents' key. A rule with a 'tangents' key but no 'action' only
+    sets the tangent mode, it is not an include rule and doesn't change
+    the action of the nodes it matches. A top-level 'tangents' key sets
+    the mode for nodes which no rule with a 'tangents' key matches, the
+    default is "keep". A mesh used by several nodes gets its tangents
+    regenerated if any of them asks for it.
+
+    All path patterns are compiled into a single trie of path segments
+    (rules with common prefixes share trie nodes), which RuleMatcher
+    runs as a lazily built automaton, one step per node.
+*/
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace FBXC {
+
+class Rules {
+public:
+    /// what to do with a matching node
+    enum Action {
+        Include,
+        Exclude,
+        Keep,       // include, and don't merge into the parent when flattening
+    };
+    /// what to do with the tangents of a matching node's meshes
+    enum TangentMode {
+        KeepTangents,       // export the source tangents (if any)
+        RegenerateTangents, // generate tangents from normals and texcoord0
+    };
+    /// a user property predicate
+    struct Attribute {
+        /// user property name
+        std::string Name;
+        /// glob for the property value as string
+        std::string Value;
+        /// false if the property only has to exist
+        bool HasValue = false;
+    };
+    /// a compiled rule
+    struct Rule {
+        /// false for rules which only set the tangent mode
+        bool HasAction = true;
+        Action NodeAction = Include;
+        /// true if the rule has a 'tangents' key
+        bool HasTangents = false;
+        TangentMode Tangents = KeepTangents;
+        /// node path glob, as written in the rules file
+        std::string Path;
+        /// node type, empty for any type
+        std::string Type;
+        std::vector<Attribute> Attributes;
+    };
+
+    /// load and compile a rules file, fatal error if invalid
+    void Load(const std::string& path);
+    /// return true if there are no rules (all nodes are included)
+    bool Empty() const;
+    /// number of rules
+    int NumRules() const;
+    /// get rule by index (rules file order)
+    const Rule& GetRule(int index) const;
+    /// action for nodes which no rule matches
+    Action DefaultAction() const;
+    /// tangent mode for nodes which no rule matches
+    TangentMode DefaultTangents() const;
+
+    /// return true if str matches a glob with '*' and '?' wildcards
+    static bool Match(const char* pattern, const char* str);
+
+private:
+    friend class RuleMatcher;
+
+    /// a node in the trie of path segments
+    struct TrieNode {
+        /// children by literal segment name
+        std::unordered_map<std::string, int> Literals;
+        /// children by segment glob
+        std::vector<std::pair<std::string, int>> Globs;
+        /// child for a '**' segment, or -1
+        int AnySegments = -1;
+        /// true if this node is the target of a '**' segment (loops on any segment)
+        bool IsAnySegments = false;
+        /// rules whose pattern ends here, ascending
+        std::vector<int> Accept;
+    };
+    /// add a rule's path pattern to the trie
+    void AddPattern(const std::string& pattern, int ruleIndex);
+
+    std::vector<Rule> rules;
+    std::vector<TrieNode> trie;
+    Action defaultAction = Include;
+    TangentMode defaultTangents = KeepTangents;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+Rules::Empty() const {
+    return this->rules.empty();
+}
+
+//------------------------------------------------------------------------------
+inline int
+Rules::NumRules() const {
+    return (int) this->rules.size();
+}
+
+//------------------------------------------------------------------------------
+inline const Rules::Rule&
+Rules::GetRule(int index) const {
+    return this->rules[index];
+}
+
+//------------------------------------------------------------------------------
+inline Rules::Action
+Rules::DefaultAction() const {
+    return this->defaultAction;
+}
+
+//------------------------------------------------------------------------------
+inline Rules::TangentMode
+Rules::DefaultTangents() const {
+    return this->defaultTangents;
+}
+
+} // namespace FBXC
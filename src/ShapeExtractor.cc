@@ -0,0 +1,162 @@
+//------------------------------------------------------------------------------
+//  ShapeExtractor.cc
+//------------------------------------------------------------------------------
+#include "ShapeExtractor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+bool
+ShapeExtractor::IsMoved(const MeshSource& src, const MeshSource::Shape& shape, int i, float epsilon) {
+    const std::int32_t point = shape.Indices[i];
+    if ((point < 0) || (point >= src.NumPoints)) {
+        return false;
+    }
+    for (int c = 0; c < 3; c++) {
+        if ((std::fabs(shape.Positions[i * 3 + c]) > epsilon) ||
+            (shape.Normals && (std::fabs(shape.Normals[i * 3 + c]) > epsilon))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ShapeExtractor::SetupWeldKeys(const MeshSource& src, float epsilon, MeshData& data) {
+    const int numPoints = src.NumPoints;
+
+    // the deltas moving each control point, in shape order
+    struct Delta {
+        int Shape;
+        float Values[6];
+    };
+    std::vector<int> starts(numPoints + 1, 0);
+    for (const MeshSource::Shape& shape : src.Shapes) {
+        for (int i = 0; i < shape.Num; i++) {
+            if (IsMoved(src, shape, i, epsilon)) {
+                starts[shape.Indices[i] + 1]++;
+            }
+        }
+    }
+    for (int p = 0; p < numPoints; p++) {
+        starts[p + 1] += starts[p];
+    }
+    if (0 == starts[numPoints]) {
+        return;
+    }
+    std::vector<Delta> deltas(starts[numPoints]);
+    std::vector<int> fill(starts.begin(), starts.end() - 1);
+    for (std::size_t s = 0; s < src.Shapes.size(); s++) {
+        const MeshSource::Shape& shape = src.Shapes[s];
+        for (int i = 0; i < shape.Num; i++) {
+            if (IsMoved(src, shape, i, epsilon)) {
+                Delta& delta = deltas[fill[shape.Indices[i]]++];
+                delta.Shape = (int) s;
+                for (int c = 0; c < 3; c++) {
+                    delta.Values[c] = (float) shape.Positions[i * 3 + c];
+                    delta.Values[3 + c] = shape.Normals ? (float) shape.Normals[i * 3 + c] : 0.0f;
+                }
+            }
+        }
+    }
+
+    // control points moved identically by all shapes (e.g. duplicated
+    // points along UV seams) share a weld key, unmoved points get key 0
+    auto deltaLess = [](const Delta& a, const Delta& b) {
+        if (a.Shape != b.Shape) {
+            return a.Shape < b.Shape;
+        }
+        return std::lexicographical_compare(a.Values, a.Values + 6, b.Values, b.Values + 6);
+    };
+    auto pointLess = [&starts, &deltas, &deltaLess](int a, int b) {
+        return std::lexicographical_compare(deltas.begin() + starts[a], deltas.begin() + starts[a + 1],
+                                            deltas.begin() + starts[b], deltas.begin() + starts[b + 1], deltaLess);
+    };
+    std::vector<int> order(numPoints);
+    for (int p = 0; p < numPoints; p++) {
+        order[p] = p;
+    }
+    std::sort(order.begin(), order.end(), pointLess);
+    std::vector<std::uint32_t> pointKeys(numPoints, 0);
+    std::uint32_t key = 0;
+    for (int k = 0; k < numPoints; k++) {
+        if ((k > 0) && pointLess(order[k - 1], order[k])) {
+            key++;
+        }
+        pointKeys[order[k]] = key;
+    }
+    data.WeldKeys.resize(data.NumVertices);
+    for (int v = 0; v < data.NumVertices; v++) {
+        const std::int32_t point = data.PointIndices[v];
+        data.WeldKeys[v] = ((point >= 0) && (point < numPoints)) ? pointKeys[point] : 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ShapeExtractor::Extract(const MeshSource& src, float epsilon, MeshData& data) {
+    const int numPoints = src.NumPoints;
+
+    // the vertices of each control point, in ascending order
+    std::vector<int> starts(numPoints + 1, 0);
+    for (int v = 0; v < data.NumVertices; v++) {
+        const std::int32_t point = data.PointIndices[v];
+        if ((point >= 0) && (point < numPoints)) {
+            starts[point + 1]++;
+        }
+    }
+    for (int p = 0; p < numPoints; p++) {
+        starts[p + 1] += starts[p];
+    }
+    std::vector<std::uint32_t> pointVertices(starts[numPoints]);
+    std::vector<int> fill(starts.begin(), starts.end() - 1);
+    for (int v = 0; v < data.NumVertices; v++) {
+        const std::int32_t point = data.PointIndices[v];
+        if ((point >= 0) && (point < numPoints)) {
+            pointVertices[fill[point]++] = v;
+        }
+    }
+
+    // each shape only visits its own control points, (vertex, delta) pairs
+    // are sorted by vertex, a vertex listed twice keeps its first delta
+    data.Shapes.resize(src.Shapes.size());
+    std::vector<std::pair<std::uint32_t, int>> moved;
+    for (std::size_t s = 0; s < src.Shapes.size(); s++) {
+        const MeshSource::Shape& srcShape = src.Shapes[s];
+        MeshData::Shape& dstShape = data.Shapes[s];
+        moved.clear();
+        for (int i = 0; i < srcShape.Num; i++) {
+            if (IsMoved(src, srcShape, i, epsilon)) {
+                const std::int32_t point = srcShape.Indices[i];
+                for (int k = starts[point]; k < starts[point + 1]; k++) {
+                    moved.push_back(std::make_pair(pointVertices[k], i));
+                }
+            }
+        }
+        std::sort(moved.begin(), moved.end());
+        moved.erase(std::unique(moved.begin(), moved.end(),
+            [](const std::pair<std::uint32_t, int>& a, const std::pair<std::uint32_t, int>& b) {
+                return a.first == b.first;
+            }), moved.end());
+
+        const bool hasNormals = srcShape.Normals && data.Has(MeshData::Normal);
+        dstShape.Vertices.resize(moved.size());
+        dstShape.Positions.resize(moved.size() * 3);
+        dstShape.Normals.resize(hasNormals ? moved.size() * 3 : 0);
+        for (std::size_t m = 0; m < moved.size(); m++) {
+            const int i = moved[m].second;
+            dstShape.Vertices[m] = moved[m].first;
+            for (int c = 0; c < 3; c++) {
+                dstShape.Positions[m * 3 + c] = (float) srcShape.Positions[i * 3 + c];
+                if (hasNormals) {
+                    dstShape.Normals[m * 3 + c] = (float) srcShape.Normals[i * 3 + c];
+                }
+            }
+        }
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ShapeExtractor
+    @brief sparse per-vertex blend shape deltas from the shapes of a mesh
+
+    A shape moves a control point if the largest absolute component of
+    its position or normal delta is above epsilon. SetupWeldKeys() runs
+    before welding and gives control points which are moved the same by
+    all shapes the same weld key, so vertices which a shape would move
+    apart are not welded. Extract() runs after the processing
+    stages on the final vertices (or on each piece of a split mesh),
+    so the sparse vertex indices line up with the exported vertex order.
+*/
+#include "MeshSource.h"
+#include "MeshData.h"
+
+namespace FBXC {
+
+class ShapeExtractor {
+public:
+    /// set weld keys so that only vertices with identical shape deltas are welded
+    static void SetupWeldKeys(const MeshSource& src, float epsilon, MeshData& data);
+    /// add the sparse deltas of each source shape for the vertices of data
+    static void Extract(const MeshSource& src, float epsilon, MeshData& data);
+
+private:
+    /// return true if a shape moves the control point of its i-th delta
+    static bool IsMoved(const MeshSource& src, const MeshSource::Shape& shape, int i, float epsilon);
+};
+
+} // namespace FBXC
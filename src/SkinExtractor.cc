@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+//  SkinExtractor.cc
+//------------------------------------------------------------------------------
+#include "SkinExtractor.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FBXC_USE_SSE2 (1)
+#include <emmintrin.h>
+#endif
+
+namespace FBXC {
+
+#if FBXC_USE_SSE2
+//------------------------------------------------------------------------------
+/// per lane: mask ? a : b
+static inline __m128
+blend(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
+//------------------------------------------------------------------------------
+void
+SkinExtractor::SelectInfluences(const MeshSource& src, int maxInfluences, std::vector<float>& outJoints, std::vector<float>& outWeights) {
+    const int numPoints = src.NumPoints;
+    const int num = std::min(std::max(maxInfluences, 1), (int) MaxInfluences);
+
+    // gather the influences of each control point into a contiguous run
+    std::vector<int> starts(numPoints + 1, 0);
+    for (const MeshSource::Cluster& cluster : src.Clusters) {
+        for (int i = 0; i < cluster.Num; i++) {
+            const int point = cluster.Indices[i];
+            if ((point >= 0) && (point < numPoints) && (cluster.Weights[i] > 0.0)) {
+                starts[point + 1]++;
+            }
+        }
+    }
+    for (int p = 0; p < numPoints; p++) {
+        starts[p + 1] += starts[p];
+    }
+    std::vector<float> candJoints(starts[numPoints]);
+    std::vector<float> candWeights(starts[numPoints]);
+    std::vector<int> fill(starts.begin(), starts.end() - 1);
+    for (std::size_t joint = 0; joint < src.Clusters.size(); joint++) {
+        const MeshSource::Cluster& cluster = src.Clusters[joint];
+        for (int i = 0; i < cluster.Num; i++) {
+            const int point = cluster.Indices[i];
+            if ((point >= 0) && (point < numPoints) && (cluster.Weights[i] > 0.0)) {
+                candJoints[fill[point]] = (float) joint;
+                candWeights[fill[point]] = (float) cluster.Weights[i];
+                fill[point]++;
+            }
+        }
+    }
+
+    outJoints.assign(numPoints * MaxInfluences, 0.0f);
+    outWeights.assign(numPoints * MaxInfluences, 0.0f);
+    int p = 0;
+    #if FBXC_USE_SSE2
+    // one control point per lane, a candidate replaces the first slot with a
+    // smaller weight and the displaced influence moves on to the next slot
+    for (; p + 4 <= numPoints; p += 4) {
+        __m128 weights[MaxInfluences];
+        __m128 joints[MaxInfluences];
+        for (int s = 0; s < num; s++) {
+            weights[s] = _mm_setzero_ps();
+            joints[s] = _mm_setzero_ps();
+        }
+        int maxCount = 0;
+        for (int l = 0; l < 4; l++) {
+            maxCount = std::max(maxCount, starts[p + l + 1] - starts[p + l]);
+        }
+        for (int k = 0; k < maxCount; k++) {
+            float cw[4], cj[4];
+            for (int l = 0; l < 4; l++) {
+                const int c = starts[p + l] + k;
+                const bool valid = c < starts[p + l + 1];
+                cw[l] = valid ? candWeights[c] : 0.0f;
+                cj[l] = valid ? candJoints[c] : 0.0f;
+            }
+            __m128 w = _mm_loadu_ps(cw);
+            __m128 j = _mm_loadu_ps(cj);
+            for (int s = 0; s < num; s++) {
+                const __m128 greater = _mm_cmpgt_ps(w, weights[s]);
+                const __m128 keptW = weights[s];
+                const __m128 keptJ = joints[s];
+                weights[s] = blend(greater, w, keptW);
+                joints[s] = blend(greater, j, keptJ);
+                w = blend(greater, keptW, w);
+                j = blend(greater, keptJ, j);
+            }
+        }
+        __m128 sum = weights[0];
+        for (int s = 1; s < num; s++) {
+            sum = _mm_add_ps(sum, weights[s]);
+        }
+        const __m128 invSum = _mm_and_ps(_mm_cmpgt_ps(sum, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.0f), sum));
+        for (int s = 0; s < num; s++) {
+            float w[4], j[4];
+            _mm_storeu_ps(w, _mm_mul_ps(weights[s], invSum));
+            _mm_storeu_ps(j, joints[s]);
+            for (int l = 0; l < 4; l++) {
+                outWeights[(p + l) * MaxInfluences + s] = w[l];
+                outJoints[(p + l) * MaxInfluences + s] = j[l];
+            }
+        }
+    }
+    #endif
+    for (; p < numPoints; p++) {
+        float weights[MaxInfluences] = { };
+        float joints[MaxInfluences] = { };
+        for (int c = starts[p]; c < starts[p + 1]; c++) {
+            float w = candWeights[c];
+            float j = candJoints[c];
+            for (int s = 0; s < num; s++) {
+                if (w > weights[s]) {
+                    std::swap(w, weights[s]);
+                    std::swap(j, joints[s]);
+                }
+            }
+        }
+        float sum = weights[0];
+        for (int s = 1; s < num; s++) {
+            sum += weights[s];
+        }
+        const float invSum = (sum > 0.0f) ? (1.0f / sum) : 0.0f;
+        for (int s = 0; s < num; s++) {
+            outWeights[p * MaxInfluences + s] = weights[s] * invSum;
+            outJoints[p * MaxInfluences + s] = joints[s];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+SkinExtractor::Extract(const MeshSource& src, int maxInfluences, MeshData& data) {
+    if (src.Clusters.empty()) {
+        return;
+    }
+    std::vector<float> pointJoints;
+    std::vector<float> pointWeights;
+    SelectInfluences(src, maxInfluences, pointJoints, pointWeights);
+
+    const int numStreams = (maxInfluences > 4) ? 2 : 1;
+    static const MeshData::Component jointComps[2] = { MeshData::Joints0, MeshData::Joints1 };
+    static const MeshData::Component weightComps[2] = { MeshData::Weights0, MeshData::Weights1 };
+    for (int i = 0; i < numStreams; i++) {
+        std::vector<float>& joints = data.Streams[jointComps[i]];
+        std::vector<float>& weights = data.Streams[weightComps[i]];
+        joints.assign(data.NumVertices * 4, 0.0f);
+        weights.assign(data.NumVertices * 4, 0.0f);
+        for (int v = 0; v < data.NumVertices; v++) {
+            const int point = data.PointIndices[v];
+            if ((point >= 0) && (point < src.NumPoints)) {
+                std::memcpy(&joints[v * 4], &pointJoints[point * MaxInfluences + i * 4], 4 * sizeof(float));
+                std::memcpy(&weights[v * 4], &pointWeights[point * MaxInfluences + i * 4], 4 * sizeof(float));
+            }
+        }
+    }
+}
+
+} // namespace FBXC
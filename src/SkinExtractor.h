@@ -0,0 +1,38 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::SkinExtractor
+    @brief per-vertex skin influences from the skin clusters of a mesh
+
+    The influences of each control point are gathered from all clusters
+    (cluster i is joint i of the mesh), the strongest maxInfluences are
+    kept, sorted by descending weight, and renormalized to a sum of 1.
+    Control points without influences get all-zero weights. The
+    selection runs on 4 control points at once: each candidate passes
+    through a branchless insertion network of the kept slots, with
+    SSE2 where available and a scalar fallback which produces identical
+    results.
+
+    Extract() runs after MeshExtractor and before welding: the
+    influences are copied to each vertex through its control point
+    index into the Joints0/Weights0 streams (and Joints1/Weights1 for
+    more than 4 influences), so welding only merges vertices with
+    identical influences and remaps them like every other component.
+*/
+#include "MeshSource.h"
+#include "MeshData.h"
+
+namespace FBXC {
+
+class SkinExtractor {
+public:
+    /// max. number of influences per vertex
+    static const int MaxInfluences = 8;
+
+    /// add skin streams with up to maxInfluences influences per vertex, does nothing if the mesh has no skin
+    static void Extract(const MeshSource& src, int maxInfluences, MeshData& data);
+    /// select the influences of each control point, MaxInfluences joints and weights per point
+    static void SelectInfluences(const MeshSource& src, int maxInfluences, std::vector<float>& outJoints, std::vector<float>& outWeights);
+};
+
+} // namespace FBXC
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+//  StringPool.cc
+//------------------------------------------------------------------------------
+#include "StringPool.h"
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace FBXC {
+
+namespace {
+
+//------------------------------------------------------------------------------
+/// open-addressing set of string pointers, strings live in never-freed blocks
+class Pool {
+public:
+    const char* Intern(const char* str, std::size_t len) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if ((this->num + 1) * 2 > this->slots.size()) {
+            this->Grow();
+        }
+        const std::size_t mask = this->slots.size() - 1;
+        std::size_t i = Hash(str, len) & mask;
+        while (const char* entry = this->slots[i]) {
+            if ((0 == std::strncmp(entry, str, len)) && (0 == entry[len])) {
+                return entry;
+            }
+            i = (i + 1) & mask;
+        }
+        char* copy = this->Alloc(len + 1);
+        std::memcpy(copy, str, len);
+        copy[len] = 0;
+        this->slots[i] = copy;
+        this->num++;
+        return copy;
+    }
+
+private:
+    static std::uint32_t Hash(const char* str, std::size_t len) {
+        std::uint32_t h = 2166136261u;
+        for (std::size_t i = 0; i < len; i++) {
+            h = (h ^ (std::uint8_t) str[i]) * 16777619u;
+        }
+        return h;
+    }
+    void Grow() {
+        std::vector<const char*> old;
+        old.swap(this->slots);
+        this->slots.resize(old.empty() ? 256 : old.size() * 2, nullptr);
+        const std::size_t mask = this->slots.size() - 1;
+        for (const char* entry : old) {
+            if (entry) {
+                std::size_t i = Hash(entry, std::strlen(entry)) & mask;
+                while (this->slots[i]) {
+                    i = (i + 1) & mask;
+                }
+                this->slots[i] = entry;
+            }
+        }
+    }
+    char* Alloc(std::size_t size) {
+        const std::size_t blockSize = 16 * 1024;
+        if (size > blockSize) {
+            this->bigBlocks.emplace_back(new char[size]);
+            return this->bigBlocks.back().get();
+        }
+        if (this->blocks.empty() || (this->blockPos + size > blockSize)) {
+            this->blocks.emplace_back(new char[blockSize]);
+            this->blockPos = 0;
+        }
+        char* ptr = this->blocks.back().get() + this->blockPos;
+        this->blockPos += size;
+        return ptr;
+    }
+
+    std::mutex mutex;
+    std::vector<const char*> slots;
+    std::size_t num = 0;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::unique_ptr<char[]>> bigBlocks;
+    std::size_t blockPos = 0;
+};
+
+//------------------------------------------------------------------------------
+Pool&
+pool() {
+    static Pool instance;
+    return instance;
+}
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+const char*
+StringPool::Intern(const char* str) {
+    assert(str);
+    return pool().Intern(str, std::strlen(str));
+}
+
+//------------------------------------------------------------------------------
+const char*
+StringPool::Intern(const std::string& str) {
+    return pool().Intern(str.c_str(), str.size());
+}
+
+} // namespace FBXC
@@ -0,0 +1,23 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::StringPool
+    @brief global pool of interned strings
+
+    Intern() returns the same pointer for equal strings, the pointers
+    stay valid until the process exits. Meant for strings from a small,
+    mostly fixed set, like property keys. Thread-safe.
+*/
+#include <string>
+
+namespace FBXC {
+
+class StringPool {
+public:
+    /// return the interned copy of a string
+    static const char* Intern(const char* str);
+    /// return the interned copy of a string
+    static const char* Intern(const std::string& str);
+};
+
+} // namespace FBXC
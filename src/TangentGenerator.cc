@@ -0,0 +1,334 @@
+//------------------------------------------------------------------------------
+//  TangentGenerator.cc
+//------------------------------------------------------------------------------
+#include "TangentGenerator.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+/// call func(first, end) for consecutive ranges of ItemsPerJob items, on the pool if there is one
+static void
+forEachJob(ThreadPool* pool, int num, const std::function<void(int, int)>& func) {
+    const int perJob = TangentGenerator::ItemsPerJob;
+    const int numJobs = (num + perJob - 1) / perJob;
+    auto job = [num, perJob, &func](int i) {
+        func(i * perJob, std::min(num, (i + 1) * perJob));
+    };
+    if (pool) {
+        pool->ParallelFor(numJobs, job);
+    }
+    else {
+        for (int i = 0; i < numJobs; i++) {
+            job(i);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// same test as MikkTSpace's NotZero()
+static inline bool
+notZero(float f) {
+    return (f < -FLT_MIN) || (f > FLT_MIN);
+}
+
+//------------------------------------------------------------------------------
+static inline float
+dot(const float* a, const float* b) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+//------------------------------------------------------------------------------
+/// remove the component along n and normalize, unless the result is zero
+static inline void
+projectAndNormalize(const float* n, float* v) {
+    const float d = dot(n, v);
+    v[0] -= d * n[0];
+    v[1] -= d * n[1];
+    v[2] -= d * n[2];
+    if (notZero(v[0]) || notZero(v[1]) || notZero(v[2])) {
+        const float invLen = 1.0f / std::sqrt(dot(v, v));
+        v[0] *= invLen;
+        v[1] *= invLen;
+        v[2] *= invLen;
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+TangentGenerator::BuildGroups(const MeshData& data, std::vector<std::uint32_t>& outGroups) {
+    // position, normal and texcoord0 bits, compared like MeshWelder does
+    const int numWords = 8;
+    const int numVerts = data.NumVertices;
+    std::vector<std::uint32_t> keys(numVerts * numWords);
+    const float* pos = data.Streams[MeshData::Position].data();
+    const float* nrm = data.Streams[MeshData::Normal].data();
+    const float* uv = data.Streams[MeshData::TexCoord0].data();
+    for (int v = 0; v < numVerts; v++) {
+        const float vals[numWords] = {
+            pos[v * 3 + 0], pos[v * 3 + 1], pos[v * 3 + 2],
+            nrm[v * 3 + 0], nrm[v * 3 + 1], nrm[v * 3 + 2],
+            uv[v * 2 + 0], uv[v * 2 + 1]
+        };
+        for (int w = 0; w < numWords; w++) {
+            // adding 0.0f turns -0.0f into +0.0f
+            const float f = vals[w] + 0.0f;
+            std::memcpy(&keys[v * numWords + w], &f, sizeof(f));
+        }
+    }
+
+    std::uint32_t capacity = 16;
+    while (capacity < (std::uint32_t) numVerts * 2) {
+        capacity <<= 1;
+    }
+    const std::uint32_t mask = capacity - 1;
+    const std::uint32_t empty = 0xFFFFFFFF;
+    std::vector<std::uint32_t> slots(capacity, empty);
+    outGroups.resize(numVerts);
+    int numGroups = 0;
+    for (int v = 0; v < numVerts; v++) {
+        const std::uint32_t* key = keys.data() + v * numWords;
+        std::uint32_t h = 2166136261u;
+        for (int w = 0; w < numWords; w++) {
+            h = (h ^ key[w]) * 16777619u;
+        }
+        h ^= h >> 16;
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35;
+        h ^= h >> 16;
+        std::uint32_t slot = h & mask;
+        for (;;) {
+            const std::uint32_t other = slots[slot];
+            if (empty == other) {
+                slots[slot] = v;
+                outGroups[v] = numGroups++;
+                break;
+            }
+            if (0 == std::memcmp(key, keys.data() + other * numWords, numWords * sizeof(std::uint32_t))) {
+                outGroups[v] = outGroups[other];
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+    return numGroups;
+}
+
+//------------------------------------------------------------------------------
+void
+TangentGenerator::Generate(MeshData& data, ThreadPool* pool) {
+    const int numTris = data.NumTriangles();
+    if ((0 == numTris) || !data.Has(MeshData::Position) || !data.Has(MeshData::Normal) || !data.Has(MeshData::TexCoord0)) {
+        return;
+    }
+    std::vector<std::uint32_t> groups;
+    const int numGroups = BuildGroups(data, groups);
+
+    // per triangle: the UV orientation and whether it contributes (non-zero
+    // UV area, no collapsed corners), per corner: the triangle's tangent
+    // direction projected onto the corner normal, weighted by the corner angle
+    const std::uint8_t contributes = 1;
+    const std::uint8_t preserving = 2;
+    std::vector<std::uint8_t> triFlags(numTris);
+    std::vector<float> cornerTangents(numTris * 9, 0.0f);
+    forEachJob(pool, numTris, [&data, &groups, &triFlags, &cornerTangents, contributes, preserving](int first, int end) {
+        const float* pos = data.Streams[MeshData::Position].data();
+        const float* nrm = data.Streams[MeshData::Normal].data();
+        const float* uv = data.Streams[MeshData::TexCoord0].data();
+        for (int t = first; t < end; t++) {
+            const std::uint32_t* tri = data.Indices.data() + t * 3;
+            const float* p0 = pos + tri[0] * 3;
+            const float* p1 = pos + tri[1] * 3;
+            const float* p2 = pos + tri[2] * 3;
+            const float* t0 = uv + tri[0] * 2;
+            const float* t1 = uv + tri[1] * 2;
+            const float* t2 = uv + tri[2] * 2;
+            const float t21x = t1[0] - t0[0];
+            const float t21y = t1[1] - t0[1];
+            const float t31x = t2[0] - t0[0];
+            const float t31y = t2[1] - t0[1];
+            const float signedArea = t21x * t31y - t21y * t31x;
+            std::uint8_t flags = (signedArea > 0.0f) ? preserving : 0;
+            const bool collapsed = (groups[tri[0]] == groups[tri[1]]) || (groups[tri[1]] == groups[tri[2]]) || (groups[tri[0]] == groups[tri[2]]);
+            if (notZero(signedArea) && !collapsed) {
+                flags |= contributes;
+                float os[3];
+                for (int i = 0; i < 3; i++) {
+                    os[i] = t31y * (p1[i] - p0[i]) - t21y * (p2[i] - p0[i]);
+                }
+                const float lenOs = std::sqrt(dot(os, os));
+                if (notZero(lenOs)) {
+                    const float s = ((signedArea > 0.0f) ? 1.0f : -1.0f) / lenOs;
+                    os[0] *= s;
+                    os[1] *= s;
+                    os[2] *= s;
+                }
+                for (int c = 0; c < 3; c++) {
+                    const float* p = pos + tri[c] * 3;
+                    const float* prev = pos + tri[(c + 2) % 3] * 3;
+                    const float* next = pos + tri[(c + 1) % 3] * 3;
+                    const float* n = nrm + tri[c] * 3;
+                    float vOs[3] = { os[0], os[1], os[2] };
+                    float v1[3] = { prev[0] - p[0], prev[1] - p[1], prev[2] - p[2] };
+                    float v2[3] = { next[0] - p[0], next[1] - p[1], next[2] - p[2] };
+                    projectAndNormalize(n, vOs);
+                    projectAndNormalize(n, v1);
+                    projectAndNormalize(n, v2);
+                    const float angle = std::acos(std::min(std::max(dot(v1, v2), -1.0f), 1.0f));
+                    float* out = cornerTangents.data() + (t * 3 + c) * 3;
+                    out[0] = angle * vOs[0];
+                    out[1] = angle * vOs[1];
+                    out[2] = angle * vOs[2];
+                }
+            }
+            triFlags[t] = flags;
+        }
+    });
+
+    // each group splits into a mirrored and a preserving slot, corners of
+    // non-contributing triangles take the orientation of the first
+    // contributing triangle in their group
+    const int numSlots = numGroups * 2;
+    const int numCorners = numTris * 3;
+    std::vector<std::int8_t> groupOrient(numGroups, -1);
+    for (int i = 0; i < numCorners; i++) {
+        const std::uint8_t flags = triFlags[i / 3];
+        std::int8_t& orient = groupOrient[groups[data.Indices[i]]];
+        if ((flags & contributes) && (orient < 0)) {
+            orient = (flags & preserving) ? 1 : 0;
+        }
+    }
+    std::vector<std::uint32_t> cornerSlots(numCorners);
+    std::vector<int> slotStarts(numSlots + 1, 0);
+    for (int i = 0; i < numCorners; i++) {
+        const std::uint8_t flags = triFlags[i / 3];
+        const std::uint32_t group = groups[data.Indices[i]];
+        int orient = (flags & preserving) ? 1 : 0;
+        if (!(flags & contributes) && (groupOrient[group] >= 0)) {
+            orient = groupOrient[group];
+        }
+        cornerSlots[i] = group * 2 + orient;
+        if (flags & contributes) {
+            slotStarts[cornerSlots[i] + 1]++;
+        }
+    }
+    for (int s = 0; s < numSlots; s++) {
+        slotStarts[s + 1] += slotStarts[s];
+    }
+    std::vector<int> slotCorners(slotStarts[numSlots]);
+    std::vector<int> fill(slotStarts.begin(), slotStarts.end() - 1);
+    for (int i = 0; i < numCorners; i++) {
+        if (triFlags[i / 3] & contributes) {
+            slotCorners[fill[cornerSlots[i]]++] = i;
+        }
+    }
+
+    // sum the corner contributions of each slot in corner order
+    std::vector<float> slotTangents(numSlots * 3, 0.0f);
+    forEachJob(pool, numSlots, [&slotStarts, &slotCorners, &cornerTangents, &slotTangents](int first, int end) {
+        for (int s = first; s < end; s++) {
+            float* sum = slotTangents.data() + s * 3;
+            for (int j = slotStarts[s]; j < slotStarts[s + 1]; j++) {
+                const float* src = cornerTangents.data() + slotCorners[j] * 3;
+                sum[0] += src[0];
+                sum[1] += src[1];
+                sum[2] += src[2];
+            }
+            if (notZero(sum[0]) || notZero(sum[1]) || notZero(sum[2])) {
+                const float invLen = 1.0f / std::sqrt(dot(sum, sum));
+                sum[0] *= invLen;
+                sum[1] *= invLen;
+                sum[2] *= invLen;
+            }
+        }
+    });
+
+    // a vertex used in both orientations is duplicated for the second one
+    const int numSrcVerts = data.NumVertices;
+    const std::uint32_t noVertex = 0xFFFFFFFF;
+    std::vector<std::int32_t> vertexSlots(numSrcVerts, -1);
+    std::vector<std::uint32_t> duplicates(numSrcVerts, noVertex);
+    std::vector<std::uint32_t> duplicateSources;
+    for (int i = 0; i < numCorners; i++) {
+        const std::uint32_t v = data.Indices[i];
+        const std::int32_t slot = (std::int32_t) cornerSlots[i];
+        if (vertexSlots[v] < 0) {
+            vertexSlots[v] = slot;
+        }
+        else if (vertexSlots[v] != slot) {
+            if (noVertex == duplicates[v]) {
+                duplicates[v] = (std::uint32_t) (numSrcVerts + duplicateSources.size());
+                duplicateSources.push_back(v);
+                vertexSlots.push_back(slot);
+            }
+            data.Indices[i] = duplicates[v];
+        }
+    }
+    if (!duplicateSources.empty()) {
+        for (int i = 0; i < MeshData::NumComponents; i++) {
+            const MeshData::Component comp = (MeshData::Component) i;
+            if (!data.Has(comp)) {
+                continue;
+            }
+            const int size = MeshData::ComponentSize(comp);
+            std::vector<float>& stream = data.Streams[comp];
+            stream.resize((numSrcVerts + duplicateSources.size()) * size);
+            for (std::size_t j = 0; j < duplicateSources.size(); j++) {
+                std::memcpy(&stream[(numSrcVerts + j) * size], &stream[duplicateSources[j] * size], size * sizeof(float));
+            }
+        }
+        for (std::uint32_t v : duplicateSources) {
+            data.PointIndices.push_back(data.PointIndices[v]);
+            if (!data.WeldKeys.empty()) {
+                data.WeldKeys.push_back(data.WeldKeys[v]);
+            }
+        }
+        data.NumVertices += (int) duplicateSources.size();
+    }
+
+    // write tangents with the handedness in w, and the binormals if the
+    // mesh has them, vertices without a tangent (no contributing triangle
+    // or not referenced) get an arbitrary one perpendicular to the normal
+    const int numVerts = data.NumVertices;
+    const bool hasBinormals = data.Has(MeshData::Binormal);
+    data.Streams[MeshData::Tangent].resize(numVerts * 4);
+    forEachJob(pool, numVerts, [&data, &vertexSlots, &slotTangents, hasBinormals](int first, int end) {
+        const float* nrm = data.Streams[MeshData::Normal].data();
+        float* tangents = data.Streams[MeshData::Tangent].data();
+        float* binormals = hasBinormals ? data.Streams[MeshData::Binormal].data() : nullptr;
+        for (int v = first; v < end; v++) {
+            const float* n = nrm + v * 3;
+            const std::int32_t slot = vertexSlots[v];
+            float t[3] = { 0.0f, 0.0f, 0.0f };
+            if (slot >= 0) {
+                const float* src = slotTangents.data() + slot * 3;
+                t[0] = src[0];
+                t[1] = src[1];
+                t[2] = src[2];
+            }
+            if (!(notZero(t[0]) || notZero(t[1]) || notZero(t[2]))) {
+                t[0] = (std::fabs(n[0]) < 0.9f) ? 1.0f : 0.0f;
+                t[1] = 1.0f - t[0];
+                projectAndNormalize(n, t);
+            }
+            const float w = ((slot < 0) || (slot & 1)) ? 1.0f : -1.0f;
+            float* dst = tangents + v * 4;
+            dst[0] = t[0];
+            dst[1] = t[1];
+            dst[2] = t[2];
+            dst[3] = w;
+            if (binormals) {
+                float* b = binormals + v * 3;
+                b[0] = w * (n[1] * t[2] - n[2] * t[1]);
+                b[1] = w * (n[2] * t[0] - n[0] * t[2]);
+                b[2] = w * (n[0] * t[1] - n[1] * t[0]);
+            }
+        }
+    });
+}
+
+} // namespace FBXC
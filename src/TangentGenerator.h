@@ -0,0 +1,49 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::TangentGenerator
+    @brief MikkTSpace-compatible tangents from normals and texcoord0
+
+    Runs on the extracted triangle data before welding, for the meshes
+    whose nodes have the 'regenerate' tangent mode (see Rules). Follows
+    the default MikkTSpace setup: each triangle gets a tangent direction
+    from its position and UV derivatives (flipped for triangles with
+    mirrored UVs), every triangle corner contributes that direction
+    projected onto the vertex normal and weighted by the corner angle,
+    and the contributions are summed over all corners which share
+    position, normal, texcoord0 and UV orientation. Triangles with zero
+    UV area don't contribute and join the orientation of the first
+    contributing triangle at the vertex. Unlike MikkTSpace, corners are
+    grouped by their vertex attributes rather than by walking triangle
+    fans, which gives the same result on manifold meshes.
+
+    The tangent w is the handedness (+1, or -1 for mirrored UVs), an
+    existing binormal stream is replaced with w * cross(normal, tangent).
+    A vertex used by triangles of both orientations is duplicated, so
+    that each orientation gets its own tangent. Meshes without normals
+    or texcoord0 are left unchanged.
+
+    The per-triangle, per-group and per-vertex passes are split into
+    jobs of ItemsPerJob items which run on the thread pool (if any),
+    sums are always built in corner order, so the result doesn't depend
+    on the number of threads.
+*/
+#include "MeshData.h"
+#include "ThreadPool.h"
+
+namespace FBXC {
+
+class TangentGenerator {
+public:
+    /// number of triangles, groups or vertices per parallel job
+    static const int ItemsPerJob = 16384;
+
+    /// replace the tangents (and binormals) of extracted mesh data, pool may be nullptr
+    static void Generate(MeshData& data, ThreadPool* pool);
+
+private:
+    /// assign vertices with identical position, normal and texcoord0 the same group, returns number of groups
+    static int BuildGroups(const MeshData& data, std::vector<std::uint32_t>& outGroups);
+};
+
+} // namespace FBXC
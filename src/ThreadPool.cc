@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+//  ThreadPool.cc
+//------------------------------------------------------------------------------
+#include "ThreadPool.h"
+#include <cassert>
+
+namespace FBXC {
+
+/// true while the current thread executes ParallelFor iterations
+static thread_local bool insideBatch = false;
+
+//------------------------------------------------------------------------------
+ThreadPool::ThreadPool() :
+    next(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+ThreadPool::~ThreadPool() {
+    if (this->isValid) {
+        this->Discard();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPool::Setup(int numThreads) {
+    assert(!this->isValid);
+    if (numThreads <= 0) {
+        numThreads = (int) std::thread::hardware_concurrency();
+        if (numThreads <= 0) {
+            numThreads = 1;
+        }
+    }
+    this->quit = false;
+    // the calling thread also works on batches
+    for (int i = 0; i < numThreads - 1; i++) {
+        this->workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+    this->isValid = true;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPool::Discard() {
+    assert(this->isValid);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->quit = true;
+    }
+    this->wakeup.notify_all();
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+    this->workers.clear();
+    this->isValid = false;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPool::ParallelFor(int num_, const std::function<void(int)>& func_) {
+    if ((num_ <= 1) || this->workers.empty() || insideBatch) {
+        for (int i = 0; i < num_; i++) {
+            func_(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> batchLock(this->batchMutex);
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->func = &func_;
+        this->num = num_;
+        this->next = 0;
+        this->busyWorkers = (int) this->workers.size();
+        this->batchId++;
+    }
+    this->wakeup.notify_all();
+    this->RunBatch();
+
+    // wait until all workers have left the batch
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done.wait(lock, [this] { return 0 == this->busyWorkers; });
+    this->func = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPool::RunBatch() {
+    insideBatch = true;
+    int i;
+    while ((i = this->next.fetch_add(1)) < this->num) {
+        (*this->func)(i);
+    }
+    insideBatch = false;
+}
+
+//------------------------------------------------------------------------------
+void
+ThreadPool::WorkerLoop() {
+    unsigned int lastBatchId = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->wakeup.wait(lock, [this, lastBatchId] {
+                return this->quit || (this->batchId != lastBatchId);
+            });
+            if (this->quit) {
+                return;
+            }
+            lastBatchId = this->batchId;
+        }
+        this->RunBatch();
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (0 == --this->busyWorkers) {
+                this->done.notify_one();
+            }
+        }
+    }
+}
+
+} // namespace FBXC
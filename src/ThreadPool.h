@@ -0,0 +1,74 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::ThreadPool
+    @brief a simple fixed-size worker thread pool
+
+    ParallelFor() distributes loop iterations over the worker threads
+    and the calling thread, and returns when all iterations are done.
+    A ParallelFor() issued from inside a running ParallelFor() is
+    executed serially on the calling thread.
+*/
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace FBXC {
+
+class ThreadPool {
+public:
+    /// constructor
+    ThreadPool();
+    /// destructor
+    ~ThreadPool();
+
+    /// start worker threads (0: one thread per hardware thread)
+    void Setup(int numThreads);
+    /// stop worker threads
+    void Discard();
+    /// return true if the pool has been setup
+    bool IsValid() const;
+    /// number of threads working on a ParallelFor (including the caller)
+    int NumThreads() const;
+    /// call func(i) for i in [0, num), blocks until all calls have returned
+    void ParallelFor(int num, const std::function<void(int)>& func);
+
+private:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// worker thread entry
+    void WorkerLoop();
+    /// process items of the current batch until exhausted
+    void RunBatch();
+
+    bool isValid = false;
+    std::vector<std::thread> workers;
+    std::mutex batchMutex;          // serializes ParallelFor calls
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable done;
+    const std::function<void(int)>* func = nullptr;
+    int num = 0;
+    std::atomic<int> next;
+    int busyWorkers = 0;
+    unsigned int batchId = 0;
+    bool quit = false;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+ThreadPool::IsValid() const {
+    return this->isValid;
+}
+
+//------------------------------------------------------------------------------
+inline int
+ThreadPool::NumThreads() const {
+    return (int) this->workers.size() + 1;
+}
+
+} // namespace FBXC
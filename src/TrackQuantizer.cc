@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+//  TrackQuantizer.cc
+//------------------------------------------------------------------------------
+#include "TrackQuantizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+/// index of the largest absolute component of a quaternion
+static int
+largestComponent(const float* q) {
+    int largest = 0;
+    for (int c = 1; c < 4; c++) {
+        if (std::fabs(q[c]) > std::fabs(q[largest])) {
+            largest = c;
+        }
+    }
+    return largest;
+}
+
+//------------------------------------------------------------------------------
+bool
+TrackQuantizer::IsIdentity(const AnimTrack& track, float tolerance) {
+    if (track.Keys.size() != 1) {
+        return false;
+    }
+    const float* v = track.Values.data();
+    switch (track.Chn) {
+        case AnimTrack::Translation:
+            return (std::fabs(v[0]) <= tolerance) && (std::fabs(v[1]) <= tolerance) && (std::fabs(v[2]) <= tolerance);
+        case AnimTrack::Rotation:
+            return (std::fabs(v[0]) <= tolerance) && (std::fabs(v[1]) <= tolerance) && (std::fabs(v[2]) <= tolerance) &&
+                   (std::fabs(std::fabs(v[3]) - 1.0f) <= tolerance);
+        case AnimTrack::Scaling:
+            return (std::fabs(v[0] - 1.0f) <= tolerance) && (std::fabs(v[1] - 1.0f) <= tolerance) && (std::fabs(v[2] - 1.0f) <= tolerance);
+        default:
+            return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TrackQuantizer::QuantizeRange(const std::vector<float>& values, int size, int bits, std::vector<std::uint16_t>& out, float* outMin, float* outExtent) {
+    const int num = (int) values.size() / size;
+    const float maxQ = (float) ((1 << bits) - 1);
+    out.resize(values.size());
+    for (int c = 0; c < size; c++) {
+        float lo = values[c];
+        float hi = values[c];
+        for (int i = 1; i < num; i++) {
+            lo = std::min(lo, values[i * size + c]);
+            hi = std::max(hi, values[i * size + c]);
+        }
+        outMin[c] = lo;
+        outExtent[c] = hi - lo;
+        const float scale = (hi > lo) ? maxQ / (hi - lo) : 0.0f;
+        for (int i = 0; i < num; i++) {
+            const float q = std::floor((values[i * size + c] - lo) * scale + 0.5f);
+            out[i * size + c] = (std::uint16_t) std::min(std::max(q, 0.0f), maxQ);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TrackQuantizer::PackRotations(AnimTrack& track, int bits, std::vector<std::uint16_t>& out) {
+    const int num = (int) track.Keys.size();
+    if ((num > 0) && (track.Values[largestComponent(track.Values.data())] < 0.0f)) {
+        for (float& v : track.Values) {
+            v = -v;
+        }
+        for (float& t : track.Tangents) {
+            t = -t;
+        }
+    }
+    const int compBits = bits - 1;
+    const float maxQ = (float) ((1 << compBits) - 1);
+    const float sqrt2 = std::sqrt(2.0f);
+    out.resize(num * 3);
+    for (int i = 0; i < num; i++) {
+        const float* q = &track.Values[i * 4];
+        const int largest = largestComponent(q);
+        const float sign = (q[largest] < 0.0f) ? -1.0f : 1.0f;
+        std::uint16_t* dst = &out[i * 3];
+        for (int c = 0, j = 0; c < 4; c++) {
+            if (c != largest) {
+                const float unorm = (sign * q[c] * sqrt2 + 1.0f) * 0.5f;
+                dst[j++] = (std::uint16_t) std::min(std::max(std::floor(unorm * maxQ + 0.5f), 0.0f), maxQ);
+            }
+        }
+        dst[0] |= (std::uint16_t) ((largest >> 1) << compBits);
+        dst[1] |= (std::uint16_t) ((largest & 1) << compBits);
+    }
+}
+
+} // namespace FBXC
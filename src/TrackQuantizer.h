@@ -0,0 +1,39 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::TrackQuantizer
+    @brief quantize the keys of reduced animation tracks
+
+    Translation, scaling and tangent values are quantized into the value
+    range of their track, per component, to unsigned integers of 'bits'
+    bits: v = min + q / (2^bits - 1) * extent.
+
+    Rotations are packed as 'smallest three': the largest component of
+    the quaternion is dropped and made positive by negating the
+    quaternion, the other three (in xyzw order, within +-1/sqrt(2))
+    are stored with bits-1 bits: c = (q / (2^(bits-1) - 1) * 2 - 1) / sqrt(2).
+    The index of the dropped component is stored in the top bit of the
+    first (high bit) and second (low bit) value, the dropped component
+    is sqrt(1 - x^2 - y^2 - z^2). The track is negated up front so that
+    its first key doesn't change sign, decoded keys are then brought
+    back into the track's hemisphere by negating each key whose dot
+    product with its predecessor is negative, which also makes the
+    Hermite tangents (quantized by range) match the keys.
+*/
+#include "AnimTrack.h"
+#include <cstdint>
+#include <vector>
+
+namespace FBXC {
+
+class TrackQuantizer {
+public:
+    /// return true if a track is a single key with the channel's identity value (within tolerance)
+    static bool IsIdentity(const AnimTrack& track, float tolerance);
+    /// quantize values with size components into their per-component range, outMin/outExtent get size values
+    static void QuantizeRange(const std::vector<float>& values, int size, int bits, std::vector<std::uint16_t>& out, float* outMin, float* outExtent);
+    /// pack the keys of a rotation track as smallest three, may negate the track's values and tangents
+    static void PackRotations(AnimTrack& track, int bits, std::vector<std::uint16_t>& out);
+};
+
+} // namespace FBXC
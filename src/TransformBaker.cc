@@ -0,0 +1,174 @@
+//------------------------------------------------------------------------------
+//  TransformBaker.cc
+//------------------------------------------------------------------------------
+#include "TransformBaker.h"
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FBXC_USE_SSE2 (1)
+#include <emmintrin.h>
+#endif
+
+namespace FBXC {
+
+#if FBXC_USE_SSE2
+//------------------------------------------------------------------------------
+/// x' = m0 * x + m1 * y + m2 * z + m3 for 4 vertices
+static inline __m128
+dot4(const float* row, __m128 x, __m128 y, __m128 z) {
+    __m128 r = _mm_mul_ps(_mm_set1_ps(row[0]), x);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(row[1]), y));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(row[2]), z));
+    return _mm_add_ps(r, _mm_set1_ps(row[3]));
+}
+
+//------------------------------------------------------------------------------
+/// normalize 4 vectors, zero-length vectors stay zero
+static inline void
+normalize4(__m128& x, __m128& y, __m128& z) {
+    const __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    const __m128 nonZero = _mm_cmpgt_ps(lenSq, _mm_setzero_ps());
+    const __m128 invLen = _mm_and_ps(nonZero, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lenSq)));
+    const __m128 keep = _mm_andnot_ps(nonZero, _mm_set1_ps(1.0f));
+    const __m128 scale = _mm_or_ps(invLen, keep);
+    x = _mm_mul_ps(x, scale);
+    y = _mm_mul_ps(y, scale);
+    z = _mm_mul_ps(z, scale);
+}
+#endif
+
+//------------------------------------------------------------------------------
+void
+TransformBaker::TransformStream(float* xyz, int stride, int num, const float* m34, bool normalize) {
+    int i = 0;
+    #if FBXC_USE_SSE2
+    if (3 == stride) {
+        // 4 packed xyz triples are 3 registers: x0y0z0x1 y1z1x2y2 z2x3y3z3
+        for (; i + 4 <= num; i += 4) {
+            float* p = xyz + i * 3;
+            const __m128 a = _mm_loadu_ps(p);
+            const __m128 b = _mm_loadu_ps(p + 4);
+            const __m128 c = _mm_loadu_ps(p + 8);
+            const __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 3, 0)),
+                                            _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+            const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                            _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                                            _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 tx = dot4(m34, x, y, z);
+            __m128 ty = dot4(m34 + 4, x, y, z);
+            __m128 tz = dot4(m34 + 8, x, y, z);
+            if (normalize) {
+                normalize4(tx, ty, tz);
+            }
+            _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(tx, ty, _MM_SHUFFLE(0, 0, 0, 0)),
+                                            _mm_shuffle_ps(tz, tx, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(ty, tz, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                _mm_shuffle_ps(tx, ty, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+            _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(tz, tx, _MM_SHUFFLE(3, 3, 2, 2)),
+                                                _mm_shuffle_ps(ty, tz, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+        }
+    }
+    else if (4 == stride) {
+        // xyzw quadruples are a 4x4 transpose, w is passed through
+        for (; i + 4 <= num; i += 4) {
+            float* p = xyz + i * 4;
+            __m128 x = _mm_loadu_ps(p);
+            __m128 y = _mm_loadu_ps(p + 4);
+            __m128 z = _mm_loadu_ps(p + 8);
+            __m128 w = _mm_loadu_ps(p + 12);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            __m128 tx = dot4(m34, x, y, z);
+            __m128 ty = dot4(m34 + 4, x, y, z);
+            __m128 tz = dot4(m34 + 8, x, y, z);
+            if (normalize) {
+                normalize4(tx, ty, tz);
+            }
+            _MM_TRANSPOSE4_PS(tx, ty, tz, w);
+            _mm_storeu_ps(p, tx);
+            _mm_storeu_ps(p + 4, ty);
+            _mm_storeu_ps(p + 8, tz);
+            _mm_storeu_ps(p + 12, w);
+        }
+    }
+    #endif
+    for (; i < num; i++) {
+        float* p = xyz + i * stride;
+        const float x = p[0], y = p[1], z = p[2];
+        float tx = ((m34[0] * x + m34[1] * y) + m34[2] * z) + m34[3];
+        float ty = ((m34[4] * x + m34[5] * y) + m34[6] * z) + m34[7];
+        float tz = ((m34[8] * x + m34[9] * y) + m34[10] * z) + m34[11];
+        if (normalize) {
+            const float lenSq = (tx * tx + ty * ty) + tz * tz;
+            if (lenSq > 0.0f) {
+                const float invLen = 1.0f / std::sqrt(lenSq);
+                tx *= invLen;
+                ty *= invLen;
+                tz *= invLen;
+            }
+        }
+        p[0] = tx;
+        p[1] = ty;
+        p[2] = tz;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+TransformBaker::Bake(MeshData& data, const Matrix44& m) {
+    if (m.IsIdentity()) {
+        return;
+    }
+
+    // row-major 3x4 matrices, the direction matrices have no translation
+    float posMatrix[12];
+    float dirMatrix[12];
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 4; col++) {
+            posMatrix[row * 4 + col] = (float) m.Get(row, col);
+            dirMatrix[row * 4 + col] = (col < 3) ? (float) m.Get(row, col) : 0.0f;
+        }
+    }
+    // the cofactor matrix is the inverse-transpose scaled by the
+    // determinant, which doesn't matter since normals are renormalized,
+    // but a negative determinant must not flip the normals
+    const double det = m.Determinant3x3();
+    const double sign = (det < 0.0) ? -1.0 : 1.0;
+    float normalMatrix[12] = { };
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            const int r0 = (row + 1) % 3, r1 = (row + 2) % 3;
+            const int c0 = (col + 1) % 3, c1 = (col + 2) % 3;
+            const double cofactor = m.Get(r0, c0) * m.Get(r1, c1) - m.Get(r0, c1) * m.Get(r1, c0);
+            normalMatrix[row * 4 + col] = (float) (sign * cofactor);
+        }
+    }
+
+    const int num = data.NumVertices;
+    if (data.Has(MeshData::Position)) {
+        TransformStream(data.Streams[MeshData::Position].data(), 3, num, posMatrix, false);
+    }
+    if (data.Has(MeshData::Normal)) {
+        TransformStream(data.Streams[MeshData::Normal].data(), 3, num, normalMatrix, true);
+    }
+    if (data.Has(MeshData::Tangent)) {
+        TransformStream(data.Streams[MeshData::Tangent].data(), 4, num, dirMatrix, true);
+    }
+    if (data.Has(MeshData::Binormal)) {
+        TransformStream(data.Streams[MeshData::Binormal].data(), 3, num, dirMatrix, true);
+    }
+    if (det < 0.0) {
+        if (data.Has(MeshData::Tangent)) {
+            float* tangents = data.Streams[MeshData::Tangent].data();
+            for (int i = 0; i < num; i++) {
+                tangents[i * 4 + 3] = -tangents[i * 4 + 3];
+            }
+        }
+        for (std::size_t i = 0; i + 2 < data.Indices.size(); i += 3) {
+            std::swap(data.Indices[i + 1], data.Indices[i + 2]);
+        }
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,32 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::TransformBaker
+    @brief bake a transform into the vertex streams of a mesh
+
+    Positions are transformed by the full matrix, normals by the
+    inverse-transpose (the cofactors) of the upper 3x3 part, tangents
+    and binormals by the upper 3x3 part, directions are renormalized.
+    A mirroring transform flips the tangent handedness and the triangle
+    winding, so that front faces stay front faces.
+
+    The streams are transformed in batches of 4 vertices with SSE2
+    (the xyz triples are transposed into x, y and z registers), with a
+    scalar loop for the remainder and for builds without SSE2.
+*/
+#include "MeshData.h"
+#include "Matrix44.h"
+
+namespace FBXC {
+
+class TransformBaker {
+public:
+    /// transform vertex positions, normals, tangents and binormals in place
+    static void Bake(MeshData& data, const Matrix44& m);
+
+private:
+    /// transform xyz triples (stride floats apart) by a 3x4 matrix (row-major), optionally normalize
+    static void TransformStream(float* xyz, int stride, int num, const float* m34, bool normalize);
+};
+
+} // namespace FBXC
@@ -3,19 +3,128 @@
 //------------------------------------------------------------------------------
 #include "Value.h"
 #include <cassert>
+#include <cstring>
+#include <new>
 #include <fbxsdk.h>
 
 namespace FBXC {
 
 //------------------------------------------------------------------------------
 Value::Value() :
-    type(Void) {
+    idValue(0) {
     // empty
 }
 
+//------------------------------------------------------------------------------
+Value::~Value() {
+    this->Clear();
+}
+
+//------------------------------------------------------------------------------
+Value::Value(const Value& rhs) :
+    idValue(0) {
+    this->CopyFrom(rhs);
+}
+
+//------------------------------------------------------------------------------
+Value::Value(Value&& rhs) noexcept :
+    idValue(0) {
+    this->MoveFrom(rhs);
+}
+
+//------------------------------------------------------------------------------
+Value&
+Value::operator=(const Value& rhs) {
+    if (this != &rhs) {
+        this->Clear();
+        this->CopyFrom(rhs);
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+Value&
+Value::operator=(Value&& rhs) noexcept {
+    if (this != &rhs) {
+        this->Clear();
+        this->MoveFrom(rhs);
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+void
+Value::Clear() {
+    if (Array == this->type) {
+        this->arrayValue.~vector();
+    }
+    else if ((String == this->type) && this->heapString) {
+        delete[] this->heapStringValue;
+    }
+    this->type = Void;
+    this->heapString = false;
+    this->idValue = 0;
+}
+
+//------------------------------------------------------------------------------
+void
+Value::CopyFrom(const Value& rhs) {
+    assert(Void == this->type);
+    if (Array == rhs.type) {
+        new (&this->arrayValue) std::vector<Value>(rhs.arrayValue);
+        this->type = Array;
+    }
+    else if (String == rhs.type) {
+        this->SetString(rhs.GetString(), std::strlen(rhs.GetString()));
+    }
+    else {
+        std::memcpy(this->floatValues, rhs.floatValues, sizeof(this->floatValues));
+        this->type = rhs.type;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Value::MoveFrom(Value& rhs) {
+    assert(Void == this->type);
+    if (Array == rhs.type) {
+        new (&this->arrayValue) std::vector<Value>(std::move(rhs.arrayValue));
+        this->type = Array;
+        rhs.Clear();
+    }
+    else {
+        // inline data and heap string pointers are taken over as is
+        std::memcpy(this->floatValues, rhs.floatValues, sizeof(this->floatValues));
+        this->type = rhs.type;
+        this->heapString = rhs.heapString;
+        rhs.type = Void;
+        rhs.heapString = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+Value::SetString(const char* str, std::size_t len) {
+    // copy before clearing, str may point into this value
+    char small[MaxSmallString + 1];
+    char* dst = (len > MaxSmallString) ? new char[len + 1] : small;
+    std::memcpy(dst, str, len);
+    dst[len] = 0;
+    this->Clear();
+    if (dst == small) {
+        std::memcpy(this->smallString, small, len + 1);
+    }
+    else {
+        this->heapStringValue = dst;
+        this->heapString = true;
+    }
+    this->type = String;
+}
+
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(bool val) {
+    this->Clear();
     this->type = Bool;
     this->boolValue = val;
 }
@@ -23,6 +132,7 @@ Value::Set(bool val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(std::int32_t val) {
+    this->Clear();
     this->type = Int;
     this->intValue = val;
 }
@@ -30,6 +140,7 @@ Value::Set(std::int32_t val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(std::uint64_t val) {
+    this->Clear();
     this->type = Id;
     this->idValue = val;
 }
@@ -37,6 +148,7 @@ Value::Set(std::uint64_t val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(double val) {
+    this->Clear();
     this->type = Float;
     this->floatValues[0] = val;
 }
@@ -44,6 +156,7 @@ Value::Set(double val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(FbxDouble2 val) {
+    this->Clear();
     this->type = Float2;
     for (int i = 0; i < 2; i++) {
         this->floatValues[i] = val.mData[i];
@@ -53,6 +166,7 @@ Value::Set(FbxDouble2 val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(FbxDouble3 val) {
+    this->Clear();
     this->type = Float3;
     for (int i = 0; i < 3; i++) {
         this->floatValues[i] = val.mData[i];
@@ -62,6 +176,7 @@ Value::Set(FbxDouble3 val) {
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(FbxDouble4 val) {
+    this->Clear();
     this->type = Float4;
     for (int i = 0; i < 4; i++) {
         this->floatValues[i] = val.mData[i];
@@ -72,29 +187,51 @@ Value::Set(FbxDouble4 val) {
 template<> void
 Value::Set(const char* str) {
     assert(str);
-    this->type = String;
-    this->strValue = str;
+    this->SetString(str, std::strlen(str));
 }
 
 //------------------------------------------------------------------------------
 template<> void
 Value::Set(FbxString str) {
-    this->type = String;
-    this->strValue = str.Buffer();
+    this->SetString(str.Buffer(), std::strlen(str.Buffer()));
 }
 
 //------------------------------------------------------------------------------
-template<> void
-Value::Set(std::string str) {
-    this->type = String;
-    this->strValue = str;
+void
+Value::Set(const std::string& str) {
+    this->SetString(str.c_str(), str.size());
 }
 
 //------------------------------------------------------------------------------
-template<> void
-Value::Set(std::vector<Value> valArray) {
+void
+Value::Set(const std::vector<Value>& values) {
+    // copy before clearing, values may be this value's array
+    std::vector<Value> copy(values);
+    this->Clear();
+    new (&this->arrayValue) std::vector<Value>(std::move(copy));
+    this->type = Array;
+}
+
+//------------------------------------------------------------------------------
+void
+Value::Set(std::vector<Value>&& values) {
+    this->Clear();
+    new (&this->arrayValue) std::vector<Value>(std::move(values));
     this->type = Array;
-    this->arrayValue = valArray;
+}
+
+//------------------------------------------------------------------------------
+const char*
+Value::GetString() const {
+    assert(String == this->type);
+    return this->heapString ? this->heapStringValue : this->smallString;
+}
+
+//------------------------------------------------------------------------------
+const std::vector<Value>&
+Value::GetArray() const {
+    assert(Array == this->type);
+    return this->arrayValue;
 }
 
 //------------------------------------------------------------------------------
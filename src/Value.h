@@ -3,6 +3,12 @@
 /**
     @class FBXC::Value
     @brief multi-type value of a property
+
+    A compact tagged union (40 bytes): scalars and vectors are stored
+    inline, strings of up to 31 characters are stored inline, longer
+    strings in a single heap buffer. Arrays keep their elements in a
+    std::vector which is constructed in place, Set() with an rvalue
+    array takes over the vector's buffer without copying the elements.
 */
 #include <cstdint>
 #include <string>
@@ -13,7 +19,7 @@ namespace FBXC {
 class Value {
 public:
     /// types
-    enum Type {
+    enum Type : std::uint8_t {
         Void,
         Bool,           // bool value
         Id,             // 64 bit unsigned integer used as unique id
@@ -28,21 +34,65 @@ public:
 
     /// default constructor
     Value();
-    
+    /// destructor
+    ~Value();
+    /// copy constructor
+    Value(const Value& rhs);
+    /// move constructor
+    Value(Value&& rhs) noexcept;
+    /// copy assignment
+    Value& operator=(const Value& rhs);
+    /// move assignment
+    Value& operator=(Value&& rhs) noexcept;
+
     /// set value
     template<typename TYPE> void Set(TYPE t);
+    /// set string value
+    void Set(const std::string& str);
+    /// set array value (copies the elements)
+    void Set(const std::vector<Value>& values);
+    /// set array value (takes over the elements)
+    void Set(std::vector<Value>&& values);
     /// get value
     template<typename TYPE> TYPE Get() const;
-    
-    Type type;
-    std::string strValue;
+
+    /// get value type
+    Type GetType() const;
+    /// get string value (type must be String)
+    const char* GetString() const;
+    /// get array elements (type must be Array)
+    const std::vector<Value>& GetArray() const;
+
+private:
+    /// set a string value of known length
+    void SetString(const char* str, std::size_t len);
+    /// destroy heap data and set type to Void
+    void Clear();
+    /// copy from another value (this must be Void)
+    void CopyFrom(const Value& rhs);
+    /// move from another value (this must be Void), rhs becomes Void
+    void MoveFrom(Value& rhs);
+
+    /// max length of inline strings
+    static const std::size_t MaxSmallString = 31;
+
+    Type type = Void;
+    bool heapString = false;
     union {
         bool boolValue;
         std::int32_t intValue;
         std::uint64_t idValue;
         double floatValues[4];
+        char smallString[MaxSmallString + 1];
+        char* heapStringValue;
+        std::vector<Value> arrayValue;
     };
-    std::vector<Value> arrayValue;
 };
 
+//------------------------------------------------------------------------------
+inline Value::Type
+Value::GetType() const {
+    return this->type;
+}
+
 } // namespace FBXC
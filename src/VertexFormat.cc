@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+//  VertexFormat.cc
+//------------------------------------------------------------------------------
+#include "VertexFormat.h"
+#include <cassert>
+
+namespace FBXC {
+
+static const struct {
+    const char* name;
+    int numComponents;
+    int byteSize;
+} formatInfos[VertexFormat::NumCodes] = {
+    { "float", 1, 4 },
+    { "float2", 2, 8 },
+    { "float3", 3, 12 },
+    { "float4", 4, 16 },
+    { "byte4n", 4, 4 },
+    { "ubyte4n", 4, 4 },
+    { "short2n", 2, 4 },
+    { "short4n", 4, 8 },
+    { "half2", 2, 4 },
+    { "half4", 4, 8 },
+    { "uint10n2", 4, 4 },
+    { "int10n2", 4, 4 },
+    { "ubyte4", 4, 4 },
+    { "ushort4", 4, 8 },
+    { "ushort4n", 4, 8 },
+};
+
+//------------------------------------------------------------------------------
+const char*
+VertexFormat::ToString(Code c) {
+    assert((c >= 0) && (c < NumCodes));
+    return formatInfos[c].name;
+}
+
+//------------------------------------------------------------------------------
+VertexFormat::Code
+VertexFormat::FromString(const std::string& str) {
+    for (int i = 0; i < NumCodes; i++) {
+        if (str == formatInfos[i].name) {
+            return (Code) i;
+        }
+    }
+    return Invalid;
+}
+
+//------------------------------------------------------------------------------
+int
+VertexFormat::NumComponents(Code c) {
+    assert((c >= 0) && (c < NumCodes));
+    return formatInfos[c].numComponents;
+}
+
+//------------------------------------------------------------------------------
+int
+VertexFormat::ByteSize(Code c) {
+    assert((c >= 0) && (c < NumCodes));
+    return formatInfos[c].byteSize;
+}
+
+//------------------------------------------------------------------------------
+VertexFormat::Code
+VertexFormat::FloatFormat(int numComponents) {
+    assert((numComponents >= 1) && (numComponents <= 4));
+    return (Code) (Float + numComponents - 1);
+}
+
+} // namespace FBXC
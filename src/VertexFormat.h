@@ -0,0 +1,52 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::VertexFormat
+    @brief output formats of vertex components
+
+    The 'N' formats are normalized, signed formats map [-1, 1] and
+    unsigned formats map [0, 1] to the full integer range. UByte4 and
+    UShort4 are not normalized, values are rounded and clamped to the
+    integer range.
+*/
+#include <string>
+
+namespace FBXC {
+
+class VertexFormat {
+public:
+    /// format codes
+    enum Code {
+        Float,
+        Float2,
+        Float3,
+        Float4,
+        Byte4N,
+        UByte4N,
+        Short2N,
+        Short4N,
+        Half2,
+        Half4,
+        UInt10N2,   // 10:10:10:2 unsigned normalized
+        Int10N2,    // 10:10:10:2 signed normalized
+        UByte4,     // unsigned integers (e.g. joint indices)
+        UShort4,
+        UShort4N,
+
+        NumCodes,
+        Invalid,
+    };
+
+    /// convert format code to string (as used in JSON output and cmdline args)
+    static const char* ToString(Code c);
+    /// convert string to format code, returns Invalid if no match
+    static Code FromString(const std::string& str);
+    /// get number of components of a format
+    static int NumComponents(Code c);
+    /// get byte size of a format
+    static int ByteSize(Code c);
+    /// get the float format with a number of components (1..4)
+    static Code FloatFormat(int numComponents);
+};
+
+} // namespace FBXC
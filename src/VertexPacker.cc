@@ -0,0 +1,591 @@
+//------------------------------------------------------------------------------
+//  VertexPacker.cc
+//------------------------------------------------------------------------------
+#include "VertexPacker.h"
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FBXC_USE_SSE2 (1)
+#include <emmintrin.h>
+#endif
+
+namespace FBXC {
+
+//------------------------------------------------------------------------------
+std::uint16_t
+VertexPacker::FloatToHalf(float f) {
+    // see https://gist.github.com/rygorous/2156668 (float_to_half_fast3_rtne)
+    const std::uint32_t f32infty = 255 << 23;
+    const std::uint32_t f16max = (127 + 16) << 23;
+    const std::uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+    std::uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    const std::uint32_t sign = u & 0x80000000;
+    u ^= sign;
+    std::uint32_t o;
+    if (u >= f16max) {
+        // Inf or NaN
+        o = (u > f32infty) ? 0x7e00 : 0x7c00;
+    }
+    else if (u < (113 << 23)) {
+        // subnormal or zero
+        float af, magic;
+        std::memcpy(&af, &u, sizeof(af));
+        std::memcpy(&magic, &denormMagic, sizeof(magic));
+        af += magic;
+        std::memcpy(&u, &af, sizeof(u));
+        o = u - denormMagic;
+    }
+    else {
+        const std::uint32_t mantOdd = (u >> 13) & 1;
+        u += ((std::uint32_t)(15 - 127) << 23) + 0xfff;
+        u += mantOdd;
+        o = u >> 13;
+    }
+    return (std::uint16_t) (o | (sign >> 16));
+}
+
+#if FBXC_USE_SSE2
+typedef __m128 vec4;
+
+//------------------------------------------------------------------------------
+template<int NUM> inline vec4 load(const float* src);
+template<> inline vec4 load<2>(const float* src) {
+    return _mm_castpd_ps(_mm_load_sd((const double*) src));
+}
+template<> inline vec4 load<3>(const float* src) {
+    return _mm_setr_ps(src[0], src[1], src[2], 0.0f);
+}
+template<> inline vec4 load<4>(const float* src) {
+    return _mm_loadu_ps(src);
+}
+
+//------------------------------------------------------------------------------
+/// clamp, scale and round to int32
+inline __m128i
+quantize(vec4 v, float lo, float hi, float scale) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(lo)), _mm_set1_ps(hi));
+    return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(scale)));
+}
+
+//------------------------------------------------------------------------------
+inline __m128i
+quantize(vec4 v, float lo, float hi, const float (&scale)[4]) {
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(lo)), _mm_set1_ps(hi));
+    return _mm_cvtps_epi32(_mm_mul_ps(v, _mm_loadu_ps(scale)));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeFloats(vec4 v, int num, std::uint8_t* dst) {
+    float f[4];
+    _mm_storeu_ps(f, v);
+    std::memcpy(dst, f, num * sizeof(float));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeInts(__m128i v, std::int32_t (&out)[4]) {
+    _mm_storeu_si128((__m128i*) out, v);
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeByte4(__m128i i, bool isSigned, std::uint8_t* dst) {
+    const __m128i s16 = _mm_packs_epi32(i, i);
+    const __m128i s8 = isSigned ? _mm_packs_epi16(s16, s16) : _mm_packus_epi16(s16, s16);
+    const std::int32_t bits = _mm_cvtsi128_si32(s8);
+    std::memcpy(dst, &bits, 4);
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeShorts(__m128i i, int num, std::uint8_t* dst) {
+    std::int16_t s[8];
+    _mm_storeu_si128((__m128i*) s, _mm_packs_epi32(i, i));
+    std::memcpy(dst, s, num * sizeof(std::int16_t));
+}
+
+//------------------------------------------------------------------------------
+/// SSE2 has no unsigned 32-to-16 bit pack, so the values are biased into the signed range
+inline void
+storeUShorts(__m128i i, int num, std::uint8_t* dst) {
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i s16 = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(i, bias), _mm_sub_epi32(i, bias)), _mm_set1_epi16((short) 0x8000));
+    std::uint16_t s[8];
+    _mm_storeu_si128((__m128i*) s, s16);
+    std::memcpy(dst, s, num * sizeof(std::uint16_t));
+}
+
+//------------------------------------------------------------------------------
+/// SSE2 version of VertexPacker::FloatToHalf(), one half per 32-bit lane
+inline __m128i
+toHalfs(vec4 f) {
+    const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i nanBit = _mm_set1_epi32(0x200);
+    const __m128i infinity = _mm_set1_epi32(0x7c00);
+    const __m128i minNormal = _mm_set1_epi32((127 - 14) << 23);
+    const __m128i subnormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+    const vec4 justSign = _mm_and_ps(_mm_castsi128_ps(_mm_set1_epi32(0x80000000)), f);
+    const vec4 absf = _mm_xor_ps(f, justSign);
+    const __m128i absfInt = _mm_castps_si128(absf);
+    const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+    const __m128i isRegular = _mm_cmpgt_epi32(f16max, absfInt);
+    const __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, nanBit), infinity);
+    const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absfInt);
+
+    const vec4 subnorm1 = _mm_add_ps(absf, _mm_castsi128_ps(subnormMagic));
+    const __m128i subnorm2 = _mm_sub_epi32(_mm_castps_si128(subnorm1), subnormMagic);
+
+    const __m128i mantOdd = _mm_srai_epi32(_mm_slli_epi32(absfInt, 31 - 13), 31);
+    const __m128i round = _mm_sub_epi32(_mm_add_epi32(absfInt, normalBias), mantOdd);
+    const __m128i normal = _mm_srli_epi32(round, 13);
+
+    const __m128i nonSpecial = _mm_or_si128(_mm_and_si128(subnorm2, isSubnormal), _mm_andnot_si128(isSubnormal, normal));
+    const __m128i joined = _mm_or_si128(_mm_and_si128(nonSpecial, isRegular), _mm_andnot_si128(isRegular, infOrNan));
+    return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(justSign), 16));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeHalfs(vec4 f, int num, std::uint8_t* dst) {
+    storeShorts(toHalfs(f), num, dst);
+}
+
+//------------------------------------------------------------------------------
+/// load 4 vertices as one register per component (SoA), missing components are zero
+template<int NUM> inline void load4(const float* src, vec4 (&c)[4]);
+template<> inline void load4<2>(const float* src, vec4 (&c)[4]) {
+    const vec4 v01 = _mm_loadu_ps(src);
+    const vec4 v23 = _mm_loadu_ps(src + 4);
+    c[0] = _mm_shuffle_ps(v01, v23, _MM_SHUFFLE(2, 0, 2, 0));
+    c[1] = _mm_shuffle_ps(v01, v23, _MM_SHUFFLE(3, 1, 3, 1));
+    c[2] = c[3] = _mm_setzero_ps();
+}
+template<> inline void load4<3>(const float* src, vec4 (&c)[4]) {
+    // same deinterleave as in TransformBaker
+    const vec4 a = _mm_loadu_ps(src);
+    const vec4 b = _mm_loadu_ps(src + 4);
+    const vec4 d = _mm_loadu_ps(src + 8);
+    c[0] = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 3, 0)),
+                          _mm_shuffle_ps(b, d, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+    c[1] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                          _mm_shuffle_ps(b, d, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+    c[2] = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                          _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    c[3] = _mm_setzero_ps();
+}
+template<> inline void load4<4>(const float* src, vec4 (&c)[4]) {
+    c[0] = _mm_loadu_ps(src);
+    c[1] = _mm_loadu_ps(src + 4);
+    c[2] = _mm_loadu_ps(src + 8);
+    c[3] = _mm_loadu_ps(src + 12);
+    _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+}
+
+//------------------------------------------------------------------------------
+/// clamp, scale and round the NUM source component registers to int32, the others are zero
+template<int NUM> inline void
+quantize4(const vec4 (&c)[4], float lo, float hi, const float (&scale)[4], __m128i (&out)[4]) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (i < NUM) ? quantize(c[i], lo, hi, scale[i]) : _mm_setzero_si128();
+    }
+}
+
+//------------------------------------------------------------------------------
+/// store the 32-bit lanes of v as 4 vertices
+inline void
+storeLanes4(__m128i v, std::uint8_t* dst, int dstStride) {
+    if (4 == dstStride) {
+        _mm_storeu_si128((__m128i*) dst, v);
+    }
+    else {
+        std::uint32_t lanes[4];
+        _mm_storeu_si128((__m128i*) lanes, v);
+        for (int i = 0; i < 4; i++) {
+            std::memcpy(dst + i * dstStride, &lanes[i], 4);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// store the 64-bit halfs of v01 and v23 as 4 vertices
+inline void
+storeLanes8(__m128i v01, __m128i v23, std::uint8_t* dst, int dstStride) {
+    if (8 == dstStride) {
+        _mm_storeu_si128((__m128i*) dst, v01);
+        _mm_storeu_si128((__m128i*) (dst + 16), v23);
+    }
+    else {
+        _mm_storel_epi64((__m128i*) dst, v01);
+        _mm_storel_epi64((__m128i*) (dst + dstStride), _mm_unpackhi_epi64(v01, v01));
+        _mm_storel_epi64((__m128i*) (dst + 2 * dstStride), v23);
+        _mm_storel_epi64((__m128i*) (dst + 3 * dstStride), _mm_unpackhi_epi64(v23, v23));
+    }
+}
+
+//------------------------------------------------------------------------------
+/// pack 4 component registers of 4 vertices into 4 bytes per vertex
+inline void
+storeByte4x4(const __m128i (&q)[4], bool isSigned, std::uint8_t* dst, int dstStride) {
+    // x0..3 z0..3 y0..3 w0..3 => x0 y0 x1 y1 .. z0 w0 z1 w1 .. => x0 y0 z0 w0 x1 ..
+    const __m128i xz = _mm_packs_epi32(q[0], q[2]);
+    const __m128i yw = _mm_packs_epi32(q[1], q[3]);
+    const __m128i b = isSigned ? _mm_packs_epi16(xz, yw) : _mm_packus_epi16(xz, yw);
+    const __m128i b2 = _mm_unpacklo_epi8(b, _mm_srli_si128(b, 8));
+    storeLanes4(_mm_unpacklo_epi16(b2, _mm_srli_si128(b2, 8)), dst, dstStride);
+}
+
+//------------------------------------------------------------------------------
+/// pack 2 or 4 component registers of 4 vertices into int16 per component
+inline void
+storeShortsx4(const __m128i (&q)[4], int num, std::uint8_t* dst, int dstStride) {
+    if (2 == num) {
+        const __m128i xy01 = _mm_unpacklo_epi32(q[0], q[1]);
+        const __m128i xy23 = _mm_unpackhi_epi32(q[0], q[1]);
+        storeLanes4(_mm_packs_epi32(xy01, xy23), dst, dstStride);
+    }
+    else {
+        // x0..3 z0..3, y0..3 w0..3 => x0 y0 x1 y1 .., z0 w0 z1 w1 .. => x0 y0 z0 w0 x1 ..
+        const __m128i xz = _mm_packs_epi32(q[0], q[2]);
+        const __m128i yw = _mm_packs_epi32(q[1], q[3]);
+        const __m128i xy = _mm_unpacklo_epi16(xz, yw);
+        const __m128i zw = _mm_unpackhi_epi16(xz, yw);
+        storeLanes8(_mm_unpacklo_epi32(xy, zw), _mm_unpackhi_epi32(xy, zw), dst, dstStride);
+    }
+}
+
+//------------------------------------------------------------------------------
+/// pack 4 component registers of 4 vertices into uint16, biased like in storeUShorts()
+inline void
+storeUShortsx4(const __m128i (&q)[4], std::uint8_t* dst, int dstStride) {
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    __m128i s[4];
+    for (int i = 0; i < 4; i++) {
+        s[i] = _mm_sub_epi32(q[i], bias);
+    }
+    const __m128i flip = _mm_set1_epi16((short) 0x8000);
+    const __m128i xz = _mm_xor_si128(_mm_packs_epi32(s[0], s[2]), flip);
+    const __m128i yw = _mm_xor_si128(_mm_packs_epi32(s[1], s[3]), flip);
+    const __m128i xy = _mm_unpacklo_epi16(xz, yw);
+    const __m128i zw = _mm_unpackhi_epi16(xz, yw);
+    storeLanes8(_mm_unpacklo_epi32(xy, zw), _mm_unpackhi_epi32(xy, zw), dst, dstStride);
+}
+
+//------------------------------------------------------------------------------
+/// 10:10:10:2 bits of 4 vertices from 4 component registers
+inline void
+store1010102x4(const __m128i (&q)[4], std::uint8_t* dst, int dstStride) {
+    const __m128i mask10 = _mm_set1_epi32(0x3FF);
+    __m128i bits = _mm_and_si128(q[0], mask10);
+    bits = _mm_or_si128(bits, _mm_slli_epi32(_mm_and_si128(q[1], mask10), 10));
+    bits = _mm_or_si128(bits, _mm_slli_epi32(_mm_and_si128(q[2], mask10), 20));
+    bits = _mm_or_si128(bits, _mm_slli_epi32(q[3], 30));
+    storeLanes4(bits, dst, dstStride);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Pack as many vertices as possible in groups of 4, with one register
+    per component (SoA), returns the number of packed vertices. Float
+    formats are plain copies and are left to the per-vertex loops.
+*/
+template<int NUM> static int
+packStream4(VertexFormat::Code fmt, const float* src, int numVerts, std::uint8_t* dst, int dstStride) {
+    static const float scale127[4] = { 127.0f, 127.0f, 127.0f, 127.0f };
+    static const float scale255[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    static const float scale32767[4] = { 32767.0f, 32767.0f, 32767.0f, 32767.0f };
+    static const float scale65535[4] = { 65535.0f, 65535.0f, 65535.0f, 65535.0f };
+    static const float scale1[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    static const float scale1010102u[4] = { 1023.0f, 1023.0f, 1023.0f, 3.0f };
+    static const float scale1010102s[4] = { 511.0f, 511.0f, 511.0f, 1.0f };
+    const int numComps = VertexFormat::NumComponents(fmt);
+    const int num = numVerts & ~3;
+    const int srcStep = 4 * NUM;
+    const int dstStep = 4 * dstStride;
+    vec4 c[4];
+    __m128i q[4];
+    switch (fmt) {
+        case VertexFormat::Byte4N:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, -1.0f, 1.0f, scale127, q);
+                storeByte4x4(q, true, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::UByte4N:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, 0.0f, 1.0f, scale255, q);
+                storeByte4x4(q, false, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::Short2N:
+        case VertexFormat::Short4N:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, -1.0f, 1.0f, scale32767, q);
+                storeShortsx4(q, numComps, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::Half2:
+        case VertexFormat::Half4:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                for (int k = 0; k < 4; k++) {
+                    q[k] = (k < NUM) ? toHalfs(c[k]) : _mm_setzero_si128();
+                }
+                storeShortsx4(q, numComps, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::UInt10N2:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, 0.0f, 1.0f, scale1010102u, q);
+                store1010102x4(q, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::Int10N2:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, -1.0f, 1.0f, scale1010102s, q);
+                store1010102x4(q, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::UByte4:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, 0.0f, 255.0f, scale1, q);
+                storeByte4x4(q, false, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::UShort4:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, 0.0f, 65535.0f, scale1, q);
+                storeUShortsx4(q, dst, dstStride);
+            }
+            return num;
+        case VertexFormat::UShort4N:
+            for (int i = 0; i < num; i += 4, src += srcStep, dst += dstStep) {
+                load4<NUM>(src, c);
+                quantize4<NUM>(c, 0.0f, 1.0f, scale65535, q);
+                storeUShortsx4(q, dst, dstStride);
+            }
+            return num;
+        default:
+            return 0;
+    }
+}
+
+#else // FBXC_USE_SSE2
+struct vec4 {
+    float v[4];
+};
+
+//------------------------------------------------------------------------------
+template<int NUM> inline vec4
+load(const float* src) {
+    vec4 r = { { 0.0f, 0.0f, 0.0f, 0.0f } };
+    for (int i = 0; i < NUM; i++) {
+        r.v[i] = src[i];
+    }
+    return r;
+}
+
+//------------------------------------------------------------------------------
+/// clamp, scale and round to int32 (NaN becomes lo, like SSE2 max)
+inline std::int32_t
+quantize(float f, float lo, float hi, float scale) {
+    f = (f > lo) ? f : lo;
+    f = (f < hi) ? f : hi;
+    return (std::int32_t) std::nearbyint(f * scale);
+}
+
+//------------------------------------------------------------------------------
+struct vec4i {
+    std::int32_t v[4];
+};
+
+//------------------------------------------------------------------------------
+inline vec4i
+quantize(const vec4& v, float lo, float hi, float scale) {
+    vec4i r;
+    for (int i = 0; i < 4; i++) {
+        r.v[i] = quantize(v.v[i], lo, hi, scale);
+    }
+    return r;
+}
+
+//------------------------------------------------------------------------------
+inline vec4i
+quantize(const vec4& v, float lo, float hi, const float (&scale)[4]) {
+    vec4i r;
+    for (int i = 0; i < 4; i++) {
+        r.v[i] = quantize(v.v[i], lo, hi, scale[i]);
+    }
+    return r;
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeFloats(const vec4& v, int num, std::uint8_t* dst) {
+    std::memcpy(dst, v.v, num * sizeof(float));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeInts(const vec4i& v, std::int32_t (&out)[4]) {
+    std::memcpy(out, v.v, sizeof(out));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeByte4(const vec4i& i, bool isSigned, std::uint8_t* dst) {
+    for (int c = 0; c < 4; c++) {
+        std::int32_t x = i.v[c];
+        const std::int32_t lo = isSigned ? -128 : 0;
+        const std::int32_t hi = isSigned ? 127 : 255;
+        x = (x < lo) ? lo : ((x > hi) ? hi : x);
+        dst[c] = (std::uint8_t) x;
+    }
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeShorts(const vec4i& i, int num, std::uint8_t* dst) {
+    std::int16_t s[4];
+    for (int c = 0; c < num; c++) {
+        s[c] = (std::int16_t) i.v[c];
+    }
+    std::memcpy(dst, s, num * sizeof(std::int16_t));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeUShorts(const vec4i& i, int num, std::uint8_t* dst) {
+    std::uint16_t s[4];
+    for (int c = 0; c < num; c++) {
+        s[c] = (std::uint16_t) i.v[c];
+    }
+    std::memcpy(dst, s, num * sizeof(std::uint16_t));
+}
+
+//------------------------------------------------------------------------------
+inline void
+storeHalfs(const vec4& f, int num, std::uint8_t* dst) {
+    std::uint16_t h[4];
+    for (int c = 0; c < num; c++) {
+        h[c] = VertexPacker::FloatToHalf(f.v[c]);
+    }
+    std::memcpy(dst, h, num * sizeof(std::uint16_t));
+}
+#endif // FBXC_USE_SSE2
+
+//------------------------------------------------------------------------------
+inline void
+store1010102(std::int32_t (&i)[4], std::uint8_t* dst) {
+    const std::uint32_t bits = ((std::uint32_t)i[0] & 0x3FF) |
+                               (((std::uint32_t)i[1] & 0x3FF) << 10) |
+                               (((std::uint32_t)i[2] & 0x3FF) << 20) |
+                               (((std::uint32_t)i[3] & 0x3) << 30);
+    std::memcpy(dst, &bits, 4);
+}
+
+//------------------------------------------------------------------------------
+template<int NUM> static void
+packStream(VertexFormat::Code fmt, const float* src, int numVerts, std::uint8_t* dst, int dstStride) {
+    // NOTE: the format switch is outside of the vertex loops
+    static const float scale1010102u[4] = { 1023.0f, 1023.0f, 1023.0f, 3.0f };
+    static const float scale1010102s[4] = { 511.0f, 511.0f, 511.0f, 1.0f };
+    const int numComps = VertexFormat::NumComponents(fmt);
+    #if FBXC_USE_SSE2
+    // groups of 4 vertices first, the loops below handle the remainder
+    const int numPacked = packStream4<NUM>(fmt, src, numVerts, dst, dstStride);
+    src += numPacked * NUM;
+    dst += numPacked * dstStride;
+    numVerts -= numPacked;
+    #endif
+    switch (fmt) {
+        case VertexFormat::Float:
+        case VertexFormat::Float2:
+        case VertexFormat::Float3:
+        case VertexFormat::Float4:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeFloats(load<NUM>(src), numComps, dst);
+            }
+            break;
+        case VertexFormat::Byte4N:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeByte4(quantize(load<NUM>(src), -1.0f, 1.0f, 127.0f), true, dst);
+            }
+            break;
+        case VertexFormat::UByte4N:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeByte4(quantize(load<NUM>(src), 0.0f, 1.0f, 255.0f), false, dst);
+            }
+            break;
+        case VertexFormat::Short2N:
+        case VertexFormat::Short4N:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeShorts(quantize(load<NUM>(src), -1.0f, 1.0f, 32767.0f), numComps, dst);
+            }
+            break;
+        case VertexFormat::Half2:
+        case VertexFormat::Half4:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeHalfs(load<NUM>(src), numComps, dst);
+            }
+            break;
+        case VertexFormat::UInt10N2:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                std::int32_t q[4];
+                storeInts(quantize(load<NUM>(src), 0.0f, 1.0f, scale1010102u), q);
+                store1010102(q, dst);
+            }
+            break;
+        case VertexFormat::Int10N2:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                std::int32_t q[4];
+                storeInts(quantize(load<NUM>(src), -1.0f, 1.0f, scale1010102s), q);
+                store1010102(q, dst);
+            }
+            break;
+        case VertexFormat::UByte4:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeByte4(quantize(load<NUM>(src), 0.0f, 255.0f, 1.0f), false, dst);
+            }
+            break;
+        case VertexFormat::UShort4:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeUShorts(quantize(load<NUM>(src), 0.0f, 65535.0f, 1.0f), numComps, dst);
+            }
+            break;
+        case VertexFormat::UShort4N:
+            for (int i = 0; i < numVerts; i++, src += NUM, dst += dstStride) {
+                storeUShorts(quantize(load<NUM>(src), 0.0f, 1.0f, 65535.0f), numComps, dst);
+            }
+            break;
+        default:
+            assert(false);
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+VertexPacker::Pack(VertexFormat::Code fmt, const float* src, int srcComps, int numVerts, std::uint8_t* dst, int dstStride) {
+    assert(VertexFormat::NumComponents(fmt) >= srcComps);
+    switch (srcComps) {
+        case 2: packStream<2>(fmt, src, numVerts, dst, dstStride); break;
+        case 3: packStream<3>(fmt, src, numVerts, dst, dstStride); break;
+        case 4: packStream<4>(fmt, src, numVerts, dst, dstStride); break;
+        default: assert(false); break;
+    }
+}
+
+} // namespace FBXC
@@ -0,0 +1,27 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class FBXC::VertexPacker
+    @brief convert planar float vertex streams into packed vertex formats
+
+    Each call converts a whole stream, the destination can be strided
+    (for interleaved vertices). Source components which don't exist in
+    the destination format are zero. Uses SSE2 where available (4
+    vertices per iteration with one register per component, the rest
+    one vertex at a time), with a scalar fallback which produces
+    identical results.
+*/
+#include "VertexFormat.h"
+#include <cstdint>
+
+namespace FBXC {
+
+class VertexPacker {
+public:
+    /// pack a float stream with srcComps (2..4) floats per vertex
+    static void Pack(VertexFormat::Code fmt, const float* src, int srcComps, int numVerts, std::uint8_t* dst, int dstStride);
+    /// convert a single float to half precision (round to nearest even)
+    static std::uint16_t FloatToHalf(float f);
+};
+
+} // namespace FBXC
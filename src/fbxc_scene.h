@@ -0,0 +1,252 @@
+#pragma once
+/*
+    fbxc_scene.h -- reader for fbxc binary scene files (--format bin)
+
+    A binary scene file mirrors the JSON output: the scene properties,
+    textures, materials, meshes (with pieces), animations (with tracks)
+    and the node tree, each
+    object with its property map. It is meant to be mmap'ed and read in
+    place, there's nothing to parse:
+
+    - all records have a fixed size and are 8-byte aligned
+    - sections are addressed by byte offsets from the start of the file
+    - records refer to each other by index into their section
+    - strings are NUL-terminated and live in a single string table,
+      they are referenced by byte offset into that table
+    - the properties of an object are a contiguous run of records
+      sorted by key (strcmp order), fbxc_find() does a binary search
+    - values with more than 8 bytes of data (float vectors, strings,
+      arrays) refer to the doubles, strings or values section
+    - all numbers are little-endian
+
+    Usage:
+
+        const fbxc_scene_header* scn = fbxc_scene_validate(data, size);
+        if (scn) {
+            const fbxc_node* root = fbxc_get_node(scn, 0);
+            const fbxc_value* name = fbxc_find(scn, root->props, "name");
+            if (name && (FBXC_STRING == name->type)) {
+                puts(fbxc_get_string(scn, name->v.u));
+            }
+        }
+
+    fbxc_scene_validate() checks the header and that all sections are
+    inside the file, indices and offsets within records are not checked.
+    This header is self-contained and works from C99 and C++.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define FBXC_SCENE_MAGIC "FBXCSCN"
+#define FBXC_SCENE_VERSION 2
+#define FBXC_INVALID_INDEX (-1)
+/* blob offset of data which isn't there, e.g. the 'blendshapenormaloffsets'
+   element of a blend shape without normal deltas */
+#define FBXC_NO_OFFSET UINT64_MAX
+
+/* value types */
+enum {
+    FBXC_VOID = 0,
+    FBXC_BOOL,      /* v.u is 0 or 1 */
+    FBXC_ID,        /* v.u is a 64-bit unique id */
+    FBXC_INT,       /* v.i is a signed integer */
+    FBXC_FLOAT,     /* v.f is a double */
+    FBXC_FLOAT2,    /* v.u is the index of 2 doubles in the doubles section */
+    FBXC_FLOAT3,    /* v.u is the index of 3 doubles in the doubles section */
+    FBXC_FLOAT4,    /* v.u is the index of 4 doubles in the doubles section */
+    FBXC_STRING,    /* v.u is the string table offset, count the length */
+    FBXC_ARRAY,     /* v.u is the index of count values in the values section */
+};
+
+/* a section of the file: byte offset from file start, number of records (bytes for strings) */
+typedef struct fbxc_section {
+    uint64_t offset;
+    uint64_t count;
+} fbxc_section;
+
+/* a value (16 bytes) */
+typedef struct fbxc_value {
+    uint32_t type;
+    uint32_t count;
+    union {
+        uint64_t u;
+        int64_t i;
+        double f;
+    } v;
+} fbxc_value;
+
+/* a key/value property (24 bytes) */
+typedef struct fbxc_property {
+    uint32_t key;       /* string table offset */
+    uint32_t reserved;
+    fbxc_value value;
+} fbxc_property;
+
+/* the properties of an object, a range in the properties section */
+typedef struct fbxc_props {
+    uint32_t first;
+    uint32_t count;
+} fbxc_props;
+
+/* a texture or material */
+typedef struct fbxc_object {
+    fbxc_props props;
+    fbxc_props user_props;
+} fbxc_object;
+
+/* a mesh, its pieces are a range in the pieces section */
+typedef struct fbxc_mesh {
+    fbxc_props props;
+    fbxc_props user_props;
+    uint32_t first_piece;
+    uint32_t num_pieces;
+} fbxc_mesh;
+
+/* a mesh piece */
+typedef struct fbxc_piece {
+    fbxc_props props;
+} fbxc_piece;
+
+/* an animation, its tracks are a range in the tracks section */
+typedef struct fbxc_animation {
+    fbxc_props props;
+    fbxc_props user_props;
+    uint32_t first_track;
+    uint32_t num_tracks;
+} fbxc_animation;
+
+/* an animation track */
+typedef struct fbxc_track {
+    fbxc_props props;
+} fbxc_track;
+
+/* a node, node 0 is the root, links are node indices or FBXC_INVALID_INDEX */
+typedef struct fbxc_node {
+    fbxc_props props;
+    fbxc_props user_props;
+    int32_t parent;
+    int32_t first_child;
+    int32_t next_sibling;
+    int32_t reserved;
+} fbxc_node;
+
+/* the file header at offset 0 */
+typedef struct fbxc_scene_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t file_size;
+    fbxc_props scene_props;
+    fbxc_section strings;
+    fbxc_section doubles;
+    fbxc_section values;
+    fbxc_section properties;
+    fbxc_section textures;
+    fbxc_section materials;
+    fbxc_section meshes;
+    fbxc_section pieces;
+    fbxc_section nodes;
+    fbxc_section animations;
+    fbxc_section tracks;
+} fbxc_scene_header;
+
+/* check a section against the file size */
+static inline int fbxc_section_valid(const fbxc_section* sec, uint64_t file_size, uint64_t record_size) {
+    return (0 == (sec->offset & 7)) && (sec->offset <= file_size) &&
+        (sec->count <= (file_size - sec->offset) / record_size);
+}
+
+/* return the scene header if data looks like a valid scene file, else NULL */
+static inline const fbxc_scene_header* fbxc_scene_validate(const void* data, size_t size) {
+    const fbxc_scene_header* h = (const fbxc_scene_header*) data;
+    if (!data || (0 != ((uintptr_t)data & 7)) || (size < sizeof(fbxc_scene_header))) {
+        return NULL;
+    }
+    if ((0 != memcmp(h->magic, FBXC_SCENE_MAGIC, sizeof(h->magic))) || (FBXC_SCENE_VERSION != h->version) ||
+        (sizeof(fbxc_scene_header) != h->header_size) || (h->file_size > size)) {
+        return NULL;
+    }
+    if (!fbxc_section_valid(&h->strings, h->file_size, 1) ||
+        !fbxc_section_valid(&h->doubles, h->file_size, sizeof(double)) ||
+        !fbxc_section_valid(&h->values, h->file_size, sizeof(fbxc_value)) ||
+        !fbxc_section_valid(&h->properties, h->file_size, sizeof(fbxc_property)) ||
+        !fbxc_section_valid(&h->textures, h->file_size, sizeof(fbxc_object)) ||
+        !fbxc_section_valid(&h->materials, h->file_size, sizeof(fbxc_object)) ||
+        !fbxc_section_valid(&h->meshes, h->file_size, sizeof(fbxc_mesh)) ||
+        !fbxc_section_valid(&h->pieces, h->file_size, sizeof(fbxc_piece)) ||
+        !fbxc_section_valid(&h->nodes, h->file_size, sizeof(fbxc_node)) ||
+        !fbxc_section_valid(&h->animations, h->file_size, sizeof(fbxc_animation)) ||
+        !fbxc_section_valid(&h->tracks, h->file_size, sizeof(fbxc_track))) {
+        return NULL;
+    }
+    /* the string table must end with a NUL */
+    if ((h->strings.count == 0) || (0 != ((const char*)data)[h->strings.offset + h->strings.count - 1])) {
+        return NULL;
+    }
+    return h;
+}
+
+/* get a string by string table offset */
+static inline const char* fbxc_get_string(const fbxc_scene_header* h, uint64_t offset) {
+    return (const char*)h + h->strings.offset + offset;
+}
+
+/* get the doubles of a FBXC_FLOAT2..4 value */
+static inline const double* fbxc_get_doubles(const fbxc_scene_header* h, const fbxc_value* val) {
+    return (const double*)((const char*)h + h->doubles.offset) + val->v.u;
+}
+
+/* get an element of a FBXC_ARRAY value */
+static inline const fbxc_value* fbxc_get_element(const fbxc_scene_header* h, const fbxc_value* val, uint32_t index) {
+    return (const fbxc_value*)((const char*)h + h->values.offset) + val->v.u + index;
+}
+
+/* get a property of an object by index (0 .. props.count-1) */
+static inline const fbxc_property* fbxc_get_property(const fbxc_scene_header* h, fbxc_props props, uint32_t index) {
+    return (const fbxc_property*)((const char*)h + h->properties.offset) + props.first + index;
+}
+
+/* find a property value by key, or NULL */
+static inline const fbxc_value* fbxc_find(const fbxc_scene_header* h, fbxc_props props, const char* key) {
+    uint32_t lo = 0;
+    uint32_t hi = props.count;
+    while (lo < hi) {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        const fbxc_property* prop = fbxc_get_property(h, props, mid);
+        const int cmp = strcmp(fbxc_get_string(h, prop->key), key);
+        if (0 == cmp) {
+            return &prop->value;
+        }
+        else if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+/* get records by index */
+static inline const fbxc_object* fbxc_get_texture(const fbxc_scene_header* h, uint32_t index) {
+    return (const fbxc_object*)((const char*)h + h->textures.offset) + index;
+}
+static inline const fbxc_object* fbxc_get_material(const fbxc_scene_header* h, uint32_t index) {
+    return (const fbxc_object*)((const char*)h + h->materials.offset) + index;
+}
+static inline const fbxc_mesh* fbxc_get_mesh(const fbxc_scene_header* h, uint32_t index) {
+    return (const fbxc_mesh*)((const char*)h + h->meshes.offset) + index;
+}
+static inline const fbxc_piece* fbxc_get_piece(const fbxc_scene_header* h, const fbxc_mesh* mesh, uint32_t index) {
+    return (const fbxc_piece*)((const char*)h + h->pieces.offset) + mesh->first_piece + index;
+}
+static inline const fbxc_node* fbxc_get_node(const fbxc_scene_header* h, int32_t index) {
+    return (const fbxc_node*)((const char*)h + h->nodes.offset) + index;
+}
+static inline const fbxc_animation* fbxc_get_animation(const fbxc_scene_header* h, uint32_t index) {
+    return (const fbxc_animation*)((const char*)h + h->animations.offset) + index;
+}
+static inline const fbxc_track* fbxc_get_track(const fbxc_scene_header* h, const fbxc_animation* anim, uint32_t index) {
+    return (const fbxc_track*)((const char*)h + h->tracks.offset) + anim->first_track + index;
+}
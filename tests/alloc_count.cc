@@ -0,0 +1,86 @@
+//------------------------------------------------------------------------------
+//  alloc_count.cc
+//
+//  Counts heap allocations while NativeBuilder::Build() builds the proxy
+//  scene of each FBX file on the command line:
+//
+//      fbxc-alloc-count test_files/*.fbx
+//
+//  Reading the file and inflating its arrays is not counted. Used to
+//  compare PropertyMap / Value changes, e.g. run it on the commits before
+//  and after a change.
+//------------------------------------------------------------------------------
+#include "BinaryFbx.h"
+#include "ArrayCache.h"
+#include "ThreadPool.h"
+#include "NativeBuilder.h"
+#include "Rules.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long> numAllocs(0);
+static std::atomic<long> numBytes(0);
+
+//------------------------------------------------------------------------------
+void*
+operator new(std::size_t size) {
+    numAllocs++;
+    numBytes += (long) size;
+    void* ptr = std::malloc(size ? size : 1);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+void
+operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+//------------------------------------------------------------------------------
+void
+operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace FBXC;
+
+//------------------------------------------------------------------------------
+int
+main(int argc, const char** argv) {
+    if (argc < 2) {
+        std::printf("usage: fbxc-alloc-count file.fbx...\n");
+        return 2;
+    }
+    Rules rules;
+    long totalAllocs = 0;
+    long totalBytes = 0;
+    for (int i = 1; i < argc; i++) {
+        ThreadPool pool;
+        pool.Setup(1);
+        ArrayCache arrayCache;
+        arrayCache.Setup(&pool);
+        BinaryFbx fbx;
+        fbx.Open(argv[i]);
+        {
+            const long allocs0 = numAllocs;
+            const long bytes0 = numBytes;
+            ProxyScene scene;
+            NativeBuilder::Build(fbx, arrayCache, argv[i], rules, scene);
+            const long allocs = numAllocs - allocs0;
+            const long bytes = numBytes - bytes0;
+            std::printf("%-50s %8ld allocs %10ld bytes\n", argv[i], allocs, bytes);
+            totalAllocs += allocs;
+            totalBytes += bytes;
+        }
+        fbx.Close();
+        arrayCache.Clear();
+        pool.Discard();
+    }
+    std::printf("total %ld allocs %ld bytes\n", totalAllocs, totalBytes);
+    return 0;
+}
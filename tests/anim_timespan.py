@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""
+Check that an animation stack without a time span gets its start and
+stop time from the keys of its curves.
+
+    anim_timespan.py path/to/fbxc path/to/test_files [extra fbxc args...]
+
+Exports radonlabs_bouncingball.fbx with '--anim', then a copy of it
+where the LocalStart/LocalStop properties of the stack are renamed so
+that no reader finds them. The stack time span of the original file is
+the time span of its curve keys, so both exports must have the same
+start, stop and numsamples, and no property may appear twice. Exits
+with status 1 on failure.
+"""
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+def no_duplicates(pairs):
+    keys = [key for key, val in pairs]
+    if len(keys) != len(set(keys)):
+        raise ValueError('duplicate keys in %s' % keys)
+    return dict(pairs)
+
+def export(fbxc, fbx_path, tmp, extra_args):
+    rules_path = os.path.join(tmp, 'rules.toml')
+    open(rules_path, 'w').close()
+    out_path = os.path.join(tmp, 'out.json')
+    subprocess.check_call([fbxc, '--fbx', fbx_path, '--rules', rules_path, '--output', out_path, '--anim'] + extra_args,
+                          stdout=subprocess.DEVNULL)
+    with open(out_path) as fp:
+        return json.load(fp, object_pairs_hook=no_duplicates)['animations']
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    fbxc, fbx_dir, extra_args = sys.argv[1], sys.argv[2], sys.argv[3:]
+    tmp = tempfile.mkdtemp(prefix='fbxc_anim_')
+    try:
+        fbx_path = os.path.join(fbx_dir, 'radonlabs_bouncingball.fbx')
+        with open(fbx_path, 'rb') as fp:
+            data = fp.read()
+        # same length names keep the binary FBX records intact
+        no_span_path = os.path.join(tmp, 'nospan.fbx')
+        with open(no_span_path, 'wb') as fp:
+            fp.write(data.replace(b'LocalStart', b'LocalStarX').replace(b'LocalStop', b'LocalStoX'))
+        errors = []
+        expected = export(fbxc, fbx_path, tmp, extra_args)
+        actual = export(fbxc, no_span_path, tmp, extra_args)
+        if len(expected) != len(actual):
+            errors.append('%d animations, expected %d' % (len(actual), len(expected)))
+        for exp, act in zip(expected, actual):
+            if exp['stop'] <= exp['start']:
+                errors.append('%s: no time span in the original file' % exp['name'])
+            for key in ('start', 'stop', 'numsamples'):
+                if act[key] != exp[key]:
+                    errors.append('%s: %s is %r, expected %r' % (act['name'], key, act[key], exp[key]))
+        print('%-8s radonlabs_bouncingball' % ('FAILED' if errors else 'ok'))
+        for error in errors:
+            print('    ' + error)
+        return 1 if errors else 0
+    finally:
+        shutil.rmtree(tmp)
+
+if __name__ == '__main__':
+    sys.exit(main())
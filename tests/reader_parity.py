@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""
+Export all binary FBX files in a directory with '--reader sdk' and
+'--reader native' and compare the results.
+
+    reader_parity.py path/to/fbxc path/to/test_files [extra fbxc args...]
+
+Object ids differ between the readers (the SDK assigns its own unique
+ids, the native reader uses the ids stored in the file), so ids are
+renumbered in the order their objects appear before the JSON outputs
+are compared. Floats in the JSON and 32-bit words in the blobs may
+differ by a small relative tolerance, everything else must match
+exactly. Exits with status 1 if any file differs.
+"""
+import glob
+import json
+import math
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+REL_TOLERANCE = 1e-5
+
+def collect_ids(node, ids):
+    if isinstance(node, dict):
+        if isinstance(node.get('id'), int) and node['id'] not in ids:
+            ids[node['id']] = len(ids)
+        for key in sorted(node):
+            collect_ids(node[key], ids)
+    elif isinstance(node, list):
+        for item in node:
+            collect_ids(item, ids)
+
+def renumber(node, ids):
+    if isinstance(node, dict):
+        return { key: renumber(val, ids) for key, val in node.items() }
+    elif isinstance(node, list):
+        return [renumber(item, ids) for item in node]
+    elif isinstance(node, int) and not isinstance(node, bool) and node in ids:
+        return 'id#%d' % ids[node]
+    return node
+
+def close(a, b):
+    return math.isclose(a, b, rel_tol=REL_TOLERANCE, abs_tol=REL_TOLERANCE)
+
+def compare_json(a, b, path, diffs):
+    if isinstance(a, dict) and isinstance(b, dict):
+        for key in sorted(set(a) | set(b)):
+            if key == 'file':
+                continue
+            if key not in a or key not in b:
+                diffs.append('%s/%s: only in %s' % (path, key, 'sdk' if key in a else 'native'))
+            else:
+                compare_json(a[key], b[key], path + '/' + key, diffs)
+    elif isinstance(a, list) and isinstance(b, list):
+        if len(a) != len(b):
+            diffs.append('%s: %d vs %d items' % (path, len(a), len(b)))
+        for i, (x, y) in enumerate(zip(a, b)):
+            compare_json(x, y, '%s[%d]' % (path, i), diffs)
+    elif isinstance(a, float) or isinstance(b, float):
+        if not (isinstance(a, (int, float)) and isinstance(b, (int, float)) and close(a, b)):
+            diffs.append('%s: %r vs %r' % (path, a, b))
+    elif a != b:
+        diffs.append('%s: %r vs %r' % (path, a, b))
+
+def compare_blobs(a, b, diffs):
+    if len(a) != len(b):
+        diffs.append('blob: %d vs %d bytes' % (len(a), len(b)))
+        return
+    # 32-bit words which differ must be normal floats within tolerance
+    # (index and packed vertex data must match exactly)
+    num = len(a) // 4
+    words_a = struct.unpack('<%dI' % num, a[:num * 4])
+    words_b = struct.unpack('<%dI' % num, b[:num * 4])
+    bad = 0
+    for wa, wb in zip(words_a, words_b):
+        if wa == wb:
+            continue
+        fa, fb = struct.unpack('<2f', struct.pack('<2I', wa, wb))
+        normal = all(math.isfinite(f) and abs(f) >= 1e-30 for f in (fa, fb))
+        if not (normal and close(fa, fb)):
+            bad += 1
+    if a[num * 4:] != b[num * 4:]:
+        bad += 1
+    if bad:
+        diffs.append('blob: %d differing words' % bad)
+
+def export(fbxc, reader, fbx_dir, out_dir, rules_path, extra_args):
+    subprocess.check_call([fbxc, '--reader', reader, '--batch', os.path.join(fbx_dir, '*.fbx'),
+                           '--rules', rules_path, '--output', out_dir] + extra_args,
+                          stdout=subprocess.DEVNULL)
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    fbxc, fbx_dir, extra_args = sys.argv[1], sys.argv[2], sys.argv[3:]
+    tmp = tempfile.mkdtemp(prefix='fbxc_parity_')
+    try:
+        rules_path = os.path.join(tmp, 'rules.toml')
+        open(rules_path, 'w').close()
+        out = { reader: os.path.join(tmp, reader) for reader in ('sdk', 'native') }
+        for reader, out_dir in out.items():
+            os.mkdir(out_dir)
+            export(fbxc, reader, fbx_dir, out_dir, rules_path, extra_args)
+        failed = 0
+        for json_path in sorted(glob.glob(os.path.join(out['sdk'], '*.json'))):
+            name = os.path.basename(json_path)
+            native_path = os.path.join(out['native'], name)
+            diffs = []
+            if not os.path.exists(native_path):
+                diffs.append('missing native output')
+            else:
+                docs = []
+                for path in (json_path, native_path):
+                    with open(path) as fp:
+                        doc = json.load(fp)
+                    ids = {}
+                    collect_ids(doc, ids)
+                    docs.append(renumber(doc, ids))
+                compare_json(docs[0], docs[1], '', diffs)
+                blobs = []
+                for path in (json_path, native_path):
+                    with open(os.path.splitext(path)[0] + '.bin', 'rb') as fp:
+                        blobs.append(fp.read())
+                compare_blobs(blobs[0], blobs[1], diffs)
+            print('%-8s %s' % ('ok' if not diffs else 'FAILED', name))
+            for diff in diffs[:20]:
+                print('    ' + diff)
+            failed += 1 if diffs else 0
+        return 1 if failed else 0
+    finally:
+        shutil.rmtree(tmp)
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+Check that rules with a 'tangents' key but no 'action' only set the
+tangent mode and don't change which nodes are exported.
+
+    rules_tangents.py path/to/fbxc path/to/test_files [extra fbxc args...]
+
+Exports teapot.fbx and cubeman.fbx (texcoords, but no tangents) with
+several rules files and checks the number of exported meshes and
+whether they have a tangent stream. Exits with status 1 on failure.
+"""
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+# (name, rules file, expected meshes: None = as without rules, expect tangents)
+CASES = [
+    ('no match', '[[rule]]\npath = "**/nonexistent*"\ntangents = "regenerate"\n', None, False),
+    ('all', '[[rule]]\ntangents = "regenerate"\n', None, True),
+    ('file default', 'tangents = "regenerate"\n', None, True),
+    ('after exclude', '[[rule]]\ntype = "mesh"\naction = "exclude"\n'
+                      '[[rule]]\ntangents = "regenerate"\n', 0, False),
+    ('before include', '[[rule]]\ntangents = "regenerate"\n'
+                       '[[rule]]\ntype = "mesh"\naction = "include"\n', None, True),
+    ('include with keep', '[[rule]]\ntangents = "regenerate"\n'
+                          '[[rule]]\ntype = "mesh"\naction = "include"\ntangents = "keep"\n', None, False),
+]
+
+def export(fbxc, fbx_path, rules, tmp, extra_args):
+    rules_path = os.path.join(tmp, 'rules.toml')
+    with open(rules_path, 'w') as fp:
+        fp.write(rules)
+    out_path = os.path.join(tmp, 'out.json')
+    subprocess.check_call([fbxc, '--fbx', fbx_path, '--rules', rules_path, '--output', out_path] + extra_args,
+                          stdout=subprocess.DEVNULL)
+    with open(out_path) as fp:
+        return json.load(fp)['meshes']
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    fbxc, fbx_dir, extra_args = sys.argv[1], sys.argv[2], sys.argv[3:]
+    tmp = tempfile.mkdtemp(prefix='fbxc_rules_')
+    try:
+        failed = 0
+        for name in ('teapot', 'cubeman'):
+            fbx_path = os.path.join(fbx_dir, name + '.fbx')
+            base = export(fbxc, fbx_path, '', tmp, extra_args)
+            has_uvs = all('texcoord0' in mesh['vertexlayout'] for mesh in base)
+            for case, rules, num_meshes, tangents in CASES:
+                meshes = export(fbxc, fbx_path, rules, tmp, extra_args)
+                expected = len(base) if num_meshes is None else num_meshes
+                errors = []
+                if len(meshes) != expected:
+                    errors.append('%d meshes, expected %d' % (len(meshes), expected))
+                for mesh in meshes:
+                    if ('tangent' in mesh['vertexlayout']) != (tangents and has_uvs):
+                        errors.append('mesh %d: unexpected vertexlayout %s' % (mesh['id'], mesh['vertexlayout']))
+                        break
+                print('%-8s %s: %s' % ('FAILED' if errors else 'ok', name, case))
+                for error in errors:
+                    print('    ' + error)
+                failed += 1 if errors else 0
+        return 1 if failed else 0
+    finally:
+        shutil.rmtree(tmp)
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,246 @@
+/*
+    scene_dump.c -- print a binary scene file (fbxc --format bin) as JSON
+
+        fbxc-scene-dump file.scene
+
+    Uses only fbxc_scene.h and C99, and writes the same structure as
+    the JSON exporter (void properties and nested arrays are skipped,
+    non-finite numbers are null), so scene_roundtrip.py can compare
+    both outputs. Property lookups go through fbxc_find() and the
+    node tree is walked through the parent/child/sibling links, so
+    a broken key order or link fails the dump.
+*/
+#include "fbxc_scene.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const fbxc_scene_header* scn;
+
+/* fail with an error message */
+static void fail(const char* msg) {
+    fprintf(stderr, "fbxc-scene-dump: %s\n", msg);
+    exit(1);
+}
+
+/* print a JSON string */
+static void dump_string(const char* str) {
+    putchar('"');
+    for (; *str; str++) {
+        const unsigned char c = (unsigned char) *str;
+        if ((c == '"') || (c == '\\')) {
+            printf("\\%c", c);
+        }
+        else if (c < 0x20) {
+            printf("\\u%04x", c);
+        }
+        else {
+            putchar(c);
+        }
+    }
+    putchar('"');
+}
+
+/* print a double, %.17g round-trips */
+static void dump_double(double d) {
+    if (isfinite(d)) {
+        printf("%.17g", d);
+    }
+    else {
+        printf("null");
+    }
+}
+
+/* print a value (not FBXC_VOID) */
+static void dump_value(const fbxc_value* val) {
+    uint32_t i;
+    int first = 1;
+    switch (val->type) {
+        case FBXC_BOOL:
+            printf(val->v.u ? "true" : "false");
+            break;
+        case FBXC_ID:
+            printf("%llu", (unsigned long long) val->v.u);
+            break;
+        case FBXC_INT:
+            printf("%lld", (long long) val->v.i);
+            break;
+        case FBXC_FLOAT:
+            dump_double(val->v.f);
+            break;
+        case FBXC_FLOAT2:
+        case FBXC_FLOAT3:
+        case FBXC_FLOAT4:
+            putchar('[');
+            for (i = 0; i < val->count; i++) {
+                if (i > 0) {
+                    putchar(',');
+                }
+                dump_double(fbxc_get_doubles(scn, val)[i]);
+            }
+            putchar(']');
+            break;
+        case FBXC_STRING:
+            dump_string(fbxc_get_string(scn, val->v.u));
+            break;
+        case FBXC_ARRAY:
+            putchar('[');
+            for (i = 0; i < val->count; i++) {
+                const fbxc_value* elm = fbxc_get_element(scn, val, i);
+                if ((FBXC_VOID != elm->type) && (FBXC_ARRAY != elm->type)) {
+                    if (!first) {
+                        putchar(',');
+                    }
+                    first = 0;
+                    dump_value(elm);
+                }
+            }
+            putchar(']');
+            break;
+        default:
+            fail("invalid value type");
+            break;
+    }
+}
+
+/* print properties as object members, returns 1 if nothing was printed */
+static int dump_props(fbxc_props props, int first) {
+    uint32_t i;
+    for (i = 0; i < props.count; i++) {
+        const fbxc_property* prop = fbxc_get_property(scn, props, i);
+        const char* key = fbxc_get_string(scn, prop->key);
+        if (fbxc_find(scn, props, key) != &prop->value) {
+            fail("property not found by key");
+        }
+        if (FBXC_VOID != prop->value.type) {
+            if (!first) {
+                putchar(',');
+            }
+            first = 0;
+            dump_string(key);
+            putchar(':');
+            dump_value(&prop->value);
+        }
+    }
+    return first;
+}
+
+/* print the properties and user properties of an object without the closing brace, returns 1 if empty */
+static int begin_object(fbxc_props props, fbxc_props user_props) {
+    int first;
+    putchar('{');
+    first = dump_props(props, 1);
+    if (user_props.count > 0) {
+        printf("%s\"userproperties\":{", first ? "" : ",");
+        dump_props(user_props, 1);
+        putchar('}');
+        first = 0;
+    }
+    return first;
+}
+
+/* print a node and its children */
+static void dump_node(int32_t index) {
+    const fbxc_node* node = fbxc_get_node(scn, index);
+    int32_t child;
+    const int first = begin_object(node->props, node->user_props);
+    if (FBXC_INVALID_INDEX != node->first_child) {
+        printf("%s\"children\":[", first ? "" : ",");
+        for (child = node->first_child; FBXC_INVALID_INDEX != child; child = fbxc_get_node(scn, child)->next_sibling) {
+            if ((child < 0) || ((uint64_t) child >= scn->nodes.count) || (fbxc_get_node(scn, child)->parent != index)) {
+                fail("invalid node link");
+            }
+            if (child != node->first_child) {
+                putchar(',');
+            }
+            dump_node(child);
+        }
+        putchar(']');
+    }
+    putchar('}');
+}
+
+int main(int argc, char** argv) {
+    FILE* fp;
+    long size;
+    void* data;
+    uint32_t i, j;
+    if (argc != 2) {
+        fprintf(stderr, "usage: fbxc-scene-dump file.scene\n");
+        return 2;
+    }
+    /* malloc'ed memory is aligned enough for the 8-byte records */
+    fp = fopen(argv[1], "rb");
+    if (!fp) {
+        fail("failed to open file");
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc(size > 0 ? (size_t) size : 1);
+    if (!data || (size < 0) || (fread(data, 1, (size_t) size, fp) != (size_t) size)) {
+        fail("failed to read file");
+    }
+    fclose(fp);
+    scn = fbxc_scene_validate(data, (size_t) size);
+    if (!scn) {
+        fail("not a valid scene file");
+    }
+
+    putchar('{');
+    dump_props(scn->scene_props, 1);
+    printf(",\"textures\":[");
+    for (i = 0; i < scn->textures.count; i++) {
+        const fbxc_object* tex = fbxc_get_texture(scn, i);
+        printf("%s", i ? "," : "");
+        begin_object(tex->props, tex->user_props);
+        putchar('}');
+    }
+    printf("],\"materials\":[");
+    for (i = 0; i < scn->materials.count; i++) {
+        const fbxc_object* mat = fbxc_get_material(scn, i);
+        printf("%s", i ? "," : "");
+        begin_object(mat->props, mat->user_props);
+        putchar('}');
+    }
+    printf("],\"meshes\":[");
+    for (i = 0; i < scn->meshes.count; i++) {
+        const fbxc_mesh* mesh = fbxc_get_mesh(scn, i);
+        printf("%s", i ? "," : "");
+        const int first = begin_object(mesh->props, mesh->user_props);
+        if (mesh->num_pieces > 0) {
+            printf("%s\"pieces\":[", first ? "" : ",");
+            for (j = 0; j < mesh->num_pieces; j++) {
+                printf("%s", j ? "," : "");
+                begin_object(fbxc_get_piece(scn, mesh, j)->props, (fbxc_props) { 0, 0 });
+                putchar('}');
+            }
+            putchar(']');
+        }
+        putchar('}');
+    }
+    putchar(']');
+    if (scn->animations.count > 0) {
+        printf(",\"animations\":[");
+        for (i = 0; i < scn->animations.count; i++) {
+            const fbxc_animation* anim = fbxc_get_animation(scn, i);
+            printf("%s", i ? "," : "");
+            const int first = begin_object(anim->props, anim->user_props);
+            printf("%s\"tracks\":[", first ? "" : ",");
+            for (j = 0; j < anim->num_tracks; j++) {
+                printf("%s", j ? "," : "");
+                begin_object(fbxc_get_track(scn, anim, j)->props, (fbxc_props) { 0, 0 });
+                putchar('}');
+            }
+            printf("]}");
+        }
+        putchar(']');
+    }
+    if (scn->nodes.count > 0) {
+        printf(",\"nodes\":");
+        dump_node(0);
+    }
+    printf("}\n");
+    free(data);
+    return 0;
+}
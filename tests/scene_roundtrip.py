@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Export all binary FBX files in a directory with '--format json' and
+'--format bin', convert the binary scene files back to JSON with
+fbxc-scene-dump (a C99 program using src/fbxc_scene.h) and compare.
+
+    scene_roundtrip.py path/to/fbxc path/to/fbxc-scene-dump path/to/test_files [extra fbxc args...]
+
+The JSON writer prints the shortest decimal which reads back exactly,
+fbxc-scene-dump prints 17 digits, so the parsed documents must be
+equal. Animations, skins and blend shapes are exported so that their
+properties are covered too. Exits with status 1 if any file differs.
+"""
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+def first_diff(a, b, path):
+    if isinstance(a, dict) and isinstance(b, dict):
+        for key in sorted(set(a) | set(b)):
+            if key not in a or key not in b:
+                return '%s/%s: only in %s' % (path, key, 'json' if key in a else 'scene')
+            diff = first_diff(a[key], b[key], path + '/' + key)
+            if diff:
+                return diff
+    elif isinstance(a, list) and isinstance(b, list):
+        if len(a) != len(b):
+            return '%s: %d vs %d items' % (path, len(a), len(b))
+        for i, (x, y) in enumerate(zip(a, b)):
+            diff = first_diff(x, y, '%s[%d]' % (path, i))
+            if diff:
+                return diff
+    elif a != b or type(a) != type(b):
+        return '%s: %r vs %r' % (path, a, b)
+    return None
+
+def main():
+    if len(sys.argv) < 4:
+        print(__doc__)
+        return 2
+    fbxc, scene_dump, fbx_dir, extra_args = sys.argv[1], sys.argv[2], sys.argv[3], sys.argv[4:]
+    tmp = tempfile.mkdtemp(prefix='fbxc_scene_')
+    try:
+        rules_path = os.path.join(tmp, 'rules.toml')
+        open(rules_path, 'w').close()
+        failed = 0
+        for fbx_path in sorted(glob.glob(os.path.join(fbx_dir, '*.fbx'))):
+            name = os.path.splitext(os.path.basename(fbx_path))[0]
+            docs = []
+            for fmt, ext in (('json', '.json'), ('bin', '.scene')):
+                out_path = os.path.join(tmp, fmt, name + ext)
+                os.makedirs(os.path.dirname(out_path), exist_ok=True)
+                subprocess.check_call([fbxc, '--fbx', fbx_path, '--rules', rules_path, '--output', out_path,
+                                       '--format', fmt, '--anim', '--skin', '--blendshapes'] + extra_args,
+                                      stdout=subprocess.DEVNULL)
+                if 'bin' == fmt:
+                    dump = subprocess.run([scene_dump, out_path], stdout=subprocess.PIPE, check=True)
+                    docs.append(json.loads(dump.stdout.decode('utf-8')))
+                else:
+                    with open(out_path, encoding='utf-8') as fp:
+                        docs.append(json.load(fp))
+            diff = first_diff(docs[0], docs[1], '')
+            print('%-8s %s' % ('FAILED' if diff else 'ok', name))
+            if diff:
+                print('    ' + diff)
+                failed += 1
+        return 1 if failed else 0
+    finally:
+        shutil.rmtree(tmp)
+
+if __name__ == '__main__':
+    sys.exit(main())